@@ -9,6 +9,7 @@ QT       += gui
 QT       += svg
 QT       += printsupport
 QT       += widgets
+QT       += network
 
 TARGET = ResOpt
 CONFIG   += console
@@ -37,6 +38,7 @@ SOURCES += main.cpp \
     model.cpp \
     pipe.cpp \
     stream.cpp \
+    streamseries.cpp \
     constraint.cpp \
     wellconnection.cpp \
     objective.cpp \
@@ -71,8 +73,10 @@ SOURCES += main.cpp \
     dptable.cpp \
     pipereader.cpp \
     dptablecalculator.cpp \
+    tablefile.cpp \
     separator.cpp \
     mrstbatchsimulator.cpp \
+    simulatorprocess.cpp \
     pressurebooster.cpp \
     gui/mainwindow.cpp \
     gui/modelscene.cpp \
@@ -126,6 +130,9 @@ SOURCES += main.cpp \
     opt/minlpipoptinterface.cpp \
     par/masterrunner.cpp \
     par/masteroptimizer.cpp \
+    par/remotelauncher.cpp \
+    par/workerclient.cpp \
+    par/workerprotocol.cpp \
     gui/inspectorgaslift.cpp \
     wellpath.cpp \
     gui/inspectorwellpath.cpp \
@@ -133,7 +140,13 @@ SOURCES += main.cpp \
     gui/inspectorconstant.cpp \
     gui/modelitemreservoir.cpp \
     gui/inspectorreservoir.cpp \
-    logger.cpp
+    logger.cpp \
+    evaluationcache.cpp \
+    casescheduler.cpp \
+    casepool.cpp \
+    summarylog.cpp \
+    opt/gradientengine.cpp \
+    opt/jacobianstructure.cpp
 
 HEADERS += \
     well.h \
@@ -145,6 +158,8 @@ HEADERS += \
     model.h \
     pipe.h \
     stream.h \
+    streamseries.h \
+    units.h \
     constraint.h \
     wellconnection.h \
     objective.h \
@@ -179,8 +194,10 @@ HEADERS += \
     dptable.h \
     pipereader.h \
     dptablecalculator.h \
+    tablefile.h \
     separator.h \
     mrstbatchsimulator.h \
+    simulatorprocess.h \
     pressurebooster.h \
     gui/mainwindow.h \
     gui/modelscene.h \
@@ -234,6 +251,9 @@ HEADERS += \
     opt/minlpipoptinterface.h \
     par/masterrunner.h \
     par/masteroptimizer.h \
+    par/remotelauncher.h \
+    par/workerclient.h \
+    par/workerprotocol.h \
     gui/inspectorgaslift.h \
     wellpath.h \
     gui/inspectorwellpath.h \
@@ -241,7 +261,13 @@ HEADERS += \
     gui/inspectorconstant.h \
     gui/modelitemreservoir.h \
     gui/inspectorreservoir.h \
-    logger.h
+    logger.h \
+    evaluationcache.h \
+    casescheduler.h \
+    casepool.h \
+    summarylog.h \
+    opt/gradientengine.h \
+    opt/jacobianstructure.h
 
 RESOURCES += \
     gui/images.qrc
@@ -26,6 +26,9 @@
 #include "case.h"
 #include "derivative.h"
 #include "constraint.h"
+#include "realvariable.h"
+#include "objective.h"
+#include "opt/jacobianstructure.h"
 
 #include <iostream>
 
@@ -72,7 +75,7 @@ AdjointsCoupledModel::AdjointsCoupledModel(const AdjointsCoupledModel &m)
                 }
             }
 
-            m_adjoint_collections.push_back(ac);
+            addAdjointCollection(ac);
         }
     }
 
@@ -96,6 +99,10 @@ void AdjointsCoupledModel::initialize()
     // calling the base class
     CoupledModel::initialize();
 
+    // the constraints have been set up again, the perturbation groups must be found again
+    m_jac_structure.clear();
+    m_perturbation_groups.clear();
+
     // doing adjoints specific initialization
 
     for(int i = 0; i < numberOfWells(); ++i)
@@ -114,7 +121,7 @@ void AdjointsCoupledModel::initialize()
                 }
             }
 
-            m_adjoint_collections.push_back(ac);
+            addAdjointCollection(ac);
         }
     }
 
@@ -156,14 +163,34 @@ void AdjointsCoupledModel::process()
     */
 
 
-    // running perturbations
+    // running perturbations, one for each group of variables that do not affect the same constraints
+    if(m_perturbation_groups.isEmpty()) setupPerturbationGroups();
+
     QVector<Case*> cases;
-    for(int i = 0; i < realVariables().size(); ++i)
+    QVector<int> case_index(numberOfRealVariables(), -1);    // the perturbed case for each variable
+
+    for(int i = 0; i < m_perturbation_groups.size(); ++i)
     {
-        Case *c = processPerturbation(realVariables().at(i));
+        QVector<shared_ptr<RealVariable> > vars;
+        for(int j = 0; j < m_perturbation_groups.at(i).size(); ++j)
+        {
+            vars.push_back(realVariables().at(m_perturbation_groups.at(i).at(j)));
+            case_index[m_perturbation_groups.at(i).at(j)] = cases.size();
+        }
+
+        Case *c = processPerturbation(vars);
         cases.push_back(c);
     }
 
+    // the objective depends on all the variables, variables that were perturbed together are perturbed one by one for the objective
+    QVector<double> obj_perturb(numberOfRealVariables());
+
+    for(int i = 0; i < numberOfRealVariables(); ++i)
+    {
+        if(m_perturbation_groups.at(case_index.at(i)).size() == 1) obj_perturb[i] = cases.at(case_index.at(i))->objectiveValue();
+        else obj_perturb[i] = processObjectivePerturbation(realVariables().at(i));
+    }
+
     // running base case
     Case *base_case = processBaseCase();
 
@@ -184,14 +211,18 @@ void AdjointsCoupledModel::process()
     // calculating derivatives from perturbed cases
     for(int i = 0; i < numberOfRealVariables(); ++i)
     {
-        Case *case_perturb = cases.at(i);
+        Case *case_perturb = cases.at(case_index.at(i));
         int var_id = realVariables().at(i)->id();
 
         // calculating partial derivatives for constraints
         for(int j = 0; j < numberOfConstraints(); ++j)
         {
-            // dC_j / dx_i
-            double dcdx = (case_perturb->constraintValue(j) - base_case->constraintValue(j)) / (case_perturb->realVariableValue(i) - base_case->realVariableValue(i));
+            // dC_j / dx_i (other variables in the same group do not affect the constraint)
+            double dcdx = 0;
+            if(m_jac_structure.at(i * numberOfConstraints() + j))
+            {
+                dcdx = (case_perturb->constraintValue(j) - base_case->constraintValue(j)) / (case_perturb->realVariableValue(i) - base_case->realVariableValue(i));
+            }
 
             // adding to base case
             base_case->constraintDerivative(j)->addPartial(var_id, dcdx);
@@ -199,7 +230,7 @@ void AdjointsCoupledModel::process()
 
         // calculating partial derivative for objective
         double eps_x = (realVariables().at(i)->max() - realVariables().at(i)->min()) * m_perturbation;
-        double dfdx = (case_perturb->objectiveValue() - base_case->objectiveValue()) / eps_x;
+        double dfdx = (obj_perturb.at(i) - base_case->objectiveValue()) / eps_x;
         //double dfdx = (case_perturb->objectiveValue() - base_case->objectiveValue()) / (case_perturb->realVariableValue(i) - base_case->realVariableValue(i));
         base_case->objectiveDerivative()->addPartial(var_id, dfdx);
     }
@@ -227,41 +258,70 @@ void AdjointsCoupledModel::process()
 //-----------------------------------------------------------------------------------------------
 AdjointCollection* AdjointsCoupledModel::adjointCollection(shared_ptr<RealVariable> v)
 {
-    for(int i = 0; i < m_adjoint_collections.size(); ++i)
-    {
-        if(m_adjoint_collections.at(i)->variable() == v) return m_adjoint_collections.at(i);
-    }
+    return m_adjoint_collection_index.value(v.get(), 0);
+}
+
+//-----------------------------------------------------------------------------------------------
+// adds a collection, the first collection for a variable is the one returned by adjointCollection()
+//-----------------------------------------------------------------------------------------------
+void AdjointsCoupledModel::addAdjointCollection(AdjointCollection *ac)
+{
+    m_adjoint_collections.push_back(ac);
 
-    return 0;
+    if(!m_adjoint_collection_index.contains(ac->variable().get())) m_adjoint_collection_index.insert(ac->variable().get(), ac);
 }
 
 
 
 //-----------------------------------------------------------------------------------------------
-// processes the model with a perturbation of v, returns a case with constraint and obj values
+// finds the constraint structure, and groups the variables that can be perturbed together
 //-----------------------------------------------------------------------------------------------
-Case* AdjointsCoupledModel::processPerturbation(shared_ptr<RealVariable> v)
+void AdjointsCoupledModel::setupPerturbationGroups()
 {
-    //cout << "-------- processing perturbation -----------" << endl;
+    JacobianStructure structure;
+    structure.analyze(this, constraints(), realVariables());
 
-    // calculating the perturbation size of the variable
-    double eps_x = (v->max() - v->min()) * m_perturbation;
+    m_jac_structure = structure.structure();
 
-    //cout << "variable: " << v->name().toLatin1().constData() << endl;
-    //cout << "eps_x        = " << eps_x << endl;
+    QVector<int> columns;
+    for(int i = 0; i < numberOfRealVariables(); ++i) columns.push_back(i);
 
+    // the objective is perturbed separately for each variable, and is left out of the grouping
+    m_perturbation_groups = JacobianStructure::groupColumns(columns, numberOfConstraints(), m_jac_structure, QVector<bool>(columns.size(), false));
 
-    // checking if there is an adjoints collection for the variable
-    AdjointCollection *ac = adjointCollection(v);
+    cout << "Perturbing " << columns.size() << " variables in " << m_perturbation_groups.size() << " groups for the constraint derivatives..." << endl;
+}
 
-    if(ac != 0)
-    {
-        // setting the pertrubed values for all streams that have adjoints wrt. the variable
-        ac->perturbStreams(eps_x);
-    }
+//-----------------------------------------------------------------------------------------------
+// processes the model with a perturbation of the variables, returns a case with constraint and obj values
+//-----------------------------------------------------------------------------------------------
+Case* AdjointsCoupledModel::processPerturbation(const QVector<shared_ptr<RealVariable> > &vars)
+{
+    //cout << "-------- processing perturbation -----------" << endl;
+
+    QVector<double> eps(vars.size());
 
-    if(v != 0)
+    for(int i = 0; i < vars.size(); ++i)
     {
+        shared_ptr<RealVariable> v = vars.at(i);
+
+        // calculating the perturbation size of the variable
+        double eps_x = (v->max() - v->min()) * m_perturbation;
+        eps[i] = eps_x;
+
+        //cout << "variable: " << v->name().toLatin1().constData() << endl;
+        //cout << "eps_x        = " << eps_x << endl;
+
+
+        // checking if there is an adjoints collection for the variable
+        AdjointCollection *ac = adjointCollection(v);
+
+        if(ac != 0)
+        {
+            // setting the pertrubed values for all streams that have adjoints wrt. the variable
+            ac->perturbStreams(eps_x);
+        }
+
         // changing the value of the variable to the pertrubed value
         // could be variable connected to separator or booster...
         v->setValue(v->value() + eps_x);
@@ -286,12 +346,15 @@ Case* AdjointsCoupledModel::processPerturbation(shared_ptr<RealVariable> v)
     Case *c = new Case(this, true);
 
 
-    // resetting the variable value
-    v->setValue(v->value() - eps_x);
-
+    for(int i = 0; i < vars.size(); ++i)
+    {
+        // resetting the variable value
+        vars.at(i)->setValue(vars.at(i)->value() - eps.at(i));
 
-    // resetting streams if changed
-    if(ac != 0) ac->perturbStreams(-eps_x);
+        // resetting streams if changed
+        AdjointCollection *ac = adjointCollection(vars.at(i));
+        if(ac != 0) ac->perturbStreams(-eps.at(i));
+    }
 
 
 
@@ -299,6 +362,31 @@ Case* AdjointsCoupledModel::processPerturbation(shared_ptr<RealVariable> v)
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// returns the objective value with one variable perturbed, the pipe pressures are not needed
+//-----------------------------------------------------------------------------------------------
+double AdjointsCoupledModel::processObjectivePerturbation(shared_ptr<RealVariable> var)
+{
+    double eps_x = (var->max() - var->min()) * m_perturbation;
+
+    AdjointCollection *ac = adjointCollection(var);
+
+    // perturbing the variable and the streams
+    if(ac != 0) ac->perturbStreams(eps_x);
+    var->setValue(var->value() + eps_x);
+
+    updateStreams();
+    updateObjectiveValue();
+
+    double obj = objective()->value();
+
+    // resetting the variable and the streams
+    var->setValue(var->value() - eps_x);
+    if(ac != 0) ac->perturbStreams(-eps_x);
+
+    return obj;
+}
+
 //-----------------------------------------------------------------------------------------------
 // processes the model with base case values
 //-----------------------------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include "coupledmodel.h"
 
 #include <QVector>
+#include <QHash>
 
 namespace ResOpt
 {
@@ -46,9 +47,34 @@ private:
     Case *p_results;
 
     QVector<AdjointCollection*> m_adjoint_collections;
+    QHash<RealVariable*, AdjointCollection*> m_adjoint_collection_index;   // the collection for each variable, see addAdjointCollection()
 
+    QVector<bool> m_jac_structure;                  // true if the constraint may depend on the real variable
+    QVector<QVector<int> > m_perturbation_groups;   // the real variables that are perturbed together for the constraints
 
-    Case* processPerturbation(shared_ptr<RealVariable> v);
+
+    /**
+     * @brief Finds the structure of the constraint derivatives, and groups the real variables that can be perturbed together.
+     * @details The objective depends on all the variables, and is left out of the grouping. Its derivatives are found by perturbing the
+     *          variables in groups of more than one variable separately (see processObjectivePerturbation()).
+     *
+     */
+    void setupPerturbationGroups();
+
+    /**
+     * @brief Adds a collection to the list, and to the index used by adjointCollection().
+     *
+     */
+    void addAdjointCollection(AdjointCollection *ac);
+
+    Case* processPerturbation(const QVector<shared_ptr<RealVariable> > &vars);
+
+    /**
+     * @brief Returns the objective value with one variable perturbed.
+     * @details The objective does not depend on the pipe pressures, so only the streams and the objective are updated.
+     *
+     */
+    double processObjectivePerturbation(shared_ptr<RealVariable> var);
     Case* processBaseCase();
 
 
@@ -33,6 +33,18 @@ using std::endl;
 namespace ResOpt
 {
 
+// lowest pressure, pressure spacing and number of points in the z-factor table (bara), pressures below the
+// table are clamped to the lowest point, pressures above the table are calculated exactly
+static const double Z_TABLE_P_MIN = 1.0;
+static const double Z_TABLE_DP = 0.5;
+static const int Z_TABLE_SIZE = 2001;
+
+// relative difference between the table and the iterative solution that is reported in CHECK mode
+static const double Z_TABLE_TOLERANCE = 1e-4;
+
+// relative difference between pressureDrops() and the reference pressureDrop() that is reported in CHECK mode
+static const double BATCH_CHECK_TOLERANCE = 1e-6;
+
 BeggsBrillCalculator::BeggsBrillCalculator()
     : m_sg_gas(0.0),
       m_den_oil(0.0),
@@ -42,7 +54,10 @@ BeggsBrillCalculator::BeggsBrillCalculator()
       m_diameter(0.0),
       m_length(0.0),
       m_angle(0.0),
-      m_temperature(0.0)
+      m_temperature(0.0),
+      m_z_mode(ZTABLE),
+      m_z_table_sg(0.0),
+      m_z_table_t(0.0)
 {
 }
 
@@ -54,7 +69,7 @@ BeggsBrillCalculator::~BeggsBrillCalculator()
 //-----------------------------------------------------------------------------------------------
 double BeggsBrillCalculator::superficialGasVelocity(Stream *s, double p, double z)
 {
-    double gas_rate_surface = s->gasRate(Stream::FIELD) / 86.4;   // the gas rate in Sft^3 / s
+    double gas_rate_surface = s->gasRate<Units::FIELD>().value() / 86.4;   // the gas rate in Sft^3 / s
     double b_g = p * 288.71 / 1.01 / (temperature() + 273.15) / z;
 
     double gas_rate = gas_rate_surface / b_g;       // the gas rate at pipe conditions, ft^3/s
@@ -70,7 +85,7 @@ double BeggsBrillCalculator::superficialGasVelocity(Stream *s, double p, double
 //-----------------------------------------------------------------------------------------------
 double BeggsBrillCalculator::superficialLiquidVelocity(Stream *s)
 {
-    double liquid_rate = s->oilRate(Stream::FIELD) + s->waterRate(Stream::FIELD);     // liquid rate in bbl / d
+    double liquid_rate = (s->oilRate<Units::FIELD>() + s->waterRate<Units::FIELD>()).value();     // liquid rate in bbl / d
 
 
      double liquid_rate_ft = 5.61458333 * liquid_rate / 86400;      // the liquid rate in ft^3 / s
@@ -86,8 +101,8 @@ double BeggsBrillCalculator::superficialLiquidVelocity(Stream *s)
 //-----------------------------------------------------------------------------------------------
 double BeggsBrillCalculator::liquidDensity(Stream *s)
 {
-    double oil_rate = s->oilRate(Stream::METRIC);
-    double water_rate = s->waterRate(Stream::METRIC);
+    double oil_rate = s->oilRate<Units::METRIC>().value();
+    double water_rate = s->waterRate<Units::METRIC>().value();
 
 
 
@@ -146,6 +161,59 @@ double BeggsBrillCalculator::gasZFactor(double yg, double t, double p)
     return a * p_pr / y;
 }
 
+//---------------------------------------------------------------------------------------------------------------
+// finds the gas z-factor for the gas gravity and temperature of the pipe, using the table if possible (p in bara)
+//---------------------------------------------------------------------------------------------------------------
+double BeggsBrillCalculator::gasZFactor(double p)
+{
+    if(m_z_mode == EXACT) return gasZFactor(gasSpecificGravity(), temperature(), p);
+
+    // the correlation breaks down at zero pressure, the table uses its first point for low pressures
+    double p_table = (p < Z_TABLE_P_MIN) ? Z_TABLE_P_MIN : p;
+
+    if(p_table >= Z_TABLE_P_MIN + Z_TABLE_DP * (Z_TABLE_SIZE - 1)) return gasZFactor(gasSpecificGravity(), temperature(), p);
+
+
+    // the table must be reset if the gas gravity or temperature has changed
+    if(m_z_table.size() != Z_TABLE_SIZE || m_z_table_sg != gasSpecificGravity() || m_z_table_t != temperature())
+    {
+        m_z_table.fill(-1.0, Z_TABLE_SIZE);
+        m_z_table_sg = gasSpecificGravity();
+        m_z_table_t = temperature();
+    }
+
+    // finding the bounding points, and calculating them if not already done
+    double x = (p_table - Z_TABLE_P_MIN) / Z_TABLE_DP;
+    int i = static_cast<int>(x);
+    double frac = x - i;
+
+    if(m_z_table.at(i) < 0) m_z_table[i] = gasZFactor(m_z_table_sg, m_z_table_t, Z_TABLE_P_MIN + i * Z_TABLE_DP);
+    if(m_z_table.at(i + 1) < 0) m_z_table[i + 1] = gasZFactor(m_z_table_sg, m_z_table_t, Z_TABLE_P_MIN + (i + 1) * Z_TABLE_DP);
+
+    double z = m_z_table.at(i) * (1 - frac) + m_z_table.at(i + 1) * frac;
+
+
+    // checking against the iterative solution
+    if(m_z_mode == CHECK)
+    {
+        double z_exact = gasZFactor(gasSpecificGravity(), temperature(), p);
+
+        if(fabs(z - z_exact) > Z_TABLE_TOLERANCE * fabs(z_exact))
+        {
+            cout << endl << "### Warning ###" << endl
+                 << "From: Beggs & Brill 1973" << endl
+                 << "The tabulated gas z-factor differs from the iterative solution..." << endl
+                 << "P      : " << p << endl
+                 << "Z_TABLE: " << z << endl
+                 << "Z_EXACT: " << z_exact << endl << endl;
+        }
+
+        return z_exact;
+    }
+
+    return z;
+}
+
 //-----------------------------------------------------------------------------------------------
 // calculates the gas density at pipe conditions
 //-----------------------------------------------------------------------------------------------
@@ -194,8 +262,8 @@ double BeggsBrillCalculator::gasViscosity(double p, double z)
 //-----------------------------------------------------------------------------------------------
 double BeggsBrillCalculator::liquidViscosity(Stream *s)
 {
-    double oil_rate = s->oilRate(Stream::FIELD);
-    double water_rate = s->waterRate(Stream::FIELD);
+    double oil_rate = s->oilRate<Units::FIELD>().value();
+    double water_rate = s->waterRate<Units::FIELD>().value();
 
     if((oil_rate + water_rate) < 1e-6) oil_rate = 1.0;
 
@@ -211,11 +279,14 @@ double BeggsBrillCalculator::liquidViscosity(Stream *s)
 double BeggsBrillCalculator::pressureDrop(Stream *s, double p, Stream::units unit)
 {
     // checking if the rates are zero
-    double total_rate = s->gasRate(Stream::FIELD) + s->oilRate(Stream::FIELD) + s->waterRate(Stream::FIELD);
-    if(total_rate <= 0) return 0.0;
-    if(s->oilRate(true) < 0) return 0.0;
-    if(s->gasRate(true) < 0) return 0.0;
-    if(s->waterRate(true) < 0) return 0.0;
+    double qo = s->oilRate<Units::FIELD>().value();
+    double qg = s->gasRate<Units::FIELD>().value();
+    double qw = s->waterRate<Units::FIELD>().value();
+
+    if(qg + qo + qw <= 0) return 0.0;
+    if(qo < 0) return 0.0;
+    if(qg < 0) return 0.0;
+    if(qw < 0) return 0.0;
     if(p <= 0) return 0.0;
 
     /*
@@ -229,18 +300,18 @@ double BeggsBrillCalculator::pressureDrop(Stream *s, double p, Stream::units uni
 */
     // else getting on with the calculations
 
-    double p_psi = p;
-    if(unit == Stream::METRIC) p_psi = p * 14.5037738;  // pressure in psi
+    double p_psi = Stream::toFieldUnits<Units::Pressure>(p, unit);  // pressure in psi
+    double p_bara = p * Units::factor<Units::Pressure>(static_cast<Units::system>(unit), Units::METRIC);   // pressure in bara, used by the gas property correlations
 
    // cout << "p = " << p_psi << endl;
 
 
     double d_in = diameter() * 39.3700787;              // pipe diameter in inches
     double g = 32.2;                                    // gravitational constant (ft / s^2)
-    double z_fac = gasZFactor(gasSpecificGravity(), temperature(), p);      // gas z-factor
+    double z_fac = gasZFactor(p_bara);                  // gas z-factor
 
     double vsl = superficialLiquidVelocity(s);          // superficial liquid velocity
-    double vsg = superficialGasVelocity(s, p, z_fac);   // superficial gas velocity
+    double vsg = superficialGasVelocity(s, p_bara, z_fac);  // superficial gas velocity
     double vm = vsl + vsg;                              // superficial two phase velocity
 
 
@@ -316,7 +387,7 @@ double BeggsBrillCalculator::pressureDrop(Stream *s, double p, Stream::units uni
 
     // calculating correction factor
     double den_l = liquidDensity(s);                        // liquid density
-    double den_g = gasDensity(temperature(), p, z_fac);         // gas density
+    double den_g = gasDensity(temperature(), p_bara, z_fac);         // gas density
     double surface_tens = surfaceTension(den_g, den_l);     // gas - liquid surface tension
 
     double nlv = vsl * pow(den_l / (g * surface_tens), 0.25);        // liquid velocity number
@@ -409,7 +480,7 @@ double BeggsBrillCalculator::pressureDrop(Stream *s, double p, Stream::units uni
 
 
     // calculating friction factor
-    double vis_g = gasViscosity(p, z_fac);
+    double vis_g = gasViscosity(p_bara, z_fac);
 
     double den_ns = den_l * liquid_content + den_g * (1 - liquid_content);      // no-slip density
     double vis_ns = liquidViscosity(s) * liquid_content + vis_g * (1 - liquid_content);       // no-slip viscosity
@@ -464,10 +535,321 @@ double BeggsBrillCalculator::pressureDrop(Stream *s, double p, Stream::units uni
     double dp_psi_tot = dp_tot * length_ft;
 
 
-    if(unit == Stream::FIELD) return dp_psi_tot;
-    else return dp_psi_tot / 14.5037738;
+    return Stream::fromFieldUnits<Units::Pressure>(dp_psi_tot, unit);
 
 }
 
-} // namespace ResOpt
 
+//-----------------------------------------------------------------------------------------------
+// calculates the pressure drops for a list of points
+//-----------------------------------------------------------------------------------------------
+void BeggsBrillCalculator::pressureDrops(int n, const double *qo, const double *qg, const double *qw, const double *p_outlet, Stream::units unit, double *dp)
+{
+    // coefficients for the horizontal holdup, a * lambda^b / fr^c, indexed by flow regime
+    static const double HOLDUP_COEF[4][3] = {{0.98,  0.4846, 0.0868},     // SEGREGATED
+                                             {0.0,   0.0,    0.0},        // TRANSITION (mix of segregated and intermittent)
+                                             {0.845, 0.5351, 0.0173},     // INTERMITTENT
+                                             {1.065, 0.5824, 0.0609}};    // DISTRIBUTED
+
+    // coefficients for the inclination correction, (1 - lambda) * ln(e * lambda^f * nlv^g * fr^h), indexed by flow regime
+    static const double COR_COEF[4][4] = {{0.011, -3.768, 3.539,  -1.614},    // SEGREGATED
+                                          {0.0,    0.0,   0.0,     0.0},      // TRANSITION, no correction
+                                          {2.96,  -0.305, -0.4473, -0.0978},  // INTERMITTENT
+                                          {0.0,    0.0,   0.0,     0.0}};     // DISTRIBUTED, no correction
+
+    static const double COR_COEF_DOWNHILL[4] = {4.7, -0.3692, 0.1244, -0.5056};   // downhill pipe, all flow regimes are the same
+
+
+    // ---- properties that are the same for all the points ----
+
+    double d_in = diameter() * 39.3700787;              // pipe diameter in inches
+    double g = 32.2;                                    // gravitational constant (ft / s^2)
+    double r_ft = diameter() / 0.3048 / 2;              // pipe radius in ft
+    double area_ft = 3.14159265 * pow(r_ft,2);          // pipe area in ft^2
+    double t_k = temperature() + 273.15;
+    double Mg = gasSpecificGravity()*28.97;             // molecular weight of gas
+
+    // gas viscosity constants
+    double t_r = t_k * 1.8;
+    double A1 = ((9.379 + 0.01607*Mg) * pow(t_r, 1.5)) / (209.2 + 19.26*Mg + t_r);
+    double A2 = (3.448 + 986.4/t_r + 0.01009*Mg);
+    double A3 = 2.447 - 0.2224*A2;
+
+    // inclination
+    bool downhill = angle() < 0;
+    double payne_cor = downhill ? 0.685 : 0.924;        // Payne correction factor to holdup
+    double sin_incl = sin(3.14159265 * 1.8*angle() / 180);
+    double incl = sin_incl - 0.333 * pow(sin_incl, 3);
+    double sin_angle = sin(angle(true));
+
+    double length_ft = length() * 3.28;
+
+
+    // ---- setting up the work arrays ----
+
+    enum {W_P, W_P_PSI, W_QG, W_VSL, W_DEN_L, W_VIS_L, W_Z, W_VSG, W_VM, W_FR, W_LAM, W_DEN_G, W_NLV, W_VIS_G, W_HOLDUP, W_SIZE};
+
+    if(m_work.size() < W_SIZE * n) m_work.resize(W_SIZE * n);
+    if(m_work_index.size() < n) m_work_index.resize(n);
+    if(m_work_regime.size() < n) m_work_regime.resize(n);
+
+    double *w = m_work.data();
+    double *w_p = w + W_P * n;
+    double *w_p_psi = w + W_P_PSI * n;
+    double *w_qg = w + W_QG * n;
+    double *w_vsl = w + W_VSL * n;
+    double *w_den_l = w + W_DEN_L * n;
+    double *w_vis_l = w + W_VIS_L * n;
+    double *w_z = w + W_Z * n;
+    double *w_vsg = w + W_VSG * n;
+    double *w_vm = w + W_VM * n;
+    double *w_fr = w + W_FR * n;
+    double *w_lam = w + W_LAM * n;
+    double *w_den_g = w + W_DEN_G * n;
+    double *w_nlv = w + W_NLV * n;
+    double *w_vis_g = w + W_VIS_G * n;
+    double *w_holdup = w + W_HOLDUP * n;
+
+    int *index = m_work_index.data();
+    int *regime = m_work_regime.data();
+
+
+    // ---- stage 1: removing the points with no flow, and calculating the liquid properties ----
+
+    int m = 0;  // number of points with flow
+
+    // the conversion factors from the input units, the same for all the points
+    Units::system u = static_cast<Units::system>(unit);
+    double f_liquid_field = Units::factor<Units::LiquidRate>(u, Units::FIELD);
+    double f_liquid_metric = Units::factor<Units::LiquidRate>(u, Units::METRIC);
+    double f_gas_field = Units::factor<Units::GasRate>(u, Units::FIELD);
+    double f_pres_field = Units::factor<Units::Pressure>(u, Units::FIELD);
+    double f_pres_metric = Units::factor<Units::Pressure>(u, Units::METRIC);
+
+    for(int i = 0; i < n; ++i)
+    {
+        double qo_f = qo[i] * f_liquid_field;
+        double qg_f = qg[i] * f_gas_field;
+        double qw_f = qw[i] * f_liquid_field;
+
+        dp[i] = 0.0;
+
+        if(qo_f + qg_f + qw_f <= 0 || qo[i] < 0 || qg[i] < 0 || qw[i] < 0 || p_outlet[i] <= 0) continue;
+
+        double qo_m = qo[i] * f_liquid_metric;
+        double qw_m = qw[i] * f_liquid_metric;
+
+        index[m] = i;
+        w_p[m] = p_outlet[i] * f_pres_metric;
+        w_p_psi[m] = p_outlet[i] * f_pres_field;
+        w_qg[m] = qg_f;
+
+        // superficial liquid velocity
+        w_vsl[m] = 5.61458333 * (qo_f + qw_f) / 86400 / area_ft;
+
+        // liquid density
+        if((qo_m + qw_m) < 1e-6) qo_m = 1;
+        w_den_l[m] = 0.0624279606 * ((qo_m * oilDensity() + qw_m * waterDensity()) / (qo_m + qw_m));
+
+        // liquid viscosity
+        if((qo_f + qw_f) < 1e-6) qo_f = 1.0;
+        w_vis_l[m] = (qo_f * oilViscosity() + qw_f * waterViscosity()) / (qo_f + qw_f);
+
+        ++m;
+    }
+
+
+    // ---- stage 2: gas z-factors ----
+
+    for(int k = 0; k < m; ++k) w_z[k] = gasZFactor(w_p[k]);
+
+
+    // ---- stage 3: velocities, gas properties, and dimensionless numbers ----
+
+    for(int k = 0; k < m; ++k)
+    {
+        double b_g = w_p[k] * 288.71 / 1.01 / t_k / w_z[k];
+        w_vsg[k] = w_qg[k] / 86.4 / b_g / area_ft;
+        w_vm[k] = w_vsl[k] + w_vsg[k];
+
+        w_fr[k] = pow(w_vm[k], 2) / d_in / g;
+
+        double lam = w_vsl[k] / w_vm[k];
+        w_lam[k] = (lam < 1e-8) ? 1e-8 : lam;
+
+        double den_g_metric = (w_p[k] * Mg) / (83.143 * w_z[k] * t_k);
+        w_den_g[k] = 0.0624279606 * den_g_metric;
+
+        double surface_tens = 15.0 + 0.91 * (w_den_l[k] - w_den_g[k]);
+        w_nlv[k] = w_vsl[k] * pow(w_den_l[k] / (g * surface_tens), 0.25);
+
+        w_vis_g[k] = 1E-4*A1 * exp(A2* pow(A2*den_g_metric / 1000, A3));
+    }
+
+
+    // ---- stage 4: flow regimes ----
+
+    for(int k = 0; k < m; ++k)
+    {
+        double lam = w_lam[k];
+        double fr = w_fr[k];
+
+        double l1 = 316 * pow(lam, 0.302);
+        double l2 = 0.0009252 * pow(lam, -2.4684);
+        double l3 = 0.10 * pow(lam, -1.4516);
+        double l4 = 0.5 * pow(lam, -6.738);
+
+        int r = UNDEFINED;
+
+        if(lam < 0.01 && fr < l1) r = SEGREGATED;
+        else if(lam >= 0.01 && fr < l2) r = SEGREGATED;
+        else if(lam >= 0.01 && fr >= l2 && fr <= l3) r = TRANSITION;
+        else if(lam >= 0.01 && lam < 0.4 && fr > l3 && fr <= l1) r = INTERMITTENT;
+        else if(lam >= 0.4 && fr > l3 && fr <= l4) r = INTERMITTENT;
+        else if(lam < 0.4 && fr >= l1) r = DISTRIBUTED;
+        else if(lam >= 0.4 && fr > l4) r = DISTRIBUTED;
+
+        if(r == UNDEFINED)  // the current conditions are not covered by Beggs & Brill...
+        {
+            Stream s(0, qo[index[k]], qg[index[k]], qw[index[k]], 0, unit);
+
+            cout << endl << "### Warning ###" << endl
+                 << "From: Beggs & Brill 1973" << endl
+                 << "The flow regime could not be determined..." << endl
+                 << "Assuming INTERMITTENT flow..." << endl
+                 << "For the current stream:" << endl << endl;
+            s.printToCout();
+
+            r = INTERMITTENT;
+        }
+
+        regime[k] = r;
+    }
+
+
+    // ---- stage 5: liquid holdup ----
+
+    for(int k = 0; k < m; ++k)
+    {
+        double lam = w_lam[k];
+        double fr = w_fr[k];
+        double nlv = w_nlv[k];
+        int r = regime[k];
+
+        // the inclination correction for the regime
+        const double *c = downhill ? COR_COEF_DOWNHILL : COR_COEF[r];
+        double cor = (c[0] == 0.0) ? 0.0 : (1 - lam) * log(c[0] * pow(lam, c[1]) * pow(nlv, c[2]) * pow(fr, c[3]));
+
+        if(cor < 0)
+        {
+            cout << endl << "### Warning ###" << endl
+                 << "From: Beggs & Brill 1973" << endl
+                 << "The calculated correction factor, C, is negative..." << endl
+                 << "Resetting to 0.0..." << endl << endl;
+            cor = 0.0;
+        }
+
+        double holdup;
+
+        if(r != TRANSITION)
+        {
+            const double *h = HOLDUP_COEF[r];
+            double hz_holdup = (h[0] * pow(lam, h[1])) / pow(fr, h[2]);
+
+            // sets the horizontal holdup to the liquid content if smaller
+            if(hz_holdup < lam) hz_holdup = lam;
+
+            holdup = payne_cor * hz_holdup * (1 + cor * incl);
+        }
+        else    // the liquid holdup is a mix of segregated and intermittent
+        {
+            const double *h_seg = HOLDUP_COEF[SEGREGATED];
+            const double *h_int = HOLDUP_COEF[INTERMITTENT];
+            const double *c_seg = downhill ? COR_COEF_DOWNHILL : COR_COEF[SEGREGATED];
+            const double *c_int = downhill ? COR_COEF_DOWNHILL : COR_COEF[INTERMITTENT];
+
+            double l2 = 0.0009252 * pow(lam, -2.4684);
+            double l3 = 0.10 * pow(lam, -1.4516);
+            double frac = (l3 - fr) / (l3 -l2);
+
+            // horizontal holdups
+            double hz_holdup_seg = frac * (h_seg[0] * pow(lam, h_seg[1])) / pow(fr, h_seg[2]);
+            double hz_holdup_int = (1 - frac) * (h_int[0] * pow(lam, h_int[1])) / pow(fr, h_int[2]);
+
+            if(hz_holdup_seg < lam) hz_holdup_seg = lam;
+            if(hz_holdup_int < lam) hz_holdup_int = lam;
+
+            // correction factors
+            double cor_seg = (1 - lam) * log(c_seg[0] * pow(lam, c_seg[1]) * pow(nlv, c_seg[2]) * pow(fr, c_seg[3]));
+            double cor_int = (1 - lam) * log(c_int[0] * pow(lam, c_int[1]) * pow(nlv, c_int[2]) * pow(fr, c_int[3]));
+
+            holdup = payne_cor * (frac * (hz_holdup_seg * (1 + cor_seg * incl)) + (1 - frac) * (hz_holdup_int * (1 + cor_int * incl)));
+        }
+
+        w_holdup[k] = (holdup > 1.0) ? 1.0 : holdup;
+    }
+
+
+    // ---- stage 6: friction, elevation, and acceleration ----
+
+    for(int k = 0; k < m; ++k)
+    {
+        double lam = w_lam[k];
+        double holdup = w_holdup[k];
+        double vm = w_vm[k];
+
+        // pressure drop due to elevation change
+        double den_s = w_den_l[k] * holdup + w_den_g[k] * (1 - holdup);
+        double dp_el = den_s * sin_angle / 144;
+
+        // no-slip properties
+        double den_ns = w_den_l[k] * lam + w_den_g[k] * (1 - lam);
+        double vis_ns = w_vis_l[k] * lam + w_vis_g[k] * (1 - lam);
+
+        double re_ns = 124*(den_ns * vm * d_in) / vis_ns;
+        double fn = 1 / (2 * log10(pow(re_ns / (4.5223 * log10(re_ns) - 3.8215), 2)));
+
+        // two phase friction factor
+        double y = lam / pow(holdup, 2);
+        double ln_y = log(y);
+        double s_term = (y > 1.0 && y < 1.2) ? log(2.2*y -1.2) : ln_y / (-0.0523 + 3.182 * ln_y - 0.8725 * pow(ln_y, 2) + 0.01853 * pow(ln_y, 4));
+
+        double ftp = fn * exp(s_term);
+
+        // pressure drop due to friction
+        double dp_f = 5.176e-3 * (ftp * den_ns * pow(vm,2)) / (d_in);
+
+        // acceleration term
+        double ek = 2.16e-4 * (den_ns * vm * w_vsg[k]) / w_p_psi[k];
+
+        // total pressure drop in psi
+        double dp_psi_tot = (dp_f + dp_el) / (1 - ek) * length_ft;
+
+        dp[index[k]] = dp_psi_tot / f_pres_field;
+    }
+
+
+    // ---- checking against the reference implementation ----
+
+    if(m_z_mode == CHECK)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            Stream s(0, qo[i], qg[i], qw[i], 0, unit);
+            double dp_ref = pressureDrop(&s, p_outlet[i], unit);
+
+            if(fabs(dp[i] - dp_ref) > BATCH_CHECK_TOLERANCE * fabs(dp_ref))
+            {
+                cout << endl << "### Warning ###" << endl
+                     << "From: Beggs & Brill 1973" << endl
+                     << "The batch pressure drop differs from the point by point calculation..." << endl
+                     << "POINT   : " << i << endl
+                     << "DP_BATCH: " << dp[i] << endl
+                     << "DP_REF  : " << dp_ref << endl << endl;
+            }
+        }
+    }
+
+}
+
+} // namespace ResOpt
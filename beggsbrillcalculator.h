@@ -24,6 +24,8 @@
 
 #include "pressuredropcalculator.h"
 
+#include <QVector>
+
 
 namespace ResOpt
 {
@@ -37,6 +39,14 @@ class BeggsBrillCalculator : public PressureDropCalculator
 public:
     enum flow_regime {SEGREGATED, TRANSITION, INTERMITTENT, DISTRIBUTED, UNDEFINED};
 
+    /**
+     * @brief How the gas z-factor is found.
+     * @details ZTABLE interpolates a table of z-factors vs. pressure, EXACT runs the iterative solution every time, and CHECK runs both,
+     *          reports when the table is off, and uses the iterative solution. In CHECK mode the results of pressureDrops() are also compared
+     *          with pressureDrop() for each point, and the differences are reported.
+     */
+    enum z_factor_mode {ZTABLE, EXACT, CHECK};
+
 private:
     double m_sg_gas;        // gas specific gravity
     double m_den_oil;       // oil density
@@ -50,11 +60,21 @@ private:
     double m_angle;         // inclination of pipe
     double m_temperature;   // average temperature in pipe
 
+    z_factor_mode m_z_mode;
+    QVector<double> m_z_table;  // z-factor at evenly spaced pressures in bara, filled in on demand (negative when not calculated yet)
+    double m_z_table_sg;        // gas specific gravity the table was made for
+    double m_z_table_t;         // temperature the table was made for
+
+    QVector<double> m_work;     // work arrays for pressureDrops()
+    QVector<int> m_work_index;
+    QVector<int> m_work_regime;
+
     // private calculate functions
     double superficialGasVelocity(Stream *s, double p, double z);
     double superficialLiquidVelocity(Stream *s);
     double liquidDensity(Stream *s);
     double gasZFactor(double yg, double t, double p);
+    double gasZFactor(double p);
     double gasDensity(double t, double p, double z);
     double surfaceTension(double gas_density, double liquid_density);
     double gasViscosity(double p, double z);
@@ -82,6 +102,16 @@ public:
      */
     virtual double pressureDrop(Stream *s, double p_outlet, Stream::units unit);
 
+    /**
+     * @brief Calculates the pressure drop for a list of points in one go.
+     * @details Gives the same results as calling pressureDrop() for each point, which is kept as the reference implementation (checked
+     *          in CHECK mode).
+     *          The calculation is done in stages over contiguous arrays. The properties of the pipe are calculated once, and the flow
+     *          regime dependent coefficients are looked up in tables instead of branching for each point.
+     *
+     */
+    virtual void pressureDrops(int n, const double *qo, const double *qg, const double *qw, const double *p_outlet, Stream::units unit, double *dp);
+
     // set functions
 
     void setDiameter(double d) {m_diameter = d;}
@@ -93,6 +123,7 @@ public:
     void setWaterDensity(double d) {m_den_wat = d;}
     void setOilViscosity(double v) {m_vis_oil = v;}
     void setWaterViscosity(double v) {m_vis_wat = v;}
+    void setZFactorMode(z_factor_mode m) {m_z_mode = m;}
 
     // get functions
 
@@ -104,6 +135,7 @@ public:
     double waterDensity() {return m_den_wat;}
     double oilViscosity() {return m_vis_oil;}
     double waterViscosity() {return m_vis_wat;}
+    z_factor_mode zFactorMode() {return m_z_mode;}
 
     /**
      * @brief Returns the inclination angle of the pipe in either degrees or radians
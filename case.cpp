@@ -36,17 +36,24 @@ using std::endl;
 namespace ResOpt
 {
 
+// objective value of a case that could not be evaluated, all the objectives are maximized
+static const double CASE_FAILED_OBJECTIVE = -1e20;
+
 Case::Case()
     : m_objective_value(0),
       p_objective_derivative(0),
-      m_infeasibility(0)
+      m_infeasibility(0),
+      m_failed(false),
+      m_cancelled(false)
 {
 }
 
 Case::Case(Model *m, bool cpy_output)
     : m_objective_value(0),
       p_objective_derivative(0),
-      m_infeasibility(0)
+      m_infeasibility(0),
+      m_failed(false),
+      m_cancelled(false)
 {
     // adding real variables
     for(int i = 0; i < m->realVariables().size(); ++i)
@@ -85,32 +92,62 @@ Case::Case(Model *m, bool cpy_output)
 Case::Case(const Case &c, bool cpy_output)
     : m_objective_value(0),
       p_objective_derivative(0),
-      m_infeasibility(0)
+      m_infeasibility(0),
+      m_failed(false),
+      m_cancelled(false)
 {
-    for(int i = 0; i < c.numberOfRealVariables(); ++i)
-    {
-        m_real_var_values.push_back(c.m_real_var_values.at(i));
-    }
+    copyFrom(c, cpy_output);
+}
 
-    for(int i = 0; i < c.numberOfBinaryVariables(); ++i)
-    {
-        m_binary_var_values.push_back(c.m_binary_var_values.at(i));
-    }
+Case::~Case()
+{
+
+
+    if(p_objective_derivative != 0) delete p_objective_derivative;
+
+    for(int i = 0; i < m_constraint_derivatives.size(); ++i) delete m_constraint_derivatives.at(i);
+
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// copies the values of one vector into another, reusing the storage of the destination
+//-----------------------------------------------------------------------------------------------
+template<typename T>
+static void copyValues(QVector<T> &to, const QVector<T> &from)
+{
+    to.resize(from.size());
+
+    T *data = to.data();
+    for(int i = 0; i < from.size(); ++i) data[i] = from.at(i);
+}
+
+//-----------------------------------------------------------------------------------------------
+// Copies the values from another case, reusing the allocated storage
+//-----------------------------------------------------------------------------------------------
+void Case::copyFrom(const Case &c, bool cpy_output)
+{
+    if(this == &c) return;
 
-    for(int i = 0; i < c.numberOfIntegerVariables(); ++i)
+    copyValues(m_real_var_values, c.m_real_var_values);
+    copyValues(m_binary_var_values, c.m_binary_var_values);
+    copyValues(m_integer_var_values, c.m_integer_var_values);
+
+
+    // deleting the old derivatives
+    for(int i = 0; i < m_constraint_derivatives.size(); ++i) delete m_constraint_derivatives.at(i);
+    m_constraint_derivatives.resize(0);
+
+    if(p_objective_derivative != 0)
     {
-        m_integer_var_values.push_back(c.m_integer_var_values.at(i));
+        delete p_objective_derivative;
+        p_objective_derivative = 0;
     }
 
 
-
     if(cpy_output)  // copy the constraints and objective too
     {
-        for(int i = 0; i < c.numberOfConstraints(); ++i)
-        {
-            m_constraint_values.push_back(c.m_constraint_values.at(i));
-        }
-
+        copyValues(m_constraint_values, c.m_constraint_values);
         m_objective_value = c.m_objective_value;
 
         for(int i = 0; i < c.m_constraint_derivatives.size(); ++i)
@@ -121,22 +158,46 @@ Case::Case(const Case &c, bool cpy_output)
         if(c.p_objective_derivative != 0) p_objective_derivative = new Derivative(*c.p_objective_derivative);
 
         m_infeasibility = c.m_infeasibility;
-
-
+        m_failed = c.m_failed;
+        m_cancelled = c.m_cancelled;
+    }
+    else
+    {
+        m_constraint_values.resize(0);
+        m_objective_value = 0;
+        m_infeasibility = 0;
+        m_failed = false;
+        m_cancelled = false;
     }
-
 
 }
 
-Case::~Case()
+//-----------------------------------------------------------------------------------------------
+// Marks the case as failed
+//-----------------------------------------------------------------------------------------------
+void Case::setFailed(Model *m)
 {
+    m_constraint_values.resize(0);
 
+    // each constraint is broken by more than the tolerance, also when the upper bound is very large
+    for(int i = 0; i < m->constraints().size(); ++i)
+    {
+        double max = m->constraints().at(i)->max();
+        addConstraintValue(max + 1.0 + fabs(max));
+    }
 
-    if(p_objective_derivative != 0) delete p_objective_derivative;
-
-    for(int i = 0; i < m_constraint_derivatives.size(); ++i) delete m_constraint_derivatives.at(i);
-
+    m_objective_value = CASE_FAILED_OBJECTIVE;
+    m_infeasibility = HUGE_VAL;
+    m_failed = true;
+}
 
+//-----------------------------------------------------------------------------------------------
+// Marks the case as cancelled
+//-----------------------------------------------------------------------------------------------
+void Case::setCancelled(Model *m)
+{
+    setFailed(m);
+    m_cancelled = true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -144,35 +205,7 @@ Case::~Case()
 //-----------------------------------------------------------------------------------------------
 Case& Case::operator =(const Case &rhs)
 {
-    if(this != &rhs)
-    {
-        m_real_var_values = rhs.m_real_var_values;
-        m_binary_var_values = rhs.m_binary_var_values;
-        m_integer_var_values = rhs.m_integer_var_values;
-
-        m_constraint_values = rhs.m_constraint_values;
-        m_objective_value = rhs.m_objective_value;
-
-        for(int i = 0; i < m_constraint_derivatives.size(); ++i) delete m_constraint_derivatives.at(i);
-        m_constraint_derivatives.resize(0);
-
-
-        for(int i = 0; i < rhs.m_constraint_derivatives.size(); ++i)
-        {
-            m_constraint_derivatives.push_back(new Derivative(*rhs.m_constraint_derivatives.at(i)));
-        }
-
-        if(p_objective_derivative != 0)
-        {
-            delete p_objective_derivative;
-            p_objective_derivative = 0;
-        }
-
-        if(rhs.p_objective_derivative != 0) p_objective_derivative =  new Derivative(*rhs.p_objective_derivative);
-
-        m_infeasibility = rhs.m_infeasibility;
-
-    }
+    copyFrom(rhs, true);
 
     return *this;
 }
@@ -23,6 +23,7 @@
 #define CASE_H
 
 #include <QVector>
+#include <math.h>
 
 namespace ResOpt
 {
@@ -54,6 +55,8 @@ private:
     Derivative *p_objective_derivative;
 
     double m_infeasibility;
+    bool m_failed;                      // true if the model could not be evaluated
+    bool m_cancelled;                   // true if the evaluation was cancelled before it finished
 
 public:
     Case();
@@ -61,8 +64,36 @@ public:
     Case(const Case &c, bool cpy_output = false);    // only copies obj and con if cpy_output = true
     ~Case();
 
+    /**
+     * @brief Copies the variable values (and the outputs if cpy_output = true) from c into this Case.
+     * @details The storage allready allocated by this Case is reused, so that Cases taken from a CasePool do not allocate new memory
+     *          when they are filled with new values. The outputs are reset if cpy_output = false.
+     *
+     * @param c
+     * @param cpy_output
+     */
+    void copyFrom(const Case &c, bool cpy_output = false);
+
     void clearConstraints() {m_constraint_values.resize(0);}
 
+    /**
+     * @brief Marks the Case as failed, when the model could not be evaluated (e.g. the simulator crashed, timed out, or the run was cancelled).
+     * @details The case is flagged as failed (see isFailed()). All the constraints of the Model are also set to values above their upper
+     *          bounds, the objective is set to a very low value, and the infeasibility is set to infinity. This way a failed case is always
+     *          infeasible, and is never selected by optimizers that only look at the values.
+     *
+     * @param m
+     */
+    void setFailed(Model *m);
+
+    /**
+     * @brief Marks the Case as cancelled, when the evaluation was stopped because the result was no longer needed.
+     * @details The case is also marked as failed (see setFailed()), but optimizers can tell from isCancelled() that the point itself is fine.
+     *
+     * @param m
+     */
+    void setCancelled(Model *m);
+
     void printToCout();
 
     // add functions
@@ -84,6 +115,14 @@ public:
 
     void setInfeasibility(double i) {m_infeasibility = i;}
 
+    /**
+     * @brief Sets the failed flag without changing the values, and clears the cancelled flag. Used when a case is read back from a stream,
+     *        or has been evaluated again.
+     *
+     * @param b
+     */
+    void setFailedFlag(bool b) {m_failed = b; m_cancelled = false;}
+
     // get functions
     int numberOfRealVariables() const {return m_real_var_values.size();}
     int numberOfBinaryVariables() const {return m_binary_var_values.size();}
@@ -103,6 +142,8 @@ public:
     Derivative* objectiveDerivative() {return p_objective_derivative;}
 
     double infeasibility() {return m_infeasibility;}
+    bool isFailed() const {return m_failed;}
+    bool isCancelled() const {return m_cancelled;}
 
     // overloaded operators
     Case& operator=(const Case &rhs);
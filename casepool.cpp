@@ -0,0 +1,72 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "casepool.h"
+#include "case.h"
+#include "casequeue.h"
+
+namespace ResOpt
+{
+
+CasePool::CasePool()
+{
+}
+
+CasePool::~CasePool()
+{
+    for(int i = 0; i < m_free.size(); ++i) delete m_free.at(i);
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns a case with the values of c, reusing a released case if possible
+//-----------------------------------------------------------------------------------------------
+Case* CasePool::newCase(const Case &c, bool cpy_output)
+{
+    if(m_free.isEmpty()) return new Case(c, cpy_output);
+
+    Case *c_new = m_free.last();
+    m_free.pop_back();
+
+    c_new->copyFrom(c, cpy_output);
+
+    return c_new;
+}
+
+//-----------------------------------------------------------------------------------------------
+// gives a case back to the pool
+//-----------------------------------------------------------------------------------------------
+void CasePool::release(Case *c)
+{
+    if(c != 0) m_free.push_back(c);
+}
+
+//-----------------------------------------------------------------------------------------------
+// gives all the cases in a queue back to the pool
+//-----------------------------------------------------------------------------------------------
+void CasePool::release(CaseQueue *q)
+{
+    for(int i = 0; i < q->size(); ++i) release(q->at(i));
+
+    q->clear();
+}
+
+} // namespace ResOpt
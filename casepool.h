@@ -0,0 +1,82 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef CASEPOOL_H
+#define CASEPOOL_H
+
+#include <QVector>
+
+namespace ResOpt
+{
+
+class Case;
+class CaseQueue;
+
+
+/**
+ * @brief Recycles Cases between iterations of an optimizer.
+ * @details Cases that are released to the pool are kept, and handed out again by newCase(). The values are copied into the storage
+ *          that the Case allready has (see Case::copyFrom()), so sweeps that set up many Cases of the same size in each iteration do
+ *          not allocate new memory after the first iteration. The pool owns the released Cases, and deletes them when it is deleted.
+ *
+ */
+class CasePool
+{
+private:
+    QVector<Case*> m_free;      // released cases, ready to be used again
+
+public:
+    CasePool();
+    ~CasePool();
+
+    /**
+     * @brief Returns a Case with the variable values of c, and the outputs if cpy_output = true.
+     * @details A released Case is reused if there is one, otherwise a new Case is allocated.
+     *
+     * @param c
+     * @param cpy_output
+     * @return Case
+     */
+    Case* newCase(const Case &c, bool cpy_output = false);
+
+    /**
+     * @brief Gives the Case back to the pool. The Case must not be used after it is released.
+     *
+     * @param c
+     */
+    void release(Case *c);
+
+    /**
+     * @brief Gives all the Cases in the queue back to the pool, and empties the queue.
+     *
+     * @param q
+     */
+    void release(CaseQueue *q);
+
+
+    int numberOfFreeCases() const {return m_free.size();}
+
+};
+
+} // namespace ResOpt
+
+#endif // CASEPOOL_H
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#include "casescheduler.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+
+#include "launcher.h"
+
+namespace ResOpt
+{
+
+CaseScheduler::CaseScheduler()
+    : m_paused(false)
+{
+}
+
+//-----------------------------------------------------------------------------------------------
+// registers a launcher
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::addLauncher(Launcher *l)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_idle_launchers.push_back(l);
+}
+
+//-----------------------------------------------------------------------------------------------
+// unregisters a launcher
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::removeLauncher(Launcher *l)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_idle_launchers.removeAll(l);
+    m_running.remove(l);
+}
+
+//-----------------------------------------------------------------------------------------------
+// removes all launchers and jobs
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_queue.clear();
+    m_idle_launchers.clear();
+    m_running.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+// adds jobs to the queue, and wakes up idle launchers
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::submit(const QVector<Job> &jobs)
+{
+    QVector<Launcher*> wake;
+
+    m_mutex.lock();
+
+    for(int i = 0; i < jobs.size(); ++i) m_queue.push_back(jobs.at(i));
+
+    // no need to wake up more launchers than there are new jobs
+    while(wake.size() < jobs.size() && !m_idle_launchers.isEmpty())
+    {
+        wake.push_back(m_idle_launchers.last());
+        m_idle_launchers.pop_back();
+    }
+
+    m_mutex.unlock();
+
+    // the launchers start pulling jobs in their own threads
+    for(int i = 0; i < wake.size(); ++i)
+    {
+        QMetaObject::invokeMethod(wake.at(i), "work", Qt::QueuedConnection);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// hands out the next job
+//-----------------------------------------------------------------------------------------------
+bool CaseScheduler::take(Launcher *l, Job *job)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(m_paused) m_resume.wait(&m_mutex);
+
+    if(m_queue.isEmpty())
+    {
+        // no more work, the launcher is idle until new jobs are submitted
+        if(!m_idle_launchers.contains(l)) m_idle_launchers.push_back(l);
+        return false;
+    }
+
+    *job = m_queue.takeFirst();
+
+    m_running.insert(l, job->c);
+
+    // the launcher is evaluating the case from now on, a cancellation of the case can not be missed
+    l->setCurrentCase(job->c);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// a launcher has finished a case
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::finished(Launcher *l, Case *c)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_running.remove(l, c);
+}
+
+//-----------------------------------------------------------------------------------------------
+// cancels a list of cases
+//-----------------------------------------------------------------------------------------------
+QVector<Case*> CaseScheduler::cancel(const QVector<Case*> &cases)
+{
+    QVector<Case*> removed;
+    QVector<Launcher*> running;
+
+    m_mutex.lock();
+
+    for(int i = m_queue.size() - 1; i >= 0; --i)
+    {
+        if(cases.contains(m_queue.at(i).c)) removed.push_front(m_queue.takeAt(i).c);
+    }
+
+    for(QMultiHash<Launcher*, Case*>::const_iterator it = m_running.constBegin(); it != m_running.constEnd(); ++it)
+    {
+        if(cases.contains(it.value()) && !running.contains(it.key())) running.push_back(it.key());
+    }
+
+    m_mutex.unlock();
+
+    // the launchers check that they are still evaluating one of the cases
+    for(int i = 0; i < running.size(); ++i) running.at(i)->cancel(cases);
+
+    return removed;
+}
+
+//-----------------------------------------------------------------------------------------------
+// pauses / resumes the scheduler
+//-----------------------------------------------------------------------------------------------
+void CaseScheduler::setPaused(bool paused)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_paused = paused;
+
+    if(!paused) m_resume.wakeAll();
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the number of jobs waiting in the queue
+//-----------------------------------------------------------------------------------------------
+int CaseScheduler::numberOfWaitingJobs()
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_queue.size();
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks if the scheduler is paused
+//-----------------------------------------------------------------------------------------------
+bool CaseScheduler::isPaused()
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_paused;
+}
+
+} // namespace ResOpt
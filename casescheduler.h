@@ -0,0 +1,158 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef CASESCHEDULER_H
+#define CASESCHEDULER_H
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+namespace ResOpt
+{
+
+class Case;
+class Component;
+class Launcher;
+
+
+/**
+ * @brief Thread safe queue of cases waiting to be evaluated by the Launchers.
+ * @details The Runner adds cases to the scheduler through submit(). The Launchers pull cases from the scheduler through take() from their
+ *          own threads whenever they are done with the previous case, so no round trip through the event loop of the Runner is needed
+ *          between two cases. Cases may be added while earlier cases are still being evaluated.
+ *
+ *          Launchers that find the queue empty are registered as idle, and are woken up (through their work() slot) when new cases are submitted.
+ *
+ */
+class CaseScheduler
+{
+public:
+
+    /**
+     * @brief A case waiting in the queue, together with the component that should be evaluated.
+     *
+     */
+    struct Job
+    {
+        Case *c;
+        Component *comp;
+
+        Job() : c(0), comp(0) {}
+        Job(Case *cs, Component *cmp) : c(cs), comp(cmp) {}
+    };
+
+private:
+    QList<Job> m_queue;
+    QVector<Launcher*> m_idle_launchers;
+    QMultiHash<Launcher*, Case*> m_running; // the cases handed out to each launcher that have not finished yet
+    bool m_paused;
+
+    QMutex m_mutex;
+    QWaitCondition m_resume;
+
+public:
+    CaseScheduler();
+
+
+    /**
+     * @brief Registers a Launcher with the scheduler. The Launcher starts out as idle.
+     *
+     * @param l
+     */
+    void addLauncher(Launcher *l);
+
+
+    /**
+     * @brief Removes a Launcher from the scheduler. Used when a remote worker disconnects.
+     *
+     * @param l
+     */
+    void removeLauncher(Launcher *l);
+
+
+    /**
+     * @brief Removes all Launchers and all waiting cases from the scheduler.
+     *
+     */
+    void clear();
+
+
+    /**
+     * @brief Adds a list of jobs to the end of the queue, and wakes up idle Launchers to evaluate them.
+     *
+     * @param jobs
+     */
+    void submit(const QVector<Job> &jobs);
+
+
+    /**
+     * @brief Takes the next job from the queue.
+     * @details This function is called by the Launchers from their own threads. If the scheduler is paused, the call blocks until it is resumed.
+     *          If the queue is empty, the Launcher is registered as idle, and false is returned. The case of the job is set as the current
+     *          case of the Launcher before the lock is released (see Launcher::setCurrentCase()).
+     *
+     * @param l the Launcher asking for work
+     * @param job the next job (output)
+     * @return bool false if the queue was empty
+     */
+    bool take(Launcher *l, Job *job);
+
+
+    /**
+     * @brief Tells the scheduler that a Launcher has finished a case, so that it is no longer considered running.
+     * @details A RemoteLauncher may have several cases running at the same time, they are all tracked until they finish.
+     *
+     * @param l
+     * @param c
+     */
+    void finished(Launcher *l, Case *c);
+
+
+    /**
+     * @brief Cancels a list of cases.
+     * @details The cases that are still waiting in the queue are removed, and returned. The Launchers that are evaluating any of the
+     *          other cases are asked to stop (see Launcher::cancel()), and report the cases as finished when they are done.
+     *
+     * @param cases
+     * @return QVector<Case*> the cases that were removed from the queue
+     */
+    QVector<Case*> cancel(const QVector<Case*> &cases);
+
+
+    /**
+     * @brief Pauses / resumes the handing out of jobs.
+     *
+     * @param paused
+     */
+    void setPaused(bool paused);
+
+    // get functions
+    int numberOfWaitingJobs();
+    bool isPaused();
+
+};
+
+} // namespace ResOpt
+
+#endif // CASESCHEDULER_H
@@ -35,34 +35,21 @@ Component::Component()
 }
 
 Component::Component(const Component &c)
+    : m_streams(c.m_streams)
 {
     // the id
     m_id = c.m_id;
-
-    // the streams
-    for(int i = 0; i < m_streams.size(); ++i) delete m_streams.at(i);
-    m_streams.clear();
-    m_streams.resize(c.m_streams.size());
-
-    for(int i = 0; i < c.numberOfStreams(); i++)
-    {
-        m_streams.replace(i, new Stream(*c.m_streams.at(i)));
-    }
-
-
-
 }
 
 Component::~Component()
 {
-    for(int i = 0; i < numberOfStreams(); ++i) delete m_streams.at(i);
 }
 
 
 //-----------------------------------------------------------------------------------------------
 // sets the Stream for interval i
 //-----------------------------------------------------------------------------------------------
-bool Component::setStream(int i, Stream *s)
+bool Component::setStream(int i, const Stream &s)
 {
 
     // first checking that the stream vector is set up correctly
@@ -75,8 +62,7 @@ bool Component::setStream(int i, Stream *s)
     //if(s->time() != m_schedule.at(i)->endTime()) return false;
 
     // everything seems to be ok, setting the stream
-    delete m_streams.at(i);
-    m_streams.replace(i, s);
+    *m_streams.at(i) = s;
 
 
     return true;
@@ -25,11 +25,11 @@
 
 #include <QVector>
 
+#include "streamseries.h"
+
 namespace ResOpt
 {
 
-class Stream;
-
 /**
  * @brief Mother class of all components in the model (wells, pipes)
  * @details Every part of the Model that have streams of oil, gas, or water going through it should inheret from this class.
@@ -38,7 +38,7 @@ class Stream;
 class Component
 {
 private:
-    QVector<Stream*> m_streams;         // the streams going through the component
+    StreamSeries m_streams;             // the streams going through the component, one for each time step
 
     int m_id;                           // unique id number for the component
     static int next_id;
@@ -56,19 +56,32 @@ public:
     // misc functions
     void clearStreams() {m_streams.clear();}
 
-    // add functions
-    void addStream(Stream *s) {m_streams.push_back(s);}
+    /**
+     * @brief Sets up one empty stream for each of the times. The streams are updated in place after this.
+     *
+     * @param times
+     */
+    void setupStreams(const QVector<double> &times) {m_streams.setup(times);}
 
 
 
     // set functions
-    bool setStream(int i, Stream *s);
+
+    /**
+     * @brief Copies the values of s to Stream i.
+     *
+     * @param i
+     * @param s
+     * @return bool false if there is no Stream i
+     */
+    bool setStream(int i, const Stream &s);
 
 
     // get functions
     int numberOfStreams() const {return m_streams.size();}
     Stream* stream(int i) {return m_streams.at(i);}
-    QVector<Stream*> streams() {return m_streams;}
+    QVector<Stream*> streams() {return m_streams.pointers();}
+    StreamSeries& streamSeries() {return m_streams;}
 
     int id() {return m_id;}
 
@@ -35,6 +35,7 @@
 #include "wellpath.h"
 
 #include <iostream>
+#include <QSet>
 
 
 using std::cout;
@@ -93,6 +94,9 @@ void CoupledModel::initialize()
     // initializing the user defined constraints
     for(int i = 0; i < numberOfUserDefinedConstraints(); ++i) userDefinedConstraint(i)->initialize();
 
+    // the streams in the pipes have been set up again, all the wells must be propagated
+    m_well_streams.clear();
+
 }
 
 
@@ -129,40 +133,174 @@ void CoupledModel::updateStreams()
 {
     //cout << "Updating the streams for the pipe system..." << endl;
 
-    // first need to empty all the streams in all pipes
-    for(int i = 0; i < numberOfPipes(); ++i) pipe(i)->emptyStreams();
+    QSet<Pipe*> affected;   // the pipes that must be summed up again
 
-    // starting with the production wells, feeding the rates to the connected pipes
-    for(int i = 0; i < numberOfWells(); ++i)
+    // setting up the contributions from scratch the first time, or if the wells have changed
+    if(m_well_streams.size() != numberOfWells())
     {
-        // trying to cast to production well
-        ProductionWell *prod_well = dynamic_cast<ProductionWell*>(well(i));
+        m_well_streams.clear();
+        m_well_streams.resize(numberOfWells());
+
+        for(int i = 0; i < numberOfWells(); ++i) m_well_streams[i].well = dynamic_cast<ProductionWell*>(well(i));
+
+        for(int i = 0; i < numberOfPipes(); ++i) affected.insert(pipe(i));
+    }
+
+
+    // finding the production wells where the rates, routing or separator settings have changed
+    QVector<bool> changed(numberOfWells(), false);
+
+    for(int i = 0; i < m_well_streams.size(); ++i)
+    {
+        WellStreams &ws = m_well_streams[i];
+
+        if(ws.well == 0) continue;  // only production wells feed the pipe network
+
+        if(!ws.propagated || wellStreamInputs(ws) != ws.inputs)
+        {
+            changed.replace(i, true);
+            for(int j = 0; j < ws.pipes.size(); ++j) affected.insert(ws.pipes.at(j));
+        }
+    }
 
-        if(prod_well != 0)  // this is a production well
+    // the wells feeding an affected separator must also be propagated again, since they share the removal capacity
+    bool found_more = true;
+    while(found_more)
+    {
+        found_more = false;
+
+        for(int i = 0; i < m_well_streams.size(); ++i)
         {
-            // adding the streams from this well to the upstream pipes connected to it
-            addStreamsUpstream(prod_well);
+            WellStreams &ws = m_well_streams[i];
+
+            if(changed.at(i) || ws.well == 0) continue;
 
-            // looping through the outlet connections of the well, doing the same
-            for(int j = 0; j < prod_well->numberOfPipeConnections(); ++j)
+            for(int j = 0; j < ws.separators.size(); ++j)
             {
-                // checking if it is a midpipe, separator or booster
-                MidPipe *p_mid = dynamic_cast<MidPipe*>(prod_well->pipeConnection(j)->pipe());
-                Separator *p_sep = dynamic_cast<Separator*>(prod_well->pipeConnection(j)->pipe());
-                PressureBooster *p_boost = dynamic_cast<PressureBooster*>(prod_well->pipeConnection(j)->pipe());
+                if(affected.contains(ws.separators.at(j)))
+                {
+                    changed.replace(i, true);
+                    for(int k = 0; k < ws.pipes.size(); ++k) affected.insert(ws.pipes.at(k));
+
+                    found_more = true;
+                    break;
+                }
+            }
+        }
+    }
 
-                if(p_mid != 0) addStreamsUpstream(p_mid, prod_well, prod_well->pipeConnection(j)->variable()->value());
-                else if(p_sep != 0) addStreamsUpstream(p_sep, prod_well, prod_well->pipeConnection(j)->variable()->value());
-                else if(p_boost != 0) addStreamsUpstream(p_boost, prod_well, prod_well->pipeConnection(j)->variable()->value());
 
+    // emptying the affected pipes (this also resets the remaining capacity of the separators)
+    for(QSet<Pipe*>::const_iterator it = affected.constBegin(); it != affected.constEnd(); ++it) (*it)->emptyStreams();
 
-            } // pipe connection
-        } // production well
-    } // well
 
+    // propagating the changed wells through the network
+    for(int i = 0; i < m_well_streams.size(); ++i)
+    {
+        if(!changed.at(i)) continue;
+
+        WellStreams &ws = m_well_streams[i];
+        propagateWellStreams(ws);
+
+        for(int j = 0; j < ws.pipes.size(); ++j) affected.insert(ws.pipes.at(j));
+    }
+
+
+    // summing up the contributions to the affected pipes, in the same order as they were calculated
+    for(int i = 0; i < m_well_streams.size(); ++i)
+    {
+        WellStreams &ws = m_well_streams[i];
+
+        for(int j = 0; j < ws.pipes.size(); ++j)
+        {
+            Pipe *p = ws.pipes.at(j);
+
+            if(!affected.contains(p)) continue;
+
+            int end = (j + 1 < ws.first.size()) ? ws.first.at(j + 1) : ws.streams.size();
+
+            for(int k = ws.first.at(j); k < end; ++k) p->addToStream(k - ws.first.at(j), ws.streams.at(k));
+        }
+    }
+
+
+    // the pressures of the unaffected pipes are reset, as they would have been by a full update
+    for(int i = 0; i < numberOfPipes(); ++i)
+    {
+        if(affected.contains(pipe(i))) continue;
+
+        for(int j = 0; j < pipe(i)->numberOfStreams(); ++j) pipe(i)->stream(j)->setPressure(0);
+    }
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// collects the values the contributions from a well depend on
+//-----------------------------------------------------------------------------------------------
+QVector<double> CoupledModel::wellStreamInputs(WellStreams &ws)
+{
+    ProductionWell *w = ws.well;
+
+    QVector<double> inputs;
+    inputs.reserve(5*w->numberOfStreams() + ws.routing.size() + 3*ws.separators.size());
+
+    // the rates from the well
+    for(int i = 0; i < w->numberOfStreams(); ++i)
+    {
+        Stream *s = w->stream(i);
+
+        inputs.push_back(s->time());
+        inputs.push_back(s->oilRate(true));
+        inputs.push_back(s->gasRate(true));
+        inputs.push_back(s->waterRate(true));
+        inputs.push_back(s->inputUnits());
+    }
+
+    // the routing fractions
+    for(int i = 0; i < ws.routing.size(); ++i) inputs.push_back(ws.routing.at(i)->value());
+
+    // the separator settings
+    for(int i = 0; i < ws.separators.size(); ++i)
+    {
+        Separator *s = ws.separators.at(i);
+
+        inputs.push_back(s->removeFraction()->value());
+        inputs.push_back(s->removeCapacity()->value());
+        inputs.push_back(s->installTime()->value());
+    }
+
+    return inputs;
+}
+
+//-----------------------------------------------------------------------------------------------
+// calculates the contributions from a well to all the pipes it feeds
+//-----------------------------------------------------------------------------------------------
+void CoupledModel::propagateWellStreams(WellStreams &ws)
+{
+    ProductionWell *prod_well = ws.well;
+
+    // resize(0) keeps the allocated capacity for the next propagation
+    ws.routing.resize(0);
+    ws.separators.resize(0);
+    ws.pipes.resize(0);
+    ws.first.resize(0);
+    ws.streams.resize(0);
+
+    // adding the streams from this well to the upstream pipes connected to it
+    addStreamsUpstream(prod_well, ws);
+
+    // looping through the outlet connections of the well, doing the same
+    for(int j = 0; j < prod_well->numberOfPipeConnections(); ++j)
+    {
+        addStreamsUpstream(prod_well->pipeConnection(j)->pipe(), prod_well, prod_well->pipeConnection(j)->variable()->value(), ws);
+
+    } // pipe connection
+
+    // storing the values the contributions were calculated from
+    ws.inputs = wellStreamInputs(ws);
+    ws.propagated = true;
+}
+
 //-----------------------------------------------------------------------------------------------
 // updates the value of the constraints
 //-----------------------------------------------------------------------------------------------
@@ -178,7 +316,7 @@ bool CoupledModel::updateConstraints()
 //-----------------------------------------------------------------------------------------------
 // adds the rates from the well to the direct upstream connections
 //-----------------------------------------------------------------------------------------------
-void CoupledModel::addStreamsUpstream(ProductionWell *w)
+void CoupledModel::addStreamsUpstream(ProductionWell *w, WellStreams &ws)
 {
 
     // looping through the pipes connected to the well
@@ -189,15 +327,15 @@ void CoupledModel::addStreamsUpstream(ProductionWell *w)
 
 
         // finding the flow fraction from this well to the pipe
+        ws.routing.push_back(w->pipeConnection(i)->variable());
         double frac = w->pipeConnection(i)->variable()->value();
 
         // calculating the rate from this well to the pipe vs. time
+        addContribution(ws, p);
         for(int j = 0; j < w->numberOfStreams(); ++j)
         {
-            Stream s = *w->stream(j) * frac;
-
-            // adding the rate contribution from this well to what is allready going through the pipe
-            p->addToStream(j, s);
+            // the rate contribution from this well to what is allready going through the pipe
+            ws.streams.push_back(*w->stream(j) * frac);
 
         }
 
@@ -205,10 +343,34 @@ void CoupledModel::addStreamsUpstream(ProductionWell *w)
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// adds the rates from the pipe to all upstream connections, depending on the type of pipe
+//-----------------------------------------------------------------------------------------------
+void CoupledModel::addStreamsUpstream(Pipe *p, Well *from_well, double flow_frac, WellStreams &ws)
+{
+    // finding the type of pipe from the compiled pipe network
+    const PipeNode &node = pipeNode(pipeNodeIndex(p));
+
+    switch(node.type)
+    {
+    case PipeNode::MIDPIPE:
+        addStreamsUpstream(static_cast<MidPipe*>(p), from_well, flow_frac, ws);
+        break;
+    case PipeNode::SEPARATOR:
+        addStreamsUpstream(static_cast<Separator*>(p), from_well, flow_frac, ws);
+        break;
+    case PipeNode::BOOSTER:
+        addStreamsUpstream(static_cast<PressureBooster*>(p), from_well, flow_frac, ws);
+        break;
+    default:    // end pipes do not flow into any other pipes
+        break;
+    }
+}
+
 //-----------------------------------------------------------------------------------------------
 // adds the rates from the pipe to all upstream connections
 //-----------------------------------------------------------------------------------------------
-void CoupledModel::addStreamsUpstream(MidPipe *p, Well *from_well, double flow_frac)
+void CoupledModel::addStreamsUpstream(MidPipe *p, Well *from_well, double flow_frac, WellStreams &ws)
 {
     // looping through the pipes connected to the pipe
     for(int i = 0; i < p->numberOfOutletConnections(); ++i)
@@ -217,30 +379,23 @@ void CoupledModel::addStreamsUpstream(MidPipe *p, Well *from_well, double flow_f
 
 
         // finding the flow fraction from this pipe to the upstream pipe
+        ws.routing.push_back(p->outletConnection(i)->variable());
         double frac = p->outletConnection(i)->variable()->value();
 
         double total_frac = frac*flow_frac;
 
 
         // looping through the streams, adding the rate from this pipe
+        addContribution(ws, upstream);
         for(int j = 0; j < p->numberOfStreams(); ++j)
         {
-            Stream s = *from_well->stream(j) * total_frac;
-
-
-            // adding the contribution to the upstream pipe
-            upstream->addToStream(j, s);
+            // the contribution to the upstream pipe
+            ws.streams.push_back(*from_well->stream(j) * total_frac);
 
         }
 
-        // then checking if the outlet pipe connection is a midpipe or separator
-        MidPipe *p_mid = dynamic_cast<MidPipe*>(upstream);
-        Separator *p_sep = dynamic_cast<Separator*>(upstream);
-        PressureBooster *p_boost = dynamic_cast<PressureBooster*>(upstream);
-
-        if(p_mid != 0) addStreamsUpstream(p_mid, from_well, total_frac);
-        else if(p_sep != 0) addStreamsUpstream(p_sep, from_well, total_frac);
-        else if(p_boost != 0) addStreamsUpstream(p_boost, from_well, total_frac);
+        // continuing with the pipes the upstream pipe flows into
+        addStreamsUpstream(upstream, from_well, total_frac, ws);
 
     }
 }
@@ -249,12 +404,15 @@ void CoupledModel::addStreamsUpstream(MidPipe *p, Well *from_well, double flow_f
 //-----------------------------------------------------------------------------------------------
 // adds the rates from the separator to all upstream connections
 //-----------------------------------------------------------------------------------------------
-void CoupledModel::addStreamsUpstream(Separator *s, Well *from_well, double flow_frac)
+void CoupledModel::addStreamsUpstream(Separator *s, Well *from_well, double flow_frac, WellStreams &ws)
 {
     // pointer to the upstream connected pipe
     Pipe *upstream = s->outletConnection()->pipe();
 
+    ws.separators.push_back(s);
+
     // looping through the streams, adding the contribution from the separator
+    addContribution(ws, upstream);
     for(int i = 0; i < s->numberOfStreams(); ++i)
     {
         Stream str = *from_well->stream(i) * flow_frac;
@@ -293,17 +451,11 @@ void CoupledModel::addStreamsUpstream(Separator *s, Well *from_well, double flow
         }
 
         // adding the stream to the upstream pipe
-        upstream->addToStream(i, str);
+        ws.streams.push_back(str);
     }
 
-    // then checking if the upstream pipe is a midpipe or separator
-    MidPipe *p_mid = dynamic_cast<MidPipe*>(upstream);
-    Separator *p_sep = dynamic_cast<Separator*>(upstream);
-    PressureBooster *p_boost = dynamic_cast<PressureBooster*>(upstream);
-
-    if(p_mid != 0) addStreamsUpstream(p_mid, from_well, flow_frac);
-    else if(p_sep != 0) addStreamsUpstream(p_sep, from_well, flow_frac);
-    else if(p_boost != 0) addStreamsUpstream(p_boost, from_well, flow_frac);
+    // continuing with the pipes the upstream pipe flows into
+    addStreamsUpstream(upstream, from_well, flow_frac, ws);
 
 }
 
@@ -311,28 +463,21 @@ void CoupledModel::addStreamsUpstream(Separator *s, Well *from_well, double flow
 //-----------------------------------------------------------------------------------------------
 // adds the rates from the booster to all upstream connections
 //-----------------------------------------------------------------------------------------------
-void CoupledModel::addStreamsUpstream(PressureBooster *b, Well *from_well, double flow_frac)
+void CoupledModel::addStreamsUpstream(PressureBooster *b, Well *from_well, double flow_frac, WellStreams &ws)
 {
     // pointer to the upstream connected pipe
     Pipe *upstream = b->outletConnection()->pipe();
 
     // looping through the streams, adding the contribution from the separator
+    addContribution(ws, upstream);
     for(int i = 0; i < b->numberOfStreams(); ++i)
     {
-        Stream str = *from_well->stream(i) * flow_frac;
-
         // adding the stream to the upstream pipe
-        upstream->addToStream(i, str);
+        ws.streams.push_back(*from_well->stream(i) * flow_frac);
     }
 
-    // then checking if the upstream pipe is a midpipe, separator, or booster
-    MidPipe *p_mid = dynamic_cast<MidPipe*>(upstream);
-    Separator *p_sep = dynamic_cast<Separator*>(upstream);
-    PressureBooster *p_boost = dynamic_cast<PressureBooster*>(upstream);
-
-    if(p_mid != 0) addStreamsUpstream(p_mid, from_well, flow_frac);
-    else if(p_sep != 0) addStreamsUpstream(p_sep, from_well, flow_frac);
-    else if(p_boost != 0) addStreamsUpstream(p_boost, from_well, flow_frac);
+    // continuing with the pipes the upstream pipe flows into
+    addStreamsUpstream(upstream, from_well, flow_frac, ws);
 
 }
 
@@ -399,6 +544,9 @@ QVector<shared_ptr<RealVariable> >& CoupledModel::realVariables(bool force_refre
     {
         if(force_refresh) m_vars_real.resize(0);
 
+        // the variables are collected again, the registry must be rebuilt
+        invalidateVariableRegistry();
+
         for(int i = 0; i < numberOfWells(); ++i)     // looping through all the wells
         {
             Well *w = well(i);
@@ -595,18 +743,7 @@ QVector<shared_ptr<Constraint> >& CoupledModel::constraints(bool force_refresh)
 //-----------------------------------------------------------------------------------------------
 QVector<shared_ptr<RealVariable> > CoupledModel::realVariables(Component *c)
 {
-    QVector<shared_ptr<RealVariable> > comp_vars;
-
-    // looping through all the real variables
-    for(int i = 0; i < realVariables().size(); ++i)
-    {
-        if(realVariables().at(i)->parent()->id() == c->id())
-        {
-            comp_vars.push_back(realVariables().at(i));
-        }
-    }
-
-    return comp_vars;
+    return registeredRealVariables(c);
 }
 
 
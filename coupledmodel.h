@@ -28,6 +28,9 @@
 #include "binaryvariable.h"
 #include "intvariable.h"
 #include "constraint.h"
+#include "stream.h"
+
+#include <QVector>
 
 namespace ResOpt
 {
@@ -35,6 +38,7 @@ class ProductionWell;
 class MidPipe;
 class Separator;
 class PressureBooster;
+class Pipe;
 
 
 /**
@@ -52,19 +56,72 @@ private:
     QVector<shared_ptr<IntVariable> > m_vars_integer;       // vector containing all integer variables
     QVector<shared_ptr<Constraint> > m_cons;                // vector containing all the constraints
 
+    /**
+     * @brief The contributions from one production well to the streams in the pipe network.
+     * @details The contributions are kept between calls to updateStreams(), together with the values they were calculated from (the well
+     *          rates, and the routing fractions and separator settings along the paths from the well). Only the wells where any of these
+     *          values have changed are propagated through the network again.
+     */
+    struct WellStreams
+    {
+        ProductionWell *well;                           // 0 for injection wells
+        bool propagated;                                // false until the well has been propagated the first time
+        QVector<double> inputs;                         // the values the contributions were calculated from
+        QVector<shared_ptr<BinaryVariable> > routing;   // the routing variables along the paths from the well
+        QVector<Separator*> separators;                 // the separators along the paths from the well
+        QVector<Pipe*> pipes;                           // the pipes fed by the well, in the order the contributions are added
+        QVector<int> first;                             // index in streams of the first time step for each entry in pipes
+        QVector<Stream> streams;                        // the contributions to the pipes
+
+        WellStreams() : well(0), propagated(false) {}
+    };
+
+    QVector<WellStreams> m_well_streams;
+
+
+    /**
+     * @brief Collects the values the contributions from a well depend on.
+     *
+     * @param ws
+     * @return QVector<double>
+     */
+    QVector<double> wellStreamInputs(WellStreams &ws);
+
+    /**
+     * @brief Calculates the contributions from a well to all the pipes it feeds.
+     *
+     * @param ws
+     */
+    void propagateWellStreams(WellStreams &ws);
+
+    /**
+     * @brief Starts a new contribution from the well to the pipe p.
+     *
+     */
+    void addContribution(WellStreams &ws, Pipe *p) {ws.pipes.push_back(p); ws.first.push_back(ws.streams.size());}
+
     /**
     * @brief Adds the streams flowing from this well to the upstream connected pipes
     *
     * @param w
     */
-    void addStreamsUpstream(ProductionWell *w);
+    void addStreamsUpstream(ProductionWell *w, WellStreams &ws);
+
+    /**
+     * @brief Adds the streams flowing from the pipe p to the upstream connected pipes.
+     * @details The type of p is found from the compiled pipe network, and the call is passed on to the function for that type.
+     *          Nothing is added for end pipes.
+     *
+     * @param p
+     */
+    void addStreamsUpstream(Pipe *p, Well *from_well, double flow_frac, WellStreams &ws);
 
     /**
     * @brief Adds the streams flowing from this pipe to the upstream connected pipes (or separators)
     *
     * @param p
      */
-    void addStreamsUpstream(MidPipe *p, Well *from_well, double flow_frac);
+    void addStreamsUpstream(MidPipe *p, Well *from_well, double flow_frac, WellStreams &ws);
 
 
     /**
@@ -72,14 +129,14 @@ private:
      *
      * @param s
      */
-    void addStreamsUpstream(Separator *s, Well *from_well, double flow_frac);
+    void addStreamsUpstream(Separator *s, Well *from_well, double flow_frac, WellStreams &ws);
 
     /**
      * @brief Adds the streams flowing from this booster to the upstream connected pipe
      *
      * @param b
      */
-    void addStreamsUpstream(PressureBooster *b, Well *from_well, double flow_frac);
+    void addStreamsUpstream(PressureBooster *b, Well *from_well, double flow_frac, WellStreams &ws);
 
 
 
@@ -97,6 +154,13 @@ public:
     virtual void initialize();
     virtual void process();
 
+    /**
+     * @brief Updates the streams flowing through the pipe network.
+     * @details Only the wells where the rates, routing or separator settings have changed since the last call are propagated. The pipes
+     *          they feed are then summed up again from the stored contributions, in the same order as a full update. If a changed well
+     *          feeds a separator, all the wells feeding the separator are propagated again, since they share the removal capacity.
+     *
+     */
     virtual void updateStreams();
     virtual bool updateConstraints();
 
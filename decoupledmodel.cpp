@@ -224,16 +224,17 @@ MaterialBalanceConstraint* DecoupledModel::find(Stream *s)
 {
     MaterialBalanceConstraint *mbc = 0;
 
-    for(int i = 0; i < m_mb_cons.size(); ++i)
-    {
+    int i = m_mb_con_index.value(s, -1);
 
-        if(s == m_mb_cons.at(i)->inputRateVariable()->stream())
-        {
-            mbc = m_mb_cons.at(i);
-            break;
-        }
+    // the index is out of date, rebuilding it
+    if(i < 0 || i >= m_mb_cons.size() || m_mb_cons.at(i)->inputRateVariable()->stream() != s)
+    {
+        buildMaterialBalanceIndex();
+        i = m_mb_con_index.value(s, -1);
     }
 
+    if(i >= 0) mbc = m_mb_cons.at(i);
+
     if(mbc == 0)
     {
         cout << "find mbc error!" << endl;
@@ -243,6 +244,20 @@ MaterialBalanceConstraint* DecoupledModel::find(Stream *s)
     return mbc;
 }
 
+//-----------------------------------------------------------------------------------------------
+// indexes the material balance constraints by the stream of the input rate variable
+//-----------------------------------------------------------------------------------------------
+void DecoupledModel::buildMaterialBalanceIndex()
+{
+    m_mb_con_index.clear();
+
+    // going backwards, so that the first constraint wins if a stream is used more than once
+    for(int i = m_mb_cons.size() - 1; i >= 0; --i)
+    {
+        m_mb_con_index.insert(m_mb_cons.at(i)->inputRateVariable()->stream(), i);
+    }
+}
+
 //-----------------------------------------------------------------------------------------------
 // updates the streams in the material balance constraints
 //-----------------------------------------------------------------------------------------------
@@ -471,6 +486,9 @@ QVector<shared_ptr<RealVariable> >& DecoupledModel::realVariables(bool force_ref
     {
         if(force_refresh) m_vars_real.resize(0);
 
+        // the variables are collected again, the registry must be rebuilt
+        invalidateVariableRegistry();
+
         // getting the control variables for the wells
         for(int i = 0; i < numberOfWells(); ++i)     // looping through all the wells
         {
@@ -647,18 +665,7 @@ QVector<shared_ptr<Constraint> >& DecoupledModel::constraints(bool force_refresh
 //-----------------------------------------------------------------------------------------------
 QVector<shared_ptr<RealVariable> > DecoupledModel::realVariables(Component *c)
 {
-    QVector<shared_ptr<RealVariable> > comp_vars;
-
-    // looping through all the real variables
-    for(int i = 0; i < realVariables().size(); ++i)
-    {
-        if(realVariables().at(i)->parent()->id() == c->id())
-        {
-            comp_vars.push_back(realVariables().at(i));
-        }
-    }
-
-    return comp_vars;
+    return registeredRealVariables(c);
 }
 
 
@@ -57,6 +57,7 @@ private:
 
     QVector<InputRateVariable*> m_rate_vars;            // all the varaibles for rate input to the different parts of the model
     QVector<MaterialBalanceConstraint*> m_mb_cons;      // constraints associated with the input rate variables for mass balance feasibility
+    QHash<const Stream*, int> m_mb_con_index;           // index in m_mb_cons for the stream of each input rate variable, used by find()
 
     void initializeVarsAndCons();
 
@@ -89,8 +90,18 @@ private:
      */
     void updateMaterialBalanceStreams();
 
+    /**
+     * @brief Returns the material balance constraint for the input rate variable connected to the stream.
+     * @details The constraint is looked up in an index of the streams. Streams may be replaced in the pipes, so the index is rebuilt if
+     *          the stream is not found, or no longer belongs to the constraint.
+     *
+     * @param s
+     * @return MaterialBalanceConstraint
+     */
     MaterialBalanceConstraint* find(Stream *s);
 
+    void buildMaterialBalanceIndex();
+
 
 public:
     DecoupledModel();
@@ -35,17 +35,27 @@ Derivative::Derivative(int con_id) :
 {
 }
 
+//-----------------------------------------------------------------------------------------------
+// adds a partial derivative
+//-----------------------------------------------------------------------------------------------
+void Derivative::addPartial(int var_id, double value)
+{
+    // only the first partial for a variable is found by valueById()
+    if(!m_partial_index.contains(var_id)) m_partial_index.insert(var_id, m_partial_derivatives.size());
+
+    m_partial_derivatives.push_back(QPair<int, double>(var_id, value));
+}
+
 //-----------------------------------------------------------------------------------------------
 // returns the value of the partial derivative for variable with id = var_id
 //-----------------------------------------------------------------------------------------------
 double Derivative::valueById(int var_id)
 {
-    for(int i = 0; i < m_partial_derivatives.size(); ++i)
-    {
-        if(m_partial_derivatives.at(i).first == var_id) return m_partial_derivatives.at(i).second;
-    }
+    QHash<int, int>::const_iterator it = m_partial_index.constFind(var_id);
+
+    if(it == m_partial_index.constEnd()) return 0;
 
-    return 0;
+    return m_partial_derivatives.at(it.value()).second;
 
 }
 
@@ -24,6 +24,7 @@
 
 #include <QPair>
 #include <QVector>
+#include <QHash>
 
 namespace ResOpt
 {
@@ -33,6 +34,7 @@ class Derivative
 private:
     int m_constraint_id;
     QVector<QPair<int, double> > m_partial_derivatives;
+    QHash<int, int> m_partial_index;        // index in m_partial_derivatives for each variable id
 
 public:
     Derivative();
@@ -40,7 +42,7 @@ public:
 
 
     // add functions
-    void addPartial(int var_id, double value) {m_partial_derivatives.push_back(QPair<int, double>(var_id, value));}
+    void addPartial(int var_id, double value);
 
     // get functions
     int constraintId() {return m_constraint_id;}
@@ -55,6 +57,7 @@ public:
      */
     double valueById(int var_id);
     double value(int i) {return m_partial_derivatives.at(i).second;}
+    int variableId(int i) {return m_partial_derivatives.at(i).first;}
 
 
 };
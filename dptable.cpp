@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include <QtAlgorithms>
+
 using std::cout;
 using std::endl;
 
@@ -9,6 +11,13 @@ namespace ResOpt
 {
 
 DpTable::DpTable()
+    : p_entries_gas(0),
+      p_entries_oil(0),
+      p_entries_wat(0),
+      m_n_gas(0),
+      m_n_oil(0),
+      m_n_wat(0),
+      p_grid(0)
 {
 }
 
@@ -21,117 +30,107 @@ void DpTable::addRow(double dp, double gas, double oil, double water)
     m_gas.push_back(gas);
     m_oil.push_back(oil);
     m_wat.push_back(water);
+
+    // the table must be compiled again
+    p_table_file.reset();
+    m_n_gas = 0;
 }
 
 
 //-----------------------------------------------------------------------------------------------
-// finds the uniquie entries for the gas, oil, and water
+// finds the uniquie entries for the gas, oil, and water, and builds the grid
 //-----------------------------------------------------------------------------------------------
-void DpTable::process()
+TableFile::TableData DpTable::compile() const
 {
+    QList<double> entries_gas;
+    QList<double> entries_oil;
+    QList<double> entries_wat;
+
     for(int i = 0; i < numberOfRows(); ++i)
     {
         // the gas
-        if(!m_entries_gas.contains(m_gas.at(i))) m_entries_gas.push_back(m_gas.at(i));
+        if(!entries_gas.contains(m_gas.at(i))) entries_gas.push_back(m_gas.at(i));
 
         // the oil
-        if(!m_entries_oil.contains(m_oil.at(i))) m_entries_oil.push_back(m_oil.at(i));
+        if(!entries_oil.contains(m_oil.at(i))) entries_oil.push_back(m_oil.at(i));
 
         // the water
-        if(!m_entries_wat.contains(m_wat.at(i))) m_entries_wat.push_back(m_wat.at(i));
+        if(!entries_wat.contains(m_wat.at(i))) entries_wat.push_back(m_wat.at(i));
 
     }
 
     // sorting the entries
-    qSort(m_entries_gas.begin(), m_entries_gas.end());
-    qSort(m_entries_oil.begin(), m_entries_oil.end());
-    qSort(m_entries_wat.begin(), m_entries_wat.end());
+    qSort(entries_gas.begin(), entries_gas.end());
+    qSort(entries_oil.begin(), entries_oil.end());
+    qSort(entries_wat.begin(), entries_wat.end());
 
-}
 
+    // building the grid, points that are missing from the table get the pressure drop of the first row
+    QVector<double> grid(entries_gas.size() * entries_oil.size() * entries_wat.size(), m_dp.at(0));
 
-//-----------------------------------------------------------------------------------------------
-// finds the index for the upper gas, oil, and water in the entries lists
-//-----------------------------------------------------------------------------------------------
-QList<int> DpTable::findUpperEntries(double gas, double oil, double water)
-{
-
-    int i_g = 0;
-    int i_o = 0;
-    int i_w = 0;
-
-    QList<int> indexes;
-
-
-    // finding the entry index for gas
-    for(int i = 0; i < m_entries_gas.size(); ++i)
+    // going backwards, so that the first row wins if a point is listed more than once
+    for(int i = numberOfRows() - 1; i >= 0; --i)
     {
-        if(m_entries_gas.at(i) > gas)
-        {
-            i_g = i;
-            break;
-        }
-    }
+        int i_g = qLowerBound(entries_gas.begin(), entries_gas.end(), m_gas.at(i)) - entries_gas.begin();
+        int i_o = qLowerBound(entries_oil.begin(), entries_oil.end(), m_oil.at(i)) - entries_oil.begin();
+        int i_w = qLowerBound(entries_wat.begin(), entries_wat.end(), m_wat.at(i)) - entries_wat.begin();
 
-    // finding the entry index for oil
-    for(int i = 0; i < m_entries_oil.size(); ++i)
-    {
-        if(m_entries_oil.at(i) > oil)
-        {
-            i_o = i;
-            break;
-        }
+        grid[(i_g * entries_oil.size() + i_o) * entries_wat.size() + i_w] = m_dp.at(i);
     }
 
-    // finding the entry index for water
-    for(int i = 0; i < m_entries_wat.size(); ++i)
-    {
-        if(m_entries_wat.at(i) > water)
-        {
-            i_w = i;
-            break;
-        }
-    }
+    TableFile::TableData data;
+    data.name = "DP";
+    data.axes << entries_gas.toVector() << entries_oil.toVector() << entries_wat.toVector();
+    data.grids << grid;
 
-    // populating the list
-    indexes << i_g << i_o << i_w;
+    return data;
+}
 
-    return indexes;
+//-----------------------------------------------------------------------------------------------
+// compiles the table in memory if it does not have a compiled table
+//-----------------------------------------------------------------------------------------------
+void DpTable::ensureCompiled()
+{
+    if(p_table_file == 0 && numberOfRows() > 0) setTableFile(TableFile::fromMemory(QList<TableFile::TableData>() << compile()), 0);
+}
 
+//-----------------------------------------------------------------------------------------------
+// sets the compiled table to use for the interpolation
+//-----------------------------------------------------------------------------------------------
+void DpTable::setTableFile(shared_ptr<TableFile> table_file, int table)
+{
+    p_table_file = table_file;
+
+    m_n_gas = p_table_file->axisSize(table, 0);
+    m_n_oil = p_table_file->axisSize(table, 1);
+    m_n_wat = p_table_file->axisSize(table, 2);
+    p_entries_gas = p_table_file->axis(table, 0);
+    p_entries_oil = p_table_file->axis(table, 1);
+    p_entries_wat = p_table_file->axis(table, 2);
+
+    p_grid = p_table_file->grid(table, 0);
+
+    // the rows are not needed anymore
+    m_gas.clear();
+    m_oil.clear();
+    m_wat.clear();
+    m_dp.clear();
 }
 
+
 //-----------------------------------------------------------------------------------------------
-// finds the index in the main table that corresponds to the entries in the entries table
+// finds the index of the upper bounding point in the entries list
 //-----------------------------------------------------------------------------------------------
-int DpTable::findTableIndex(int gas_entry, int oil_entry, int water_entry)
+int DpTable::findUpperEntry(const double *entries, int n, double value) const
 {
-    int index = 0;
+    if(n < 2) return 0;
 
-    double gas = m_entries_gas.at(gas_entry);
-    double oil = m_entries_oil.at(oil_entry);
-    double water = m_entries_wat.at(water_entry);
+    int i = qUpperBound(entries, entries + n, value) - entries;
 
+    // the value is at the upper end of the table
+    if(i == n) i = n - 1;
 
-    for(int i = 0; i < m_gas.size(); ++i)
-    {
-        // first checknig the gas rate
-        if(m_gas.at(i) == gas)
-        {
-            // then checking the oil rate
-            if(m_oil.at(i) == oil)
-            {
-
-                // then checking the water rate
-                if(m_wat.at(i) == water)
-                {
-                    index = i;
-                    break;
-                } // water
-            } // oil
-        } // gas
-    } // for loop
-
-    return index;
+    return i;
 }
 
 
@@ -142,43 +141,43 @@ double DpTable::interpolate(double gas, double oil, double water)
 {
 
 
-    // processing the table if not already done
-    if(m_entries_gas.size() == 0) process();
+    // compiling the table if not already done
+    ensureCompiled();
 
 
     // checking that the desired point lies within the table
-    if(gas < m_entries_gas.at(0) || gas > m_entries_gas.at(m_entries_gas.size() - 1))
+    if(gas < p_entries_gas[0] || gas > p_entries_gas[m_n_gas - 1])
     {
         cout << endl << "### Runtime Error ###" << endl
              << "The specified gas rate falls outside the range of the DP table..." << endl
              << "QG    : " << gas << endl
-             << "QG_MAX: " << m_entries_gas.at(m_entries_gas.size() - 1) << endl
-             << "QG_MIN: " << m_entries_gas.at(0) << endl;
+             << "QG_MAX: " << p_entries_gas[m_n_gas - 1] << endl
+             << "QG_MIN: " << p_entries_gas[0] << endl;
 
         return 1000;
 
 
 
     }
-    if(oil < m_entries_oil.at(0) || oil > m_entries_oil.at(m_entries_oil.size() - 1))
+    if(oil < p_entries_oil[0] || oil > p_entries_oil[m_n_oil - 1])
     {
         cout << endl << "### Runtime Error ###" << endl
              << "The specified oil rate falls outside the range of the DP table..." << endl
              << "QO    : " << oil << endl
-             << "QO_MAX: " << m_entries_oil.at(m_entries_oil.size() - 1) << endl
-             << "QO_MIN: " << m_entries_oil.at(0) << endl;
+             << "QO_MAX: " << p_entries_oil[m_n_oil - 1] << endl
+             << "QO_MIN: " << p_entries_oil[0] << endl;
 
         return 1000;
 
 
     }
-    if(water < m_entries_wat.at(0) || water > m_entries_wat.at(m_entries_wat.size() - 1))
+    if(water < p_entries_wat[0] || water > p_entries_wat[m_n_wat - 1])
     {
         cout << endl << "### Runtime Error ###" << endl
              << "The specified water rate falls outside the range of the DP table..." << endl
              << "QW    : " << water << endl
-             << "QW_MAX: " << m_entries_wat.at(m_entries_wat.size() - 1) << endl
-             << "QW_MIN: " << m_entries_wat.at(0) << endl;
+             << "QW_MAX: " << p_entries_wat[m_n_wat - 1] << endl
+             << "QW_MIN: " << p_entries_wat[0] << endl;
 
         return 1000;
 
@@ -189,30 +188,37 @@ double DpTable::interpolate(double gas, double oil, double water)
 
 
     // getting the upper points
-    QList<int> i_upper = findUpperEntries(gas, oil, water);
+    int i_g = findUpperEntry(p_entries_gas, m_n_gas, gas);
+    int i_o = findUpperEntry(p_entries_oil, m_n_oil, oil);
+    int i_w = findUpperEntry(p_entries_wat, m_n_wat, water);
+
+    // the lower points, the same as the upper if there is only one entry
+    int l_g = (i_g > 0) ? i_g - 1 : 0;
+    int l_o = (i_o > 0) ? i_o - 1 : 0;
+    int l_w = (i_w > 0) ? i_w - 1 : 0;
 
     // calculating the difference to the lower bounding points
-    double xd = (gas - m_entries_gas.at(i_upper.at(0) - 1)) / (m_entries_gas.at(i_upper.at(0)) - m_entries_gas.at(i_upper.at(0) - 1));
-    double yd = (oil - m_entries_oil.at(i_upper.at(1) - 1)) / (m_entries_oil.at(i_upper.at(1)) - m_entries_oil.at(i_upper.at(1) - 1));
-    double zd = (water - m_entries_wat.at(i_upper.at(2) - 1)) / (m_entries_wat.at(i_upper.at(2)) - m_entries_wat.at(i_upper.at(2) - 1));
+    double xd = (i_g == l_g) ? 0 : (gas - p_entries_gas[l_g]) / (p_entries_gas[i_g] - p_entries_gas[l_g]);
+    double yd = (i_o == l_o) ? 0 : (oil - p_entries_oil[l_o]) / (p_entries_oil[i_o] - p_entries_oil[l_o]);
+    double zd = (i_w == l_w) ? 0 : (water - p_entries_wat[l_w]) / (p_entries_wat[i_w] - p_entries_wat[l_w]);
 
 
-    // getting the indexes for the eight bounding points
-    int i_000 = findTableIndex(i_upper.at(0) - 1, i_upper.at(1) - 1, i_upper.at(2) - 1);
-    int i_010 = findTableIndex(i_upper.at(0) - 1, i_upper.at(1)    , i_upper.at(2) - 1);
-    int i_001 = findTableIndex(i_upper.at(0) - 1, i_upper.at(1) - 1, i_upper.at(2)    );
-    int i_011 = findTableIndex(i_upper.at(0) - 1, i_upper.at(1)    , i_upper.at(2)    );
+    // getting the pressure drops at the eight bounding points
+    double dp_000 = p_grid[gridIndex(l_g, l_o, l_w)];
+    double dp_010 = p_grid[gridIndex(l_g, i_o, l_w)];
+    double dp_001 = p_grid[gridIndex(l_g, l_o, i_w)];
+    double dp_011 = p_grid[gridIndex(l_g, i_o, i_w)];
 
-    int i_100 = findTableIndex(i_upper.at(0)    , i_upper.at(1) - 1, i_upper.at(2) - 1);
-    int i_110 = findTableIndex(i_upper.at(0)    , i_upper.at(1)    , i_upper.at(2) - 1);
-    int i_101 = findTableIndex(i_upper.at(0)    , i_upper.at(1) - 1, i_upper.at(2)    );
-    int i_111 = findTableIndex(i_upper.at(0)    , i_upper.at(1)    , i_upper.at(2)    );
+    double dp_100 = p_grid[gridIndex(i_g, l_o, l_w)];
+    double dp_110 = p_grid[gridIndex(i_g, i_o, l_w)];
+    double dp_101 = p_grid[gridIndex(i_g, l_o, i_w)];
+    double dp_111 = p_grid[gridIndex(i_g, i_o, i_w)];
 
     //interpolating along x (gas)
-    double c_00 = m_dp.at(i_000) * (1 - xd) + m_dp.at(i_100) * xd;
-    double c_10 = m_dp.at(i_010) * (1 - xd) + m_dp.at(i_110) * xd;
-    double c_01 = m_dp.at(i_001) * (1 - xd) + m_dp.at(i_101) * xd;
-    double c_11 = m_dp.at(i_011) * (1 - xd) + m_dp.at(i_111) * xd;
+    double c_00 = dp_000 * (1 - xd) + dp_100 * xd;
+    double c_10 = dp_010 * (1 - xd) + dp_110 * xd;
+    double c_01 = dp_001 * (1 - xd) + dp_101 * xd;
+    double c_11 = dp_011 * (1 - xd) + dp_111 * xd;
 
     // interpolating along y (oil)
     double c_0 = c_00 * (1 - yd) + c_10 * yd;
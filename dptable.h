@@ -2,6 +2,12 @@
 #define DPTABLE_H
 
 #include <QList>
+#include <QVector>
+#include <tr1/memory>
+
+#include "tablefile.h"
+
+using std::tr1::shared_ptr;
 
 namespace ResOpt
 {
@@ -16,14 +22,19 @@ private:
 
     QList<double> m_dp;
 
-    QList<double> m_entries_gas;
-    QList<double> m_entries_oil;
-    QList<double> m_entries_wat;
+    shared_ptr<TableFile> p_table_file; // the compiled table, shared between all copies of the table
 
-    void process();
+    const double *p_entries_gas;        // the unique values for each rate, sorted
+    const double *p_entries_oil;
+    const double *p_entries_wat;
+    int m_n_gas;
+    int m_n_oil;
+    int m_n_wat;
 
-    QList<int> findUpperEntries(double gas, double oil, double water);
-    int findTableIndex(int gas_entry, int oil_entry, int water_entry);
+    const double *p_grid;               // dense (gas, oil, water) grid of pressure drops
+
+    int findUpperEntry(const double *entries, int n, double value) const;
+    int gridIndex(int gas_entry, int oil_entry, int water_entry) const {return (gas_entry * m_n_oil + oil_entry) * m_n_wat + water_entry;}
 
 
 public:
@@ -33,6 +44,28 @@ public:
 
     double interpolate(double gas, double oil, double water);
 
+    /**
+     * @brief Generates the unique entries for the rates, and the grid of pressure drops used by the interpolation, from the rows
+     * @details The table has three axes (gas, oil, water) and one grid (dp). Points that are missing from the table get the pressure drop of the first row.
+     *
+     * @return TableFile::TableData
+     */
+    TableFile::TableData compile() const;
+
+    /**
+     * @brief Compiles the rows to an in-memory table, unless the table already uses a compiled table.
+     *
+     */
+    void ensureCompiled();
+
+    /**
+     * @brief Makes the table use a compiled table from a TableFile. The rows are cleared.
+     *
+     * @param table_file
+     * @param table index of the table in the file
+     */
+    void setTableFile(shared_ptr<TableFile> table_file, int table);
+
     // add functions
     void addRow(double dp, double gas, double oil, double water);
 
@@ -6,19 +6,30 @@ namespace ResOpt
 {
 
 DpTableCalculator::DpTableCalculator()
-    : p_dp_table(0)
 {
 }
 
 DpTableCalculator::DpTableCalculator(const DpTableCalculator &c)
+    : PressureDropCalculator(c)
 {
-    // copying the dp table
-    p_dp_table = new DpTable(*c.p_dp_table);
+    // sharing the dp table, it is read only
+    p_dp_table = c.p_dp_table;
 }
 
 DpTableCalculator::~DpTableCalculator()
 {
-    if(p_dp_table != 0) delete p_dp_table;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// sets the dp table
+//-----------------------------------------------------------------------------------------------
+void DpTableCalculator::setDpTable(DpTable *table)
+{
+    // compiling the table now, so that it is not changed when it is shared between the launchers
+    table->ensureCompiled();
+
+    p_dp_table = shared_ptr<DpTable>(table);
 }
 
 
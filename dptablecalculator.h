@@ -3,6 +3,10 @@
 
 #include "pressuredropcalculator.h"
 
+#include <tr1/memory>
+
+using std::tr1::shared_ptr;
+
 namespace ResOpt
 {
 
@@ -12,7 +16,7 @@ class Stream;
 class DpTableCalculator : public PressureDropCalculator
 {
 private:
-    DpTable *p_dp_table;
+    shared_ptr<DpTable> p_dp_table;     // the table is compiled, and not changed after it is set, so it is shared by all copies of the calculator
 
 public:
     DpTableCalculator();
@@ -34,7 +38,13 @@ public:
     virtual double pressureDrop(Stream *s, double p_outlet, Stream::units unit);
 
     // set functions
-    void setDpTable(DpTable *table) {p_dp_table = table;}
+
+    /**
+     * @brief Sets the table used by the calculator. The calculator takes ownership of the table, and compiles it if needed.
+     *
+     * @param table
+     */
+    void setDpTable(DpTable *table);
 
 
 
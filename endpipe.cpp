@@ -55,22 +55,11 @@ EndPipe::~EndPipe()
 void EndPipe::calculateInletPressure()
 {
 
-    // looping through the time steps
-    for(int i = 0; i < numberOfStreams(); i++)
-    {
-        // checking that the outlet pressure unit matches the stream
-        double out_pres = outletPressure();
-        if(outletUnit() != stream(i)->inputUnits())
-        {
-            if(outletUnit() == Stream::METRIC) out_pres = outletPressure()*14.5037738;
-            else out_pres = outletPressure() / 14.5037738;
-        }
-
-        double dp = calculator()->pressureDrop(stream(i), outletPressure(), stream(i)->inputUnits());    // the pressure drop in the pipe
-
-        stream(i)->setPressure(dp + outletPressure());      // setting the inlet pressure for the time step
-    }
+    // the outlet pressure is the same for all the time steps, converted to field units once
+    m_p_out.fill(Stream::toFieldUnits<Units::Pressure>(outletPressure(), outletUnit()), numberOfStreams());
 
+    // calculating the pressure drops, and setting the inlet pressures for all the time steps
+    calculateInletPressures(m_p_out);
 
 }
 
@@ -44,6 +44,8 @@ private:
     double m_outletpressure;
     Stream::units m_outlet_unit;
 
+    QVector<double> m_p_out;    // outlet pressure for each time step (psia), used by calculateInletPressure()
+
 public:
     EndPipe();
     EndPipe(const EndPipe &p);
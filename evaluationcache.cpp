@@ -0,0 +1,418 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#include "evaluationcache.h"
+
+#include <iostream>
+#include <QFile>
+#include <QDataStream>
+#include <QVector>
+#include <QtAlgorithms>
+
+#include "case.h"
+#include "derivative.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// identifies the cache file format
+static const quint32 CACHE_MAGIC = 0x52534f43;
+static const qint32 CACHE_VERSION = 3;
+
+
+EvaluationCache::EvaluationCache()
+    : p_file(0),
+      m_hits(0)
+{
+}
+
+EvaluationCache::~EvaluationCache()
+{
+    if(p_file != 0)
+    {
+        p_file->close();
+        delete p_file;
+    }
+
+    qDeleteAll(m_cases);
+}
+
+//-----------------------------------------------------------------------------------------------
+// generates the lookup key for a case
+//-----------------------------------------------------------------------------------------------
+QByteArray EvaluationCache::key(Case *c)
+{
+    QByteArray k;
+    QDataStream out(&k, QIODevice::WriteOnly);
+
+    out << qint32(c->numberOfRealVariables());
+    for(int i = 0; i < c->numberOfRealVariables(); ++i) out << c->realVariableValue(i);
+
+    out << qint32(c->numberOfBinaryVariables());
+    for(int i = 0; i < c->numberOfBinaryVariables(); ++i) out << c->binaryVariableValue(i);
+
+    out << qint32(c->numberOfIntegerVariables());
+    for(int i = 0; i < c->numberOfIntegerVariables(); ++i) out << qint32(c->integerVariableValue(i));
+
+    return k;
+}
+
+//-----------------------------------------------------------------------------------------------
+// connects the cache to a file, reading entries from previous runs
+//-----------------------------------------------------------------------------------------------
+bool EvaluationCache::setFile(const QString &f, const QByteArray &fingerprint)
+{
+    m_fingerprint = fingerprint;
+
+    if(p_file != 0)
+    {
+        p_file->close();
+        delete p_file;
+    }
+
+    p_file = new QFile(f);
+
+    if(!p_file->open(QIODevice::ReadWrite))
+    {
+        qWarning("Could not connect to cache file: %s", p_file->fileName().toLatin1().constData());
+
+        delete p_file;
+        p_file = 0;
+
+        return false;
+    }
+
+    if(p_file->size() == 0) writeHeader();   // new file
+    else
+    {
+        int n = readFile();
+        cout << "Read " << n << " previously evaluated cases from the cache file..." << endl;
+    }
+
+    p_file->flush();
+
+    return p_file != 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+// reads the records in the cache file
+//-----------------------------------------------------------------------------------------------
+int EvaluationCache::readFile()
+{
+    QDataStream in(p_file);
+
+    quint32 magic;
+    qint32 version;
+    QByteArray fingerprint;
+    in >> magic >> version;
+
+    if(in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        qWarning("The cache file is not in the right format, starting from an empty cache: %s", p_file->fileName().toLatin1().constData());
+        writeHeader();
+        return 0;
+    }
+
+    // the cases are only valid for the problem they were evaluated for
+    in >> fingerprint;
+
+    if(in.status() != QDataStream::Ok || fingerprint != m_fingerprint)
+    {
+        qWarning("The cache file was written for a different driver or input file, starting from an empty cache: %s", p_file->fileName().toLatin1().constData());
+        writeHeader();
+        return 0;
+    }
+
+    int n = 0;
+    qint64 last_good_pos = p_file->pos();
+
+    while(!in.atEnd())
+    {
+        Case *c = readCase(in);
+
+        // a partially written record at the end of the file is discarded
+        if(c == 0) break;
+
+        if(store(c)) ++n;
+
+        last_good_pos = p_file->pos();
+    }
+
+    // removing any incomplete record, new records are appended after the last complete one
+    p_file->resize(last_good_pos);
+    p_file->seek(last_good_pos);
+
+    return n;
+}
+
+//-----------------------------------------------------------------------------------------------
+// starts the cache file from scratch
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::writeHeader()
+{
+    p_file->resize(0);
+    p_file->seek(0);
+
+    QDataStream out(p_file);
+    out << CACHE_MAGIC << CACHE_VERSION << m_fingerprint;
+}
+
+//-----------------------------------------------------------------------------------------------
+// stores a case, replacing a stored case without derivatives
+//-----------------------------------------------------------------------------------------------
+bool EvaluationCache::store(Case *c)
+{
+    QByteArray k = key(c);
+    Case *stored = m_cases.value(k, 0);
+
+    if(stored != 0 && (hasDerivatives(stored) || !hasDerivatives(c)))
+    {
+        delete c;
+        return false;
+    }
+
+    if(stored != 0) delete stored;
+    m_cases.insert(k, c);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks if a case has the derivatives of the objective and all the constraints
+//-----------------------------------------------------------------------------------------------
+bool EvaluationCache::hasDerivatives(Case *c)
+{
+    return c->objectiveDerivative() != 0 && c->numberOfConstraintDerivatives() == c->numberOfConstraints();
+}
+
+//-----------------------------------------------------------------------------------------------
+// writes a case to a stream
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::writeCase(QDataStream &out, Case *c)
+{
+    QVector<double> real_vars;
+    QVector<double> binary_vars;
+    QVector<qint32> int_vars;
+    QVector<double> cons;
+
+    for(int i = 0; i < c->numberOfRealVariables(); ++i) real_vars.push_back(c->realVariableValue(i));
+    for(int i = 0; i < c->numberOfBinaryVariables(); ++i) binary_vars.push_back(c->binaryVariableValue(i));
+    for(int i = 0; i < c->numberOfIntegerVariables(); ++i) int_vars.push_back(c->integerVariableValue(i));
+    for(int i = 0; i < c->numberOfConstraints(); ++i) cons.push_back(c->constraintValue(i));
+
+    out << real_vars << binary_vars << int_vars << cons << c->objectiveValue() << c->infeasibility() << c->isFailed();
+
+    // the constraint derivatives
+    out << qint32(c->numberOfConstraintDerivatives());
+    for(int i = 0; i < c->numberOfConstraintDerivatives(); ++i) writeDerivative(out, c->constraintDerivative(i));
+
+    // the objective derivative
+    out << (c->objectiveDerivative() != 0);
+    if(c->objectiveDerivative() != 0) writeDerivative(out, c->objectiveDerivative());
+}
+
+//-----------------------------------------------------------------------------------------------
+// reads a case from a stream
+//-----------------------------------------------------------------------------------------------
+Case* EvaluationCache::readCase(QDataStream &in)
+{
+    QVector<double> real_vars;
+    QVector<double> binary_vars;
+    QVector<qint32> int_vars;
+    QVector<double> cons;
+    double obj;
+    double infeasibility;
+    bool failed;
+    qint32 n_derivatives;
+    bool has_obj_derivative;
+
+    in >> real_vars >> binary_vars >> int_vars >> cons >> obj >> infeasibility >> failed >> n_derivatives;
+
+    Case *c = new Case();
+
+    for(int i = 0; i < real_vars.size(); ++i) c->addRealVariableValue(real_vars.at(i));
+    for(int i = 0; i < binary_vars.size(); ++i) c->addBinaryVariableValue(binary_vars.at(i));
+    for(int i = 0; i < int_vars.size(); ++i) c->addIntegerVariableValue(int_vars.at(i));
+    for(int i = 0; i < cons.size(); ++i) c->addConstraintValue(cons.at(i));
+
+    c->setObjectiveValue(obj);
+    c->setInfeasibility(infeasibility);
+    c->setFailedFlag(failed);
+
+    // the constraint derivatives
+    for(int i = 0; i < n_derivatives && in.status() == QDataStream::Ok; ++i)
+    {
+        c->addConstraintDerivative(readDerivative(in));
+    }
+
+    // the objective derivative
+    in >> has_obj_derivative;
+    if(has_obj_derivative && in.status() == QDataStream::Ok) c->setObjectiveDerivative(readDerivative(in));
+
+    if(in.status() != QDataStream::Ok)
+    {
+        delete c;
+        return 0;
+    }
+
+    return c;
+}
+
+//-----------------------------------------------------------------------------------------------
+// writes a derivative to the cache file
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::writeDerivative(QDataStream &out, Derivative *d)
+{
+    QVector<QPair<qint32, double> > partials;
+    for(int i = 0; i < d->numberOfPartials(); ++i) partials.push_back(qMakePair(qint32(d->variableId(i)), d->value(i)));
+
+    out << qint32(d->constraintId()) << partials;
+}
+
+//-----------------------------------------------------------------------------------------------
+// reads a derivative from the cache file
+//-----------------------------------------------------------------------------------------------
+Derivative* EvaluationCache::readDerivative(QDataStream &in)
+{
+    qint32 con_id;
+    QVector<QPair<qint32, double> > partials;
+
+    in >> con_id >> partials;
+
+    Derivative *d = new Derivative(con_id);
+    for(int i = 0; i < partials.size(); ++i) d->addPartial(partials.at(i).first, partials.at(i).second);
+
+    return d;
+}
+
+//-----------------------------------------------------------------------------------------------
+// looks up a case in the cache
+//-----------------------------------------------------------------------------------------------
+bool EvaluationCache::lookup(Case *c, bool need_derivatives)
+{
+    Case *stored = m_cases.value(key(c), 0);
+
+    if(stored == 0) return false;
+
+    // a case evaluated without derivatives can not be used when they are needed
+    if(need_derivatives && !hasDerivatives(stored)) return false;
+
+    // copying the results
+    *c = *stored;
+
+    ++m_hits;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// adds an evaluated case to the cache
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::insert(Case *c)
+{
+    Case *stored = new Case(*c, true);
+
+    if(!store(stored)) return;
+
+    if(p_file != 0)
+    {
+        QDataStream out(p_file);
+        writeCase(out, stored);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// flushes the cache file
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::flush()
+{
+    if(p_file != 0) p_file->flush();
+}
+
+//-----------------------------------------------------------------------------------------------
+// writes all the cases to a stream
+//-----------------------------------------------------------------------------------------------
+void EvaluationCache::write(QDataStream &out)
+{
+    out << qint32(m_cases.size());
+
+    for(QHash<QByteArray, Case*>::const_iterator it = m_cases.constBegin(); it != m_cases.constEnd(); ++it) writeCase(out, it.value());
+}
+
+//-----------------------------------------------------------------------------------------------
+// reads the cases in a stream
+//-----------------------------------------------------------------------------------------------
+bool EvaluationCache::readCases(QDataStream &in, QVector<Case*> *cases)
+{
+    qint32 n_cases;
+    in >> n_cases;
+
+    if(in.status() != QDataStream::Ok || n_cases < 0) return false;
+
+    QVector<Case*> read_cases;
+
+    for(int i = 0; i < n_cases; ++i)
+    {
+        Case *c = readCase(in);
+
+        if(c == 0)
+        {
+            qDeleteAll(read_cases);
+            return false;
+        }
+
+        read_cases.push_back(c);
+    }
+
+    *cases = read_cases;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// adds cases to the cache
+//-----------------------------------------------------------------------------------------------
+int EvaluationCache::add(const QVector<Case*> &cases)
+{
+    int n = 0;
+    for(int i = 0; i < cases.size(); ++i)
+    {
+        Case *c = cases.at(i);
+
+        if(store(c))
+        {
+            if(p_file != 0)
+            {
+                QDataStream out(p_file);
+                writeCase(out, c);
+            }
+
+            ++n;
+        }
+    }
+
+    return n;
+}
+
+} // namespace ResOpt
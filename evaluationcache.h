@@ -0,0 +1,202 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef EVALUATIONCACHE_H
+#define EVALUATIONCACHE_H
+
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QFile;
+class QDataStream;
+
+namespace ResOpt
+{
+
+class Case;
+class Derivative;
+
+
+/**
+ * @brief Stores the results of already evaluated cases.
+ * @details The cache is keyed on the real, binary and integer variable values of a Case. When a Case with the same variable values
+ *          is sent for evaluation again, the stored constraint values, objective value and derivatives are copied to it, and
+ *          the Case does not have to be sent to a Launcher.
+ *
+ *          If a cache file is set, all new entries are appended to the file, and entries from previous runs are read back when the
+ *          file is opened. This way a restarted optimization does not have to re-run the reservoir simulator for cases that were
+ *          evaluated before the restart.
+ *
+ */
+class EvaluationCache
+{
+private:
+    QHash<QByteArray, Case*> m_cases;
+    QFile *p_file;
+    QByteArray m_fingerprint;   // identifies the problem the cases in the file were evaluated for
+    int m_hits;
+
+    /**
+     * @brief Reads all the complete records in the cache file into the cache
+     *
+     * @return int the number of records read
+     */
+    int readFile();
+
+    /**
+     * @brief Empties the cache file, and writes the header.
+     *
+     */
+    void writeHeader();
+
+    /**
+     * @brief Stores a Case in the cache, taking ownership of it.
+     * @details A Case that is already in the cache is only replaced if the new one has derivatives and the stored one does not. Otherwise
+     *          the new Case is deleted.
+     *
+     * @param c
+     * @return bool true if c was stored
+     */
+    bool store(Case *c);
+
+    static void writeDerivative(QDataStream &out, Derivative *d);
+    static Derivative* readDerivative(QDataStream &in);
+
+public:
+    EvaluationCache();
+    ~EvaluationCache();
+
+
+    /**
+     * @brief Generates the key used for looking up a Case in the cache.
+     * @details The key is the binary representation of all the variable values in the Case.
+     *
+     * @param c
+     * @return QByteArray
+     */
+    static QByteArray key(Case *c);
+
+
+    /**
+     * @brief Writes a Case (variables, results and derivatives) to a stream, in the format used by the cache file.
+     *
+     * @param out
+     * @param c
+     */
+    static void writeCase(QDataStream &out, Case *c);
+
+    /**
+     * @brief Reads a Case written by writeCase().
+     *
+     * @param in
+     * @return Case the new Case, or a null pointer if the record was incomplete
+     */
+    static Case* readCase(QDataStream &in);
+
+
+    /**
+     * @brief Connects the cache to a file on disk.
+     * @details Entries already present in the file are loaded into the cache. New entries are appended to the end of the file. The header of
+     *          the file holds the fingerprint of the problem (see Runner::fingerprint()). If the fingerprint in the file is different, the
+     *          entries were evaluated for a different problem, and the file is started from scratch.
+     *
+     * @param f
+     * @param fingerprint
+     * @return bool false if the file could not be opened
+     */
+    bool setFile(const QString &f, const QByteArray &fingerprint);
+
+
+    /**
+     * @brief Looks for a previously evaluated Case with the same variable values as c.
+     * @details If found, the constraint values, objective value and derivatives of the stored Case are copied to c. When need_derivatives
+     *          is set, a stored Case without derivatives (see hasDerivatives()) is not used.
+     *
+     * @param c
+     * @param need_derivatives
+     * @return bool true if c was found in the cache
+     */
+    bool lookup(Case *c, bool need_derivatives = false);
+
+
+    /**
+     * @brief Checks if a Case has derivatives of the objective and all the constraints.
+     * @details The derivatives are part of each record written by writeCase(), so this is also known for cases read from a file.
+     *
+     * @param c
+     * @return bool
+     */
+    static bool hasDerivatives(Case *c);
+
+
+    /**
+     * @brief Adds an evaluated Case to the cache.
+     * @details A copy of c (including results) is stored. If the Case is already in the cache nothing is done, unless only c has derivatives.
+     *
+     * @param c
+     */
+    void insert(Case *c);
+
+
+    /**
+     * @brief Flushes new entries to the cache file, if any.
+     *
+     */
+    void flush();
+
+
+    /**
+     * @brief Writes all the cases in the cache to a stream. Used for checkpoints.
+     *
+     * @param out
+     */
+    void write(QDataStream &out);
+
+    /**
+     * @brief Reads the cases written by write(), without adding them to the cache.
+     * @details Nothing is returned in cases if the stream was incomplete.
+     *
+     * @param in
+     * @param cases the cases that were read, owned by the caller
+     * @return bool false if the stream was incomplete
+     */
+    static bool readCases(QDataStream &in, QVector<Case*> *cases);
+
+    /**
+     * @brief Adds cases to the cache, taking ownership of them. Cases that are already in the cache are deleted.
+     *
+     * @param cases
+     * @return int the number of new cases
+     */
+    int add(const QVector<Case*> &cases);
+
+    // get functions
+    int size() const {return m_cases.size();}
+    int hits() const {return m_hits;}
+    bool hasFile() const {return p_file != 0;}
+
+};
+
+} // namespace ResOpt
+
+#endif // EVALUATIONCACHE_H
@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Stand-in for a resident MATLAB, for trying out the RESIDENT_MATLAB mode of the MRST interface without MATLAB.
+#
+# Give the path to this script as the MATLAB path in the RESERVOIR section, together with the RESIDENT_MATLAB keyword.
+# The command line arguments meant for MATLAB are ignored. Each line read from standard input is taken as one command,
+# and answered with some noise followed by the done marker, the same way the resident MATLAB does. Like MATLAB reading
+# commands from a pipe, the answer is written after a prompt (">> RESOPT_DONE 0"). The line "exit" ends the worker.
+# No simulation is run, so the output files are not updated.
+#
+# RESOPT_WORKER_STATUS   status code written after the done marker (default 0)
+# RESOPT_WORKER_DELAY    seconds to sleep before answering each command, for testing timeouts and cancellation (default 0)
+# RESOPT_WORKER_PROMPT   prompt written in front of the output of each command (default ">> ")
+
+status=${RESOPT_WORKER_STATUS:-0}
+delay=${RESOPT_WORKER_DELAY:-0}
+prompt=${RESOPT_WORKER_PROMPT-">> "}
+
+while IFS= read -r command
+do
+    if [ "$command" = "exit" ]; then
+        exit 0
+    fi
+
+    echo "${prompt}resident worker: $command"
+
+    if [ "$delay" != "0" ]; then
+        sleep "$delay"
+    fi
+
+    echo "${prompt}RESOPT_DONE $status"
+done
+
+exit 0
@@ -522,7 +522,7 @@ bool GprsSimulator::launchSimulator()
     cout << "GPRS is running..." << endl;
 
 
-    gprs.waitForFinished(-1);
+    if(!waitForProcess(&gprs)) return false;
 
     // checking the exit code
 
@@ -608,7 +608,7 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
 
     int n_streams = 0;
 
-    QVector<Stream*> raw_output;    // output streams from the simulator, this must be averaged
+    QVector<Stream> raw_output;     // output streams from the simulator, this must be averaged
 
 
     while(!input.atEnd() && ok)
@@ -630,13 +630,13 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
             // checking if the line was converted ok
             if(ok_line)
             {
-                Stream *s = new Stream();
+                Stream s;
 
-                s->setTime(nums.at(0));
-                s->setPressure(nums.at(1));
-                s->setGasRate(nums.at(3));
-                s->setOilRate(nums.at(4));
-                s->setWaterRate(nums.at(5));
+                s.setTime(nums.at(0));
+                s.setPressure(nums.at(1));
+                s.setGasRate(nums.at(3));
+                s.setOilRate(nums.at(4));
+                s.setWaterRate(nums.at(5));
 
                 raw_output.push_back(s);
                 n_streams++;
@@ -659,14 +659,15 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
 
         // creating a subset of the raw data for averaging
         QVector<Stream*> raw_subset;
-        while(current_place < raw_output.size() && raw_output.at(current_place)->time() <= w->control(i)->endTime())
+        while(current_place < raw_output.size() && raw_output.at(current_place).time() <= w->control(i)->endTime())
         {
-            raw_subset.push_back(raw_output.at(current_place));
+            raw_subset.push_back(raw_output.data() + current_place);
             ++current_place;
         }
 
         // making an average stream
-        Stream *avg_s = new Stream();
+        Stream avg_s;
+        Stream s_add;   // empty stream for the remainder of the time, only used if the simulator stopped early
 
         // checking if the raw subset contains any data (if not, the simulator probably didnt converge and quit before it was time)
         if(raw_subset.size() > 0)
@@ -682,19 +683,18 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
                      << "Expected: " << w->control(i)->endTime() << "(days)" << endl << endl;
 
                 // adding an empty stream for the remainder of the time
-                Stream *s_add = new Stream();
-                s_add->setGasRate(0);
-                s_add->setOilRate(0);
-                s_add->setWaterRate(0);
-                s_add->setPressure(0);
-                s_add->setTime(w->control(i)->endTime());
+                s_add.setGasRate(0);
+                s_add.setOilRate(0);
+                s_add.setWaterRate(0);
+                s_add.setPressure(0);
+                s_add.setTime(w->control(i)->endTime());
 
-                raw_subset.push_back(s_add);
+                raw_subset.push_back(&s_add);
 
 
 
             }
-            avg_s->avg(raw_subset, t_start);
+            avg_s.avg(raw_subset, t_start);
 
         }
         else
@@ -707,17 +707,17 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
 
 
             // didnt find any info from the simulator, just making an empty stream
-            avg_s->setGasRate(0);
-            avg_s->setOilRate(0);
-            avg_s->setWaterRate(0);
-            avg_s->setPressure(0);
-            avg_s->setTime(w->control(i)->endTime());
+            avg_s.setGasRate(0);
+            avg_s.setOilRate(0);
+            avg_s.setWaterRate(0);
+            avg_s.setPressure(0);
+            avg_s.setTime(w->control(i)->endTime());
 
 
 
 
         }
-        // setting it to the well
+        // setting it to the well, the stream is copied into the well
         if(!w->setStream(i, avg_s))
         {
             cout << endl << "###  Runtime Error  ###" << endl
@@ -731,9 +731,6 @@ bool GprsSimulator::readWellOutput(Well *w, QString file_name)
         t_start = w->control(i)->endTime();
     }
 
-    // deleting the raw output
-    for(int i = 0; i < raw_output.size(); ++i) delete raw_output.at(i);
-
 
     return ok;
 
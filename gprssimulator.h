@@ -64,7 +64,7 @@ public:
 
     virtual ReservoirSimulator* clone() const {return new GprsSimulator(*this);}
 
-    virtual QString description() const {return QString("SIMULATOR GPRS\n\n");}
+    virtual QString description() const {return QString("SIMULATOR GPRS") + (timeout() > 0 ? " " + QString::number(timeout()) : QString()) + "\n\n";}
 
     virtual bool generateInputFiles(Model *m);
     virtual bool launchSimulator();
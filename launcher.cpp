@@ -22,6 +22,8 @@
 #include "launcher.h"
 
 #include <QVector>
+#include <QDataStream>
+#include <QMutexLocker>
 
 #include "model.h"
 #include "adjointscoupledmodel.h"
@@ -38,6 +40,7 @@
 #include "separator.h"
 #include "logger.h"
 #include "pressuredropcalculator.h"
+#include "casescheduler.h"
 
 
 
@@ -63,7 +66,10 @@ Launcher::Launcher(QObject *parent)
     : QObject(parent),
       p_model(0),
       p_simulator(0),
-      m_number_of_runs(0)
+      p_scheduler(0),
+      m_number_of_runs(0),
+      p_current_case(0),
+      m_current_cancelled(false)
 {
 }
 
@@ -113,7 +119,14 @@ void Launcher::evaluate(Case *c, Component *comp)
 
     cout << endl << "---- Starting model evaluation # " << ++m_number_of_runs <<  " ----" << endl;
 
-    if(comp == 0) evaluateEntireModel(c);   // the entire model should be evaluated
+    // the case may have been cancelled after it was handed out
+    if(isCurrentCaseCancelled())
+    {
+        cout << "Model evaluation was cancelled..." << endl;
+        c->setCancelled(p_model);
+    }
+
+    else if(comp == 0) evaluateEntireModel(c);   // the entire model should be evaluated
 
     else        // only a single component should be evaluated
     {
@@ -142,6 +155,63 @@ void Launcher::evaluate(Case *c, Component *comp)
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Sets the case that is being evaluated
+//-----------------------------------------------------------------------------------------------
+void Launcher::setCurrentCase(Case *c)
+{
+    QMutexLocker locker(&m_current_mutex);
+
+    p_current_case = c;
+    m_current_cancelled = false;
+
+    // a cancellation of the previous case does not apply to this one
+    if(p_simulator != 0) p_simulator->resetCancelled();
+}
+
+//-----------------------------------------------------------------------------------------------
+// Checks if the current case has been cancelled
+//-----------------------------------------------------------------------------------------------
+bool Launcher::isCurrentCaseCancelled()
+{
+    QMutexLocker locker(&m_current_mutex);
+
+    return m_current_cancelled;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Cancels the current case
+//-----------------------------------------------------------------------------------------------
+void Launcher::cancel(const QVector<Case*> &cases)
+{
+    QMutexLocker locker(&m_current_mutex);
+
+    if(p_current_case == 0 || !cases.contains(p_current_case)) return;
+
+    m_current_cancelled = true;
+
+    // stopping the reservoir simulator if it is running, or making it return right away if it has not started yet
+    if(p_simulator != 0) p_simulator->cancel();
+}
+
+//-----------------------------------------------------------------------------------------------
+// Evaluating cases from the scheduler until there are no more
+//-----------------------------------------------------------------------------------------------
+void Launcher::work()
+{
+    if(p_scheduler == 0) return;
+
+    CaseScheduler::Job job;
+
+    // the scheduler sets the current case when it hands out the job
+    while(p_scheduler->take(this, &job))
+    {
+        evaluate(job.c, job.comp);
+        setCurrentCase(0);
+    }
+}
+
+
 //-----------------------------------------------------------------------------------------------
 // Running the entire model, calculating results
 //-----------------------------------------------------------------------------------------------
@@ -181,10 +251,6 @@ void Launcher::evaluateEntireModel(Case *c)
 
 
 
-    // checking if the reservoir simulator must be rerun
-    //bool run_res_sim = rerunReservoirSimulator(c);
-    bool run_res_sim = true;
-
     // setting the variable values according to the case
     for(int i = 0; i < p_model->realVariables().size(); ++i)    // real variables
     {
@@ -202,46 +268,65 @@ void Launcher::evaluateEntireModel(Case *c)
     // the variable values have changed, so the status of the model is no longer up to date
     p_model->setUpToDate(false);
 
+    // checking if the reservoir simulator must be rerun, or if only network variables have changed since the last run
+    QByteArray fingerprint = reservoirSimulatorFingerprint();
+    bool run_res_sim = m_res_sim_fingerprint.isEmpty() || fingerprint != m_res_sim_fingerprint;
+
 
     // running the reservoir simulator, if needed
     if(run_res_sim)
     {
         emit runningReservoirSimulator();
 
+        // the well streams in the model are not valid until the output has been read
+        m_res_sim_fingerprint.clear();
+
         bool ok_input = p_simulator->generateInputFiles(p_model);    // generating input based on the current Model
         if(!ok_input)
         {
             p_model->logger()->error("Reservoir simulator input files not generated propperly");
-            return;
         }
 
-        bool ok_launch = p_simulator->launchSimulator();            // running the simulator
-        if(!ok_launch)
+        bool ok_launch = ok_input && p_simulator->launchSimulator();    // running the simulator
+        if(ok_input && !ok_launch)
         {
-            cout << "### Runtime error! ###" << endl;
-            cout << "Reservoir simulator did not run successfully..." << endl;
-            cout << "Last case: " << endl;
-            c->printToCout();
-
-            exit(1);
+            if(p_simulator->isCancelled()) cout << "Reservoir simulator run was cancelled..." << endl;
+            else
+            {
+                cout << "### Runtime error! ###" << endl;
+                cout << "Reservoir simulator did not run successfully..." << endl;
+                cout << "Last case: " << endl;
+                c->printToCout();
+            }
         }
 
-        bool ok_read = p_simulator->readOutput(p_model);            // reading output from the simulator run, and setting to Model
-        if(!ok_read)
+        bool ok_read = ok_launch && p_simulator->readOutput(p_model);  // reading output from the simulator run, and setting to Model
+        if(ok_launch && !ok_read)
         {
             cout << "### Runtime error! ###" << endl;
             cout << "Could not read simulator output file..." << endl;
             cout << "Last case: " << endl;
             c->printToCout();
+        }
 
-            exit(1);
+        // the case is marked as infeasible, the rest of the cases are still evaluated
+        if(!ok_read)
+        {
+            if(p_simulator->isCancelled()) c->setCancelled(p_model);
+            else c->setFailed(p_model);
+            return;
         }
 
+        m_res_sim_fingerprint = fingerprint;
 
     }
-    else
+
+    // the reservoir simulator run may have been skipped, checking for a cancellation before processing the network
+    if(isCurrentCaseCancelled())
     {
-        cout << "No need to run reservoir simulator, it is already up to date..." << endl;
+        cout << "Model evaluation was cancelled..." << endl;
+        c->setCancelled(p_model);
+        return;
     }
 
     // process the model
@@ -272,6 +357,7 @@ void Launcher::evaluateEntireModel(Case *c)
         }
 
         c->setObjectiveValue(p_model->objective()->value());
+        c->setFailedFlag(false);
     }
 
 
@@ -297,12 +383,15 @@ void Launcher::evaluatePipe(Case *c, Pipe *p)
 
     }
 
-    // creating a stream for the pressure drop calculation
-    Stream *s = new Stream(0, c->realVariableValue(0), c->realVariableValue(1), c->realVariableValue(2), 0);
+    // creating a stream for the pressure drop calculation, the rates and pressure are in metric units
+    double qo = c->realVariableValue(0);
+    double qg = c->realVariableValue(1);
+    double qw = c->realVariableValue(2);
+
+    Stream s(0, qo, qg, qw, 0, Stream::METRIC);
 
     // calculating the pressure drop
-    // TODO: the hardcoding of METRIC here is not right!
-    double dp = p->calculator()->pressureDrop(s, c->realVariableValue(3), Stream::METRIC);
+    double dp = p->calculator()->pressureDrop(&s, c->realVariableValue(3), Stream::METRIC);
 
     // setting the pressure drop as the objective
     c->setObjectiveValue(dp);
@@ -365,6 +454,7 @@ void Launcher::evaluateWell(Case *c, Well *w)
 
     // running the reservoir simulator
     emit runningReservoirSimulator();
+    m_res_sim_fingerprint.clear();
 
     p_simulator->generateInputFiles(p_model);   // generating input based on the current Model
     p_simulator->launchSimulator();             // running the simulator
@@ -389,34 +479,31 @@ void Launcher::evaluateWell(Case *c, Well *w)
 
 
 //-----------------------------------------------------------------------------------------------
-// Checks if the reservoir simulator has to be rerun
+// Makes a fingerprint of the variable values that are input to the reservoir simulator
 //-----------------------------------------------------------------------------------------------
-bool Launcher::rerunReservoirSimulator(Case *c)
+QByteArray Launcher::reservoirSimulatorFingerprint()
 {
-    bool rerun = false;
+    QByteArray fingerprint;
+    QDataStream out(&fingerprint, QIODevice::WriteOnly);
 
-    if(!p_model->isUpToDate()) return true; // checks if the model has been evaluated yet
+    // the size of the model is included, so that the fingerprint is never empty
+    out << p_model->realVariables().size() << p_model->integerVariables().size();
 
-    // looping through the real variables
+    // real variables: well controls and gas lift rates
     for(int i = 0; i < p_model->realVariables().size(); ++i)
     {
-        // checking if the variable is asociated with a well
-        Well *w = dynamic_cast<Well*>(p_model->realVariables().at(i)->parent());
-
-        if(w != 0)  // this var is a well control variable
-        {
-
-
-            if(c->realVariableValue(i) != p_model->realVariables().at(i)->value())  // the  variable value has changed from whats in the model
-            {
-                rerun = true;
-                break;  // no need to check any more variables
-            }
-        }
+        if(dynamic_cast<Well*>(p_model->realVariables().at(i)->parent()) != 0) out << p_model->realVariables().at(i)->value();
+    }
 
+    // integer variables: install times, well connections and well paths
+    for(int i = 0; i < p_model->integerVariables().size(); ++i)
+    {
+        if(dynamic_cast<Well*>(p_model->integerVariables().at(i)->parent()) != 0) out << p_model->integerVariables().at(i)->value();
     }
 
-    return rerun;
+    // the binary variables that belong to wells are routing variables, and only affect the pipe network
+
+    return fingerprint;
 }
 
 
@@ -23,6 +23,9 @@
 #define LAUNCHER_H
 
 #include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
 
 namespace ResOpt
 {
@@ -33,6 +36,7 @@ class Case;
 class Component;
 class Pipe;
 class Well;
+class CaseScheduler;
 
 /**
  * @brief Launches the project.
@@ -46,19 +50,34 @@ class Launcher : public QObject
 private:
     Model *p_model;
     ReservoirSimulator *p_simulator;
+    CaseScheduler *p_scheduler;
 
     int m_number_of_runs;
 
+    QByteArray m_res_sim_fingerprint;   // fingerprint of the variable values used in the last successful reservoir simulator run
+
+    Case *p_current_case;               // the case that is being evaluated, 0 if idle
+    bool m_current_cancelled;           // true if the current case has been cancelled
+    QMutex m_current_mutex;
 
     /**
-     * @brief Checks if the reservoir simulator must be rerun for the Case.
-     * @details This function checks if any of the real variable values in the Case that corresponds to well control variables have changed
-     *          from what is currently in the model. The function also checks if the simulator has been launched.
+     * @brief Checks if the current case has been cancelled since it was handed out.
      *
-     * @param c
      * @return bool
      */
-    bool rerunReservoirSimulator(Case *c);
+    bool isCurrentCaseCancelled();
+
+
+    /**
+     * @brief Makes a fingerprint of the variable values that are input to the reservoir simulator.
+     * @details Only the real and integer variables that belong to a Well are included (well controls, gas lift rates, install times,
+     *          connections and well paths). Routing variables, and variables belonging to separators and pressure boosters, only
+     *          affect the pipe network, and are left out. If the fingerprint is the same as for the last simulator run, the well streams
+     *          already in the Model are still valid, and the reservoir simulator does not need to be rerun.
+     *
+     * @return QByteArray
+     */
+    QByteArray reservoirSimulatorFingerprint();
 
     void evaluateEntireModel(Case *c);
     void evaluatePipe(Case *c, Pipe *p);
@@ -69,18 +88,40 @@ private:
 public:
     explicit Launcher(QObject *parent = 0);
 
-    ~Launcher();
+    virtual ~Launcher();
 
     bool initialize();
 
     // set functions
-    void setModel(Model *m) {if(p_model != 0) delete p_model; p_model = m;}
+    void setModel(Model *m) {if(p_model != 0) delete p_model; p_model = m; m_res_sim_fingerprint.clear();}
+
+    void setReservoirSimulator(ReservoirSimulator *s) {p_simulator = s; m_res_sim_fingerprint.clear();}
 
-    void setReservoirSimulator(ReservoirSimulator *s) {p_simulator = s;}
+    void setScheduler(CaseScheduler *s) {p_scheduler = s;}
 
     // get functions
     Model* model() {return p_model;}
     ReservoirSimulator* reservoirSimulator() {return p_simulator;}
+    CaseScheduler* scheduler() {return p_scheduler;}
+
+
+    /**
+     * @brief Cancels the evaluation of the current case, if it is one of the cases in the list. May be called from any thread.
+     * @details The reservoir simulator run is stopped, and the case is marked as failed (see Case::setFailed()). finished() is still
+     *          emitted for the case.
+     *
+     * @param cases
+     */
+    virtual void cancel(const QVector<Case*> &cases);
+
+    /**
+     * @brief Sets the case that is being evaluated. May be called from any thread.
+     * @details Called by the CaseScheduler when it hands out the case, under the same lock as the case is registered as running, so a
+     *          cancellation of the case can not be missed. Cancellations of earlier cases are cleared.
+     *
+     * @param c the case, or 0 when the Launcher is done with it
+     */
+    void setCurrentCase(Case *c);
     
 signals:
 
@@ -107,6 +148,15 @@ public slots:
     void evaluate(Case *c, Component *comp);
 
 
+    /**
+     * @brief Evaluates cases from the CaseScheduler until the queue is empty.
+     * @details This slot is invoked by the CaseScheduler when new cases are submitted while the Launcher is idle. finished() is emitted after
+     *          each case. Reimplemented by RemoteLauncher, which forwards the cases to a worker process.
+     *
+     */
+    virtual void work();
+
+
 };
 
 } // namespace ResOpt
@@ -73,6 +73,46 @@ ResOpt is run from the command line like this:
 ResOpt 'driver file'
 @endcode
 
+The results of all the model evaluations are stored in the binary summary log run_summary.bin.
+The text summary is generated from the log with:
+
+@code
+ResOpt -summary run_summary.bin run_summary.out
+@endcode
+
+If the driver file has a CHECKPOINT keyword, the state of the run is saved to the checkpoint file at regular intervals
+(CHECKPOINT file [seconds], default every 600 seconds). An interrupted run is restarted from the checkpoint with:
+
+@code
+ResOpt --resume 'driver file'
+@endcode
+
+The checkpoint is only used if the driver file and the input files it refers to have not changed since it was written. The results of
+the resumed run are appended to the summary log of the interrupted run.
+
+The grouping of the finite difference perturbations (see JacobianStructure) is checked on a known structure with:
+
+@code
+ResOpt -check
+@endcode
+
+\section sec_par Distributed runs
+
+The model evaluations may be spread over several processes, on the same or on different machines. The master runs the optimizer,
+and starts the given number of local workers, using the driver files in the mr/0/, mr/1/, ... sub folders of the master driver file:
+
+@code
+ResOpt --master 'driver file' 'local workers' [port]
+@endcode
+
+Workers on other machines connect to the master with:
+
+@code
+ResOpt --worker host:port 'driver file'
+@endcode
+
+Each worker evaluates as many cases at the same time as its PARALLELRUNS setting.
+
 \section sec_ex Example driver file
 
 @code
@@ -222,8 +262,11 @@ EOF
 
 
 #include "runner.h"
+#include "summarylog.h"
+#include "opt/jacobianstructure.h"
 #include "gui/mainwindow.h"
-//#include "par/masterrunner.h"
+#include "par/masterrunner.h"
+#include "par/workerclient.h"
 
 using namespace ResOpt;
 using namespace ResOptGui;
@@ -239,11 +282,58 @@ int main(int argc, char *argv[])
     Runner *r = 0;
 
 
-    if(argc == 2)
+    if(argc == 4 && QString(argv[1]) == "-summary")
+    {
+        // rendering the text summary from a summary log
+        return SummaryLog::render(argv[2], argv[3]) ? 0 : 1;
+    }
+    else if(argc == 2 && QString(argv[1]) == "-check")
     {
+        // checking the grouping of the finite difference perturbations on a known structure
+        bool ok = JacobianStructure::checkGrouping();
+        cout << "Perturbation grouping check " << (ok ? "passed" : "failed") << endl;
 
+        return ok ? 0 : 1;
+    }
+    else if((argc == 4 || argc == 5) && QString(argv[1]) == "--master")
+    {
+        // master of a distributed run: driver file, number of local workers, and optionally the port
         a = new QCoreApplication(argc, argv);
-        r = new Runner(argv[1]);
+
+        MasterRunner *mr = new MasterRunner(argv[2], QString(argv[3]).toInt());
+        if(argc == 5) mr->setPort(QString(argv[4]).toUShort());
+
+        QObject::connect(mr, SIGNAL(optimizationFinished()), a, SLOT(quit()));
+        QTimer::singleShot(0, mr, SLOT(run()));
+    }
+    else if(argc == 4 && QString(argv[1]) == "--worker")
+    {
+        // worker of a distributed run: host:port of the master, and the driver file
+        a = new QCoreApplication(argc, argv);
+
+        QStringList address = QString(argv[2]).split(":");
+        if(address.size() != 2)
+        {
+            cout << "The master should be given as host:port" << endl;
+            return 1;
+        }
+
+        r = new Runner(argv[3]);
+        r->initialize();
+
+        WorkerClient *w = new WorkerClient(r);
+        if(!w->connectToMaster(address.at(0), address.at(1).toUShort())) return 1;
+
+        QObject::connect(w, SIGNAL(finished()), a, SLOT(quit()));
+    }
+    else if(argc == 2 || (argc == 3 && QString(argv[1]) == "--resume"))
+    {
+
+        a = new QCoreApplication(argc, argv);
+        r = new Runner(argv[argc - 1]);
+
+        // resuming from the CHECKPOINT file given in the driver file
+        if(argc == 3) r->setResume(true);
 
         QObject::connect(r,SIGNAL(optimizationFinished()), a, SLOT(quit()));
         QTimer::singleShot(0, r, SLOT(run()));
@@ -290,7 +380,12 @@ int main(int argc, char *argv[])
     else
     {
         cout << "Wrong input arguments!" << endl
-             << "Correct usage: .\\ResOpt driver_file" << endl;
+             << "Correct usage: .\\ResOpt driver_file" << endl
+             << "               .\\ResOpt --resume driver_file" << endl
+             << "               .\\ResOpt --master driver_file local_workers [port]" << endl
+             << "               .\\ResOpt --worker host:port driver_file" << endl
+             << "               .\\ResOpt -summary summary_log text_file" << endl
+             << "               .\\ResOpt -check" << endl;
         a->exit(1);
     }
 
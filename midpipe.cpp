@@ -120,6 +120,8 @@ void MidPipe::calculateInletPressure()
         }
     }
 
+    m_p_out.resize(numberOfStreams());
+
     // looping through the time steps
     for(int i = 0; i < numberOfStreams(); i++)
     {
@@ -130,19 +132,15 @@ void MidPipe::calculateInletPressure()
         {
             frac += outletConnection(k)->variable()->value();
             Stream *s = outletConnection(k)->pipe()->stream(i);
-            p_out += s->pressure(stream(i)->inputUnits())*outletConnection(k)->variable()->value();
+            p_out += s->pressure<Units::FIELD>().value()*outletConnection(k)->variable()->value();
         }
 
-        p_out = p_out / frac;
-
-
-
-        double dp = calculator()->pressureDrop(stream(i), p_out, stream(i)->inputUnits());    // the pressure drop in the pipe
-
-
-        stream(i)->setPressure(dp + p_out);      // setting the inlet pressure for the time step
+        m_p_out[i] = p_out / frac;
     }
 
+    // calculating the pressure drops, and setting the inlet pressures for all the time steps
+    calculateInletPressures(m_p_out);
+
 
 }
 
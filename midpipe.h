@@ -50,6 +50,8 @@ private:
     QVector<PipeConnection*> m_outlet_connections;
     shared_ptr<Constraint> p_connection_constraint;            // constraint that makes sure that the sum of flow to pipes = 1
 
+    QVector<double> m_p_out;    // outlet pressure for each time step (psia), used by calculateInletPressure()
+
 
 public:
     MidPipe();
@@ -53,7 +53,10 @@ namespace ResOpt
 Model::Model()
     : p_reservoir(0),
       p_obj(0),
-      m_up_to_date(false)
+      m_up_to_date(false),
+      m_registered_wells(-1),
+      m_registered_pipes(-1),
+      m_registered_real_vars(-1)
 {
     p_logger = new Logger(Logger::DELEGATE);
 
@@ -88,6 +91,10 @@ Model::Model(const Model &m)
         m_pipes.push_back(m.pipe(i)->clone());
     }
 
+    // the registry points to the copied components
+    buildRegistry();
+    m_registered_real_vars = -1;
+
     // copying the capacity constraints
     for(int i = 0; i < m.numberOfCapacities(); i++)
     {
@@ -258,6 +265,9 @@ bool Model::resolvePipeRouting()
 
     bool ok = true;
 
+    // making sure the registry is up to date with the components
+    buildRegistry();
+
     // first cleaning up the current feeds connected to the pipes
     for(int k = 0; k < m_pipes.size(); ++k) m_pipes.at(k)->cleanFeedConnections();
 
@@ -276,20 +286,17 @@ bool Model::resolvePipeRouting()
             // looping through the pipe connections for the well
             for(int k = 0; k < prod_well->numberOfPipeConnections(); ++k)
             {
-                bool connection_ok;
+                bool connection_ok = false;
                 int pipe_num = prod_well->pipeConnection(k)->pipeNumber();
 
-                for(int j = 0; j < m_pipes.size(); j++)     // looping through the pipes to find the correct one
+                Pipe *p = pipeByNumber(pipe_num);   // finding the correct pipe
+                if(p != 0)
                 {
-                    if(m_pipes.at(j)->number() == pipe_num)     // found the correct pipe
-                    {
-                        m_pipes.at(j)->addFeedWell(prod_well);              // adding the well as a feed to the pipe
-                        prod_well->pipeConnection(k)->setPipe(m_pipes.at(j));   // setting the pipe as outlet pipe for the pipe connection
+                    p->addFeedWell(prod_well);                      // adding the well as a feed to the pipe
+                    prod_well->pipeConnection(k)->setPipe(p);       // setting the pipe as outlet pipe for the pipe connection
 
-                        connection_ok = true;
-                        break;
-                    }
-                } // pipe for pipe connection k
+                    connection_ok = true;
+                }
 
                 // checking if the well - pipe connection was ok
                 if(!connection_ok)
@@ -347,18 +354,14 @@ bool Model::resolvePipeRouting()
                     exit(1);
                 }
 
-                // looping through the pipes to find the correct one
-                for(int j = 0; j < numberOfPipes(); j++)
+                // finding the correct pipe
+                Pipe *p = pipeByNumber(pipe_num);
+                if(p != 0)
                 {
-                    if(pipe_num == pipe(j)->number())
-                    {
-                        p_mid->outletConnection(k)->setPipe(pipe(j));
-                        pipe(j)->addFeedPipe(p_mid);
-
-                        pipe_ok = true;
-                        break;
-                    }
+                    p_mid->outletConnection(k)->setPipe(p);
+                    p->addFeedPipe(p_mid);
 
+                    pipe_ok = true;
                 }
 
                 // checking if the pipe - pipe connection was ok
@@ -402,18 +405,14 @@ bool Model::resolvePipeRouting()
                 exit(1);
             }
 
-            // looping through the pipes to find the correct one
-            for(int j = 0; j < numberOfPipes(); j++)
+            // finding the correct pipe
+            Pipe *p = pipeByNumber(pipe_num);
+            if(p != 0)
             {
-                if(pipe_num == pipe(j)->number())
-                {
-                    p_sep->outletConnection()->setPipe(pipe(j));
-                    pipe(j)->addFeedPipe(p_sep);
-
-                    pipe_ok = true;
-                    break;
-                }
+                p_sep->outletConnection()->setPipe(p);
+                p->addFeedPipe(p_sep);
 
+                pipe_ok = true;
             }
 
             // checking if the pipe - pipe connection was ok
@@ -445,18 +444,14 @@ bool Model::resolvePipeRouting()
                 exit(1);
             }
 
-            // looping through the pipes to find the correct one
-            for(int j = 0; j < numberOfPipes(); ++j)
+            // finding the correct pipe
+            Pipe *p = pipeByNumber(pipe_num);
+            if(p != 0)
             {
-                if(pipe_num == pipe(j)->number())
-                {
-                    p_boost->outletConnection()->setPipe(pipe(j));
-                    pipe(j)->addFeedPipe(p_boost);
-
-                    pipe_ok = true;
-                    break;
-                }
+                p_boost->outletConnection()->setPipe(p);
+                p->addFeedPipe(p_boost);
 
+                pipe_ok = true;
             }
 
             // checking if the pipe - pipe connection was ok
@@ -475,9 +470,95 @@ bool Model::resolvePipeRouting()
     }   // pipe i
 
 
+    // setting up the compiled pipe network for the new connections
+    compilePipeNetwork();
+
     return ok;
 }
 
+//-----------------------------------------------------------------------------------------------
+// Sets up the flat, ordered pipe network from the current connections
+//-----------------------------------------------------------------------------------------------
+void Model::compilePipeNetwork()
+{
+    m_pipe_nodes.clear();
+    m_pipe_outlets.clear();
+    m_pipe_outlet_connections.clear();
+    m_pipe_node_index.clear();
+
+    m_pipe_nodes.reserve(numberOfPipes());
+
+    QVector<int> state(numberOfPipes(), 0);
+
+    for(int i = 0; i < numberOfPipes(); ++i) addPipeNode(i, state);
+}
+
+//-----------------------------------------------------------------------------------------------
+// Adds pipe i to the compiled network, after all the pipes it flows into
+//-----------------------------------------------------------------------------------------------
+void Model::addPipeNode(int i, QVector<int> &state)
+{
+    if(state.at(i) == 2) return;    // allready added
+
+    if(state.at(i) == 1)
+    {
+        cout << endl << "###  Runtime Error  ###" << endl
+             << "The pipe network contains a loop..." << endl
+             << "PIPE: " << pipe(i)->number() << endl << endl;
+
+        exit(1);
+    }
+
+    state.replace(i, 1);
+
+    PipeNode node;
+    node.pipe = pipe(i);
+
+    // finding the type of pipe, and the connections to the pipes it flows into
+    QVector<PipeConnection*> outlets;
+
+    MidPipe *p_mid = dynamic_cast<MidPipe*>(pipe(i));
+    Separator *p_sep = dynamic_cast<Separator*>(pipe(i));
+    PressureBooster *p_boost = dynamic_cast<PressureBooster*>(pipe(i));
+
+    if(p_mid != 0)
+    {
+        node.type = PipeNode::MIDPIPE;
+        for(int k = 0; k < p_mid->numberOfOutletConnections(); ++k) outlets.push_back(p_mid->outletConnection(k));
+    }
+    else if(p_sep != 0)
+    {
+        node.type = PipeNode::SEPARATOR;
+        outlets.push_back(p_sep->outletConnection());
+    }
+    else if(p_boost != 0)
+    {
+        node.type = PipeNode::BOOSTER;
+        outlets.push_back(p_boost->outletConnection());
+    }
+    else node.type = PipeNode::ENDPIPE;
+
+
+    // adding the pipes this pipe flows into first
+    for(int k = 0; k < outlets.size(); ++k) addPipeNode(m_pipes.indexOf(outlets.at(k)->pipe()), state);
+
+
+    // then adding this pipe
+    node.first_outlet = m_pipe_outlets.size();
+    node.number_of_outlets = outlets.size();
+
+    for(int k = 0; k < outlets.size(); ++k)
+    {
+        m_pipe_outlets.push_back(pipeNodeIndex(outlets.at(k)->pipe()));
+        m_pipe_outlet_connections.push_back(outlets.at(k));
+    }
+
+    m_pipe_node_index.insert(node.pipe, m_pipe_nodes.size());
+    m_pipe_nodes.push_back(node);
+
+    state.replace(i, 2);
+}
+
 
 //-----------------------------------------------------------------------------------------------
 // Calculates the pressures in all the pipes
@@ -486,17 +567,19 @@ bool Model::calculatePipePressures()
 {
     bool ok = true;
 
-    // finding the endnodes
-    QVector<EndPipe*> end_pipes;
-
-    for(int i = 0; i < numberOfPipes(); i++)
+    // checking that there are end nodes in the network
+    bool found_end = false;
+    for(int i = 0; i < m_pipe_nodes.size(); ++i)
     {
-        EndPipe *p = dynamic_cast<EndPipe*>(pipe(i));   // trying to cast as EndPipe
-        if(p != 0) end_pipes.push_back(p);              // adding if cast was ok
+        if(m_pipe_nodes.at(i).type == PipeNode::ENDPIPE)
+        {
+            found_end = true;
+            break;
+        }
     }
 
     // if no endpipes were found, return error
-    if(end_pipes.size() == 0)
+    if(!found_end)
     {
         cout << endl << "### Warning ###" << endl
              << "From: Model" << endl
@@ -507,16 +590,8 @@ bool Model::calculatePipePressures()
     }
     else    // found end pipes, getting on with the calculations...
     {
-        // looping through the end nodes
-        for(int i = 0; i < end_pipes.size(); i++)
-        {
-            // finding the connected wells for this branch
-            //end_pipes.at(i)->findConnectedWells();
-
-            // calculating the inlet pressures for the end pipes, and the branch of pipes connected
-            end_pipes.at(i)->calculateBranchInletPressures();
-        }
-
+        // the nodes are ordered so that the outlet pressures of each pipe are calculated before the pipe is reached
+        for(int i = 0; i < m_pipe_nodes.size(); ++i) m_pipe_nodes.at(i).pipe->calculateInletPressure();
     }
 
 
@@ -532,6 +607,9 @@ bool Model::resolveCapacityConnections()
     cout << "Resolving capacity - pipe connections..." << endl;
     bool ok = true;
 
+    // making sure the registry is up to date with the components
+    buildRegistry();
+
     for(int i = 0; i < m_capacities.size(); i++)        // looping through all separators
     {
         Capacity *s = m_capacities.at(i);
@@ -541,15 +619,12 @@ bool Model::resolveCapacityConnections()
             int pipe_num = s->feedPipeNumber(j);
             bool pipe_ok = false;
 
-            for(int k = 0; k < m_pipes.size(); k++)     // looping through pipes to find the correct one
+            Pipe *p = pipeByNumber(pipe_num);   // finding the correct pipe
+            if(p != 0)
             {
-                if(m_pipes.at(k)->number() == pipe_num) // this is the correct pipe
-                {
-                    s->addFeedPipe(m_pipes.at(k));
+                s->addFeedPipe(p);
 
-                    pipe_ok = true;
-                    break;
-                }
+                pipe_ok = true;
             }
 
             // checking if the pipe number was found
@@ -571,16 +646,40 @@ bool Model::resolveCapacityConnections()
 }
 
 //-----------------------------------------------------------------------------------------------
-// returns the well with the given id
+// builds the registry of wells and pipes
 //-----------------------------------------------------------------------------------------------
-Well* Model::wellById(int comp_id)
+void Model::buildRegistry()
 {
-    for(int i = 0; i < numberOfWells(); ++i)
+    m_well_index_by_id.clear();
+    m_well_index_by_name.clear();
+    m_pipe_index_by_number.clear();
+
+    // going backwards, so that the first component wins if an id, name, or number is used more than once
+    for(int i = numberOfWells() - 1; i >= 0; --i)
     {
-        if(well(i)->id() == comp_id) return well(i);
+        m_well_index_by_id.insert(well(i)->id(), i);
+        m_well_index_by_name.insert(well(i)->name(), i);
     }
 
-    return 0;
+    for(int i = numberOfPipes() - 1; i >= 0; --i)
+    {
+        m_pipe_index_by_number.insert(pipe(i)->number(), i);
+    }
+
+    m_registered_wells = numberOfWells();
+    m_registered_pipes = numberOfPipes();
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the well with the given id
+//-----------------------------------------------------------------------------------------------
+Well* Model::wellById(int comp_id)
+{
+    checkRegistry();
+
+    int i = m_well_index_by_id.value(comp_id, -1);
+
+    return (i < 0) ? 0 : well(i);
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -588,12 +687,51 @@ Well* Model::wellById(int comp_id)
 //-----------------------------------------------------------------------------------------------
 Well* Model::wellByName(const QString &name)
 {
-    for(int i = 0; i < numberOfWells(); ++i)
+    checkRegistry();
+
+    int i = m_well_index_by_name.value(name, -1);
+
+    return (i < 0) ? 0 : well(i);
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the pipe with the given number
+//-----------------------------------------------------------------------------------------------
+Pipe* Model::pipeByNumber(int number)
+{
+    checkRegistry();
+
+    int i = m_pipe_index_by_number.value(number, -1);
+
+    return (i < 0) ? 0 : pipe(i);
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the real variables belonging to a component
+//-----------------------------------------------------------------------------------------------
+QVector<shared_ptr<RealVariable> > Model::registeredRealVariables(Component *c)
+{
+    QVector<shared_ptr<RealVariable> > &vars = realVariables();
+
+    // building the registry if it is out of date
+    if(m_registered_real_vars != vars.size())
     {
-        if(well(i)->name().compare(name) == 0) return well(i);
+        m_real_vars_by_component.clear();
+
+        for(int i = 0; i < vars.size(); ++i) m_real_vars_by_component[vars.at(i)->parent()->id()].push_back(i);
+
+        m_registered_real_vars = vars.size();
     }
 
-    return 0;
+    QVector<shared_ptr<RealVariable> > comp_vars;
+
+    QHash<int, QVector<int> >::const_iterator it = m_real_vars_by_component.constFind(c->id());
+    if(it != m_real_vars_by_component.constEnd())
+    {
+        for(int i = 0; i < it.value().size(); ++i) comp_vars.push_back(vars.at(it.value().at(i)));
+    }
+
+    return comp_vars;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -735,8 +873,6 @@ void Model::readPipeFiles()
 //-----------------------------------------------------------------------------------------------
 void Model::updateObjectiveValue()
 {
-    QVector<Stream*> field_rates;
-
     // finding the end pipes
     QVector<EndPipe*> p_end_pipes;
     for(int i = 0; i < numberOfPipes(); ++i)
@@ -745,10 +881,13 @@ void Model::updateObjectiveValue()
         if(p != 0) p_end_pipes.push_back(p);
     }
 
-    // adding together the streams from all the end pipes
+    // adding together the streams from all the end pipes, the field rates are kept between calls to avoid reallocation
+    if(m_field_rates.size() != masterSchedule().size()) m_field_rates.setup(masterSchedule());
+
     for(int i = 0; i < masterSchedule().size(); ++i)
     {
-        Stream *s = new Stream();
+        Stream *s = m_field_rates.at(i);
+        *s = Stream();
 
         // looping through the end pipes
         for(int j = 0; j < p_end_pipes.size(); ++j)
@@ -758,8 +897,6 @@ void Model::updateObjectiveValue()
             //cout << "Rates used for objective value:" <<endl;
             //s->printToCout();
         }
-
-        field_rates.push_back(s);
     }
 
 
@@ -861,12 +998,9 @@ void Model::updateObjectiveValue()
 
 
     // calculating the new objective value
-    objective()->calculateValue(field_rates, costs_sorted);
+    objective()->calculateValue(m_field_rates.pointers(), costs_sorted);
 
    // cout << "Objective value = " << objective()->value() << endl;
-
-    // deleting the generated streams
-    for(int i = 0; i < field_rates.size(); i++) delete field_rates.at(i);
 }
 
 
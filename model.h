@@ -23,8 +23,11 @@
 
 #include <QString>
 #include <QVector>
+#include <QHash>
 #include <tr1/memory>
 
+#include "streamseries.h"
+
 using std::tr1::shared_ptr;
 
 
@@ -48,6 +51,7 @@ class Component;
 class UserConstraint;
 class Cost;
 class Logger;
+class PipeConnection;
 
 
 /**
@@ -57,6 +61,23 @@ class Logger;
  */
 class Model
 {
+public:
+
+    /**
+     * @brief A Pipe in the compiled pipe network.
+     * @details The outlets of the node are the entries first_outlet to first_outlet + number_of_outlets - 1 in the outlet vector
+     *          of the network. They are given as indices in the node vector, together with the connection to each outlet.
+     */
+    struct PipeNode
+    {
+        enum PipeType{MIDPIPE, ENDPIPE, SEPARATOR, BOOSTER};
+
+        Pipe *pipe;
+        PipeType type;
+        int first_outlet;
+        int number_of_outlets;
+    };
+
 private:
     Reservoir *p_reservoir; /**< TODO */
     QVector<Well*> m_wells; /**< TODO */
@@ -73,6 +94,22 @@ private:
 
     Logger *p_logger;
 
+    QVector<PipeNode> m_pipe_nodes;                 // the pipes ordered so that each pipe comes after all the pipes it flows into
+    QVector<int> m_pipe_outlets;                    // the node indices of the outlets for all the nodes
+    QVector<PipeConnection*> m_pipe_outlet_connections; // the connections to the outlets for all the nodes
+    QHash<const Pipe*, int> m_pipe_node_index;      // the node index for each pipe
+
+    StreamSeries m_field_rates;                     // the total rates from the end pipes, used by updateObjectiveValue()
+
+    QHash<int, int> m_well_index_by_id;             // registry of the components, index in m_wells or m_pipes, built by buildRegistry()
+    QHash<QString, int> m_well_index_by_name;
+    QHash<int, int> m_pipe_index_by_number;
+    int m_registered_wells;                         // number of wells and pipes when the registry was built
+    int m_registered_pipes;
+
+    QHash<int, QVector<int> > m_real_vars_by_component; // index in realVariables() of the variables belonging to each component id
+    int m_registered_real_vars;                     // size of realVariables() when m_real_vars_by_component was built, -1 if out of date
+
 
 
 
@@ -116,6 +153,48 @@ private:
     QVector<Cost*> sortCosts(QVector<Cost*> c);
 
 
+    /**
+     * @brief Sets up the compiled pipe network from the current connections between the pipes.
+     * @details The pipes are stored as a flat vector of PipeNode, ordered so that the outlet pressure of each pipe is known when it is
+     *          reached. This is called by resolvePipeRouting(), so the network does not have to be discovered for every evaluation.
+     *
+     */
+    void compilePipeNetwork();
+
+    /**
+     * @brief Adds pipe i and all the pipes it flows into to the compiled network, downstream first.
+     *
+     * @param i index of the pipe in m_pipes
+     * @param state 0 = not visited, 1 = being visited, 2 = added
+     */
+    void addPipeNode(int i, QVector<int> &state);
+
+
+    /**
+     * @brief Rebuilds the component registry if wells or pipes have been added since it was built.
+     *
+     */
+    void checkRegistry() {if(m_registered_wells != m_wells.size() || m_registered_pipes != m_pipes.size()) buildRegistry();}
+
+
+protected:
+
+    /**
+     * @brief Returns the real variables belonging to a component, looked up in the variable registry.
+     * @details The registry is built from realVariables() the first time, and again if the number of variables has changed or
+     *          invalidateVariableRegistry() has been called. Used by the implementations of realVariables(Component*).
+     *
+     * @param c
+     * @return QVector<shared_ptr<RealVariable> >
+     */
+    QVector<shared_ptr<RealVariable> > registeredRealVariables(Component *c);
+
+    /**
+     * @brief Marks the variable registry as out of date, should be called when the list of real variables is rebuilt.
+     *
+     */
+    void invalidateVariableRegistry() {m_registered_real_vars = -1;}
+
 
 public:
     Model();
@@ -264,6 +343,7 @@ public:
 
     /**
      * @brief Calculates the pressure drops in all the pipes
+     * @details The inlet pressures are calculated in one sweep through the compiled pipe network, starting at the end pipes.
      *
      * @return bool
      */
@@ -397,6 +477,22 @@ public:
     Well* wellById(int comp_id);
     Well* wellByName(const QString &name);
 
+    /**
+     * @brief Returns the Pipe with the specified NUMBER from the driver file, 0 if not found
+     *
+     * @param number
+     * @return Pipe
+     */
+    Pipe* pipeByNumber(int number);
+
+    /**
+     * @brief Builds the registry that maps well ids, well names, and pipe numbers to the wells and pipes.
+     * @details This is called when the model is copied and before the connections are resolved, and otherwise whenever wells or pipes
+     *          have been added, so the lookup functions are always up to date.
+     *
+     */
+    void buildRegistry();
+
     /**
      * @brief Returns Pipe number i
      *
@@ -412,6 +508,48 @@ public:
      */
     int numberOfPipes() const {return m_pipes.size();}
 
+    /**
+     * @brief Returns node i in the compiled pipe network
+     * @details The nodes are ordered so that each pipe comes after all the pipes it flows into.
+     *
+     * @param i
+     * @return const PipeNode
+     */
+    const PipeNode& pipeNode(int i) const {return m_pipe_nodes.at(i);}
+
+    /**
+     * @brief Returns the number of nodes in the compiled pipe network
+     *
+     * @return int
+     */
+    int numberOfPipeNodes() const {return m_pipe_nodes.size();}
+
+    /**
+     * @brief Returns the node index in the compiled pipe network of the Pipe p, -1 if not found
+     *
+     * @param p
+     * @return int
+     */
+    int pipeNodeIndex(const Pipe *p) const {return m_pipe_node_index.value(p, -1);}
+
+    /**
+     * @brief Returns the node index of outlet k for the node
+     *
+     * @param node
+     * @param k
+     * @return int
+     */
+    int pipeNodeOutlet(const PipeNode &node, int k) const {return m_pipe_outlets.at(node.first_outlet + k);}
+
+    /**
+     * @brief Returns the connection to outlet k for the node
+     *
+     * @param node
+     * @param k
+     * @return PipeConnection
+     */
+    PipeConnection* pipeNodeOutletConnection(const PipeNode &node, int k) const {return m_pipe_outlet_connections.at(node.first_outlet + k);}
+
 
     /**
      * @brief Returns Capacity number i
@@ -66,6 +66,7 @@
 #include "opt/lshoptimizer.h"
 #include "opt/nomadipoptoptimizer.h"
 #include "opt/eroptoptimizer.h"
+#include "opt/evolutionarystrategyoptimizer.h"
 
 #include "gprssimulator.h"
 #include "vlpsimulator.h"
@@ -204,6 +205,16 @@ Model* ModelReader::readDriverFile(Runner *r)
             //cout << "model reader path: " << m_path.toLatin1().constData() << endl;
             r->setDebugFileName(m_path + "/" + list.at(1));                                    // setting the debug file
         }
+        else if(list.at(0).startsWith("CACHE"))
+        {
+            r->setCacheFile(m_path + "/" + list.at(1));                                        // setting the evaluation cache file
+        }
+        else if(list.at(0).startsWith("CHECKPOINT"))
+        {
+            // file name, and optionally the number of seconds between checkpoints
+            if(list.size() > 2) r->setCheckpointFile(m_path + "/" + list.at(1), list.at(2).toInt());
+            else r->setCheckpointFile(m_path + "/" + list.at(1));
+        }
         else if(list.at(0).startsWith("SIMULATOR"))     // reading the type of reservoir simulator to use
         {
             if(list.at(1).startsWith("GPRS")) r->setReservoirSimulator(new GprsSimulator());
@@ -218,6 +229,9 @@ Model* ModelReader::readDriverFile(Runner *r)
 
                 exit(1);
             }
+
+            // optional wall-clock limit for each simulator run, in seconds
+            if(list.size() > 2) r->reservoirSimulator()->setTimeout(list.at(2).toInt());
         }
 
         else
@@ -356,6 +370,7 @@ Reservoir* ModelReader::readReservoir()
         else if(list.at(0).startsWith("MATLAB")) res->setMatlabPath(list.at(1));        // setting the Matlab path
         else if(list.at(0).startsWith("SCRIPT")) res->setMrstScript(list.at(1));        // setting a custom MRST script
         else if(list.at(0).startsWith("KEEP_MAT_FILE")) res->setKeepMatFile(true);      // setting that the .mat file should not be deleted between runs
+        else if(list.at(0).startsWith("RESIDENT_MATLAB")) res->setResidentMatlab(true); // setting that MATLAB should be kept running between runs
         else if(list.at(0).startsWith("TIME")) l_endtime = list.at(1).toDouble(&ok);    // getting the file name
         else if(list.at(0).startsWith("PHASES"))                                        // getting the phases present in the reservoir
         {
@@ -2863,6 +2878,7 @@ void ModelReader::readOptimizer(Runner *r)
     double l_term = 0.0;
     int l_term_start = 5;
     bool l_startingpoint_update = false;
+    GradientEngine::scheme l_gradient_scheme = GradientEngine::FORWARD;
 
     QList<int> l_eropt_steps;
 
@@ -2884,12 +2900,27 @@ void ModelReader::readOptimizer(Runner *r)
             else if(list.at(1).startsWith("LSH")) o = new LshOptimizer(r);
             else if(list.at(1).startsWith("NOIP")) o = new NomadIpoptOptimizer(r);
             else if(list.at(1).startsWith("EROPT")) o = new EroptOptimizer(r);
+            else if(list.at(1).startsWith("EVOLUTIONARY")) o = new EvolutionaryStrategyOptimizer(r);
 
         }
         else if(list.at(0).startsWith("ITERATIONS")) l_max_iter = list.at(1).toInt(&ok);    // getting the max number if iterations
         else if(list.at(0).startsWith("CONT_ITER")) l_max_iter_cont = list.at(1).toInt(&ok); // getting the max number if iterations for the contienous solver
         else if(list.at(0).startsWith("PERTURB")) l_perturb = list.at(1).toDouble(&ok);     // getting the perturbation size
         else if(list.at(0).startsWith("STARTINGPOINT_UPDATE")) l_startingpoint_update = true;     // using the starting-point from the best sub-problem
+        else if(list.at(0).startsWith("GRADIENT"))                                          // getting the finite difference scheme
+        {
+            if(list.size() < 2) ok = false;
+            else if(list.at(1).startsWith("FORWARD")) l_gradient_scheme = GradientEngine::FORWARD;
+            else if(list.at(1).startsWith("CENTRAL")) l_gradient_scheme = GradientEngine::CENTRAL;
+            else if(list.at(1).startsWith("ADAPTIVE")) l_gradient_scheme = GradientEngine::ADAPTIVE;
+            else
+            {
+                cout << endl << "### Error detected in input file! ###" << endl
+                     << "GRADIENT type not recognized: " << list.at(1).toLatin1().constData() << endl
+                     << "Possible types: FORWARD, CENTRAL, ADAPTIVE" << endl << endl;
+                exit(1);
+            }
+        }
         else if(list.at(0).startsWith("TERMINATION"))                                       // getting the termination options
         {
             l_term = list.at(1).toDouble(&ok);
@@ -2967,6 +2998,7 @@ void ModelReader::readOptimizer(Runner *r)
     o->setParallelRuns(l_parallel_runs);
     o->setPerturbationSize(l_perturb);
     o->setStartingpointUpdate(l_startingpoint_update);
+    o->setGradientScheme(l_gradient_scheme);
     o->setTermination(l_term);
     o->setTerminationStart(l_term_start);
 
@@ -205,6 +205,8 @@ public:
 
     const QString& driverFilePath() {return m_path;}
 
+    const QString& driverFileName() const {return m_driver_file_name;}
+
 
 };
 
@@ -43,6 +43,7 @@
 #include "adjointcollection.h"
 #include "wellpath.h"
 #include "logger.h"
+#include "simulatorprocess.h"
 
 namespace ResOpt
 {
@@ -54,7 +55,9 @@ using std::endl;
 MrstBatchSimulator::MrstBatchSimulator() :
     m_first_launch(true),
     run_number(1),
-    m_script("test2")
+    m_script("test2"),
+    m_resident(false),
+    p_matlab(0)
 {
 }
 
@@ -62,12 +65,16 @@ MrstBatchSimulator::MrstBatchSimulator(const MrstBatchSimulator &m)
     : ReservoirSimulator(m),
       m_first_launch(true),
       run_number(1),
-      m_script("test2")
+      m_script("test2"),
+      m_resident(false),
+      p_matlab(0)
 {
 }
 
 MrstBatchSimulator::~MrstBatchSimulator()
-{}
+{
+    if(p_matlab != 0) delete p_matlab;
+}
 
 
 
@@ -924,6 +931,7 @@ bool MrstBatchSimulator::generateInputFiles(Model *m)
         // extracting the matlab path from the model
         // the model is not available when the simulator is launched
         m_matlab_path = m->reservoir()->matlabPath();
+        m_resident = m->reservoir()->residentMatlab();
 
         // removing old version of the .mat file
         if(m->reservoir()->keepMatFile())
@@ -1023,6 +1031,8 @@ bool MrstBatchSimulator::generateInputFiles(Model *m)
 //-----------------------------------------------------------------------------------------------
 bool MrstBatchSimulator::launchSimulator()
 {
+    if(m_resident) return launchResident();
+
     bool ok = true;
 
     QProcess mrst;
@@ -1065,7 +1075,7 @@ bool MrstBatchSimulator::launchSimulator()
   //  cout << "MRST is running..." << endl;
 
 
-    mrst.waitForFinished(-1);
+    if(!waitForProcess(&mrst)) return false;
 
     // checking the exit code
 
@@ -1084,6 +1094,49 @@ bool MrstBatchSimulator::launchSimulator()
 
 
 
+    return exit_code == 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+// runs the MRST script in the resident MATLAB
+//-----------------------------------------------------------------------------------------------
+bool MrstBatchSimulator::launchResident()
+{
+    // the working directory is fixed when MATLAB is started
+    if(p_matlab != 0 && p_matlab->workingDirectory() != folder())
+    {
+        delete p_matlab;
+        p_matlab = 0;
+    }
+
+    if(p_matlab == 0)
+    {
+        QStringList args;
+        args.push_back("-nojvm");
+        args.push_back("-nosplash");
+        args.push_back("-nodesktop");
+
+        p_matlab = new SimulatorProcess(m_matlab_path, args);
+        p_matlab->setWorkingDirectory(folder());
+        p_matlab->setExitCommand("exit");
+    }
+
+    if(!p_matlab->isRunning())
+    {
+        cout << "Starting resident MATLAB..." << endl;
+        if(!p_matlab->start()) return false;
+    }
+
+    cout << "Launching MRST in resident MATLAB..." << endl;
+
+    // clearing the workspace variables from the last run, compiled functions are kept so that MATLAB stays warm between the runs
+    // errors in the script are caught, the control script ends MATLAB with exit(3) if the simulation fails
+    QString command = "clearvars; cd('" + folder() + "'); try, " + m_script + "; disp('RESOPT_DONE 0'); catch err, disp('RESOPT_DONE 1'); end";
+
+    int exit_code = p_matlab->run(command, "RESOPT_DONE", this);
+
+    cout << "MRST finished with exit code = " << exit_code << endl;
+
     return exit_code == 0;
 }
 
@@ -1178,12 +1231,9 @@ bool MrstBatchSimulator::readStandardOutput(Model *m)
             pres = 1e-5 * pres;
 
 
-            Stream *s = new Stream(m->masterScheduleTime(i), q_oil, q_gas, q_wat, pres);
-
-            s->setInputUnits(Stream::METRIC);
-
-            // setting it to the well
-            if(!w->setStream(i, s))
+            // setting it to the well, updating the stream in place
+            if(i < w->numberOfStreams()) w->streamSeries().set(i, m->masterScheduleTime(i), q_oil, q_gas, q_wat, pres, Stream::METRIC);
+            else
             {
                 cout << endl << "###  Runtime Error  ###" << endl
                      << "Well: " << w->name().toLatin1().constData() << endl
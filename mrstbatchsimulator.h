@@ -34,11 +34,15 @@ namespace ResOpt
 class Well;
 class WellControl;
 class AdjointsCoupledModel;
+class SimulatorProcess;
 
 
 /**
  * @brief Interface for MRST in batch model.
- * @details
+ * @details By default a new MATLAB process is started for every run. With the RESIDENT_MATLAB keyword in the RESERVOIR section,
+ *          MATLAB is started once for each simulator, and kept running between the runs (see SimulatorProcess). The MRST script
+ *          is then sent to the running MATLAB for each run. The examples/MRST/resident_worker.sh script can be given as the MATLAB
+ *          path to try out the resident mode without MATLAB.
  *
  */
 class MrstBatchSimulator : public ReservoirSimulator
@@ -49,6 +53,10 @@ private:
     int run_number;
     QString m_matlab_path;
     QString m_script;
+    bool m_resident;
+    SimulatorProcess *p_matlab;     // the resident MATLAB, started by the first launch
+
+    bool launchResident();
 
     bool generateControlInputFile(Model *m);
     bool generateScriptControlFile(Model *m);
@@ -76,7 +84,7 @@ public:
 
     virtual ReservoirSimulator* clone() const {return new MrstBatchSimulator(*this);}
 
-    virtual QString description() const {return QString("SIMULATOR MRST_BATCH\n\n");}
+    virtual QString description() const {return QString("SIMULATOR MRST_BATCH") + (timeout() > 0 ? " " + QString::number(timeout()) : QString()) + "\n\n";}
 
     virtual bool generateInputFiles(Model *m);
     virtual bool launchSimulator();
@@ -34,6 +34,8 @@
 #include "objective.h"
 #include "case.h"
 #include "casequeue.h"
+#include "gradientengine.h"
+#include "jacobianstructure.h"
 
 
 
@@ -47,19 +49,33 @@ namespace ResOpt
 BonminInterface::BonminInterface(BonminOptimizer *o)
     : p_optimizer(o),
       p_case_last(0),
-      p_case_gradients(0)
+      p_case_gradients(0),
+      p_gradients(0),
+      p_jac_structure(0)
 
 {
     m_vars_binary = p_optimizer->runner()->model()->binaryVariables();
     m_vars_real = p_optimizer->runner()->model()->realVariables();
     m_vars_integer = p_optimizer->runner()->model()->integerVariables();
     m_cons = p_optimizer->runner()->model()->constraints();
+
+    // setting up the gradient engine
+    p_gradients = new GradientEngine(p_optimizer);
+    p_gradients->setVariables(m_vars_real, m_vars_binary, m_vars_integer);
+    p_gradients->setScheme(p_optimizer->gradientScheme());
+
+    // finding the non-zero entries of the jacobian, only these are calculated
+    p_jac_structure = new JacobianStructure();
+    p_jac_structure->analyze(p_optimizer->runner()->model(), m_cons, m_vars_real, m_vars_binary, m_vars_integer);
+    p_gradients->setStructure(p_jac_structure->structure(), p_jac_structure->objectiveStructure());
 }
 
 BonminInterface::~BonminInterface()
 {
     if(p_case_last != 0) delete p_case_last;
     if(p_case_gradients != 0) delete p_case_gradients;
+    if(p_gradients != 0) delete p_gradients;
+    if(p_jac_structure != 0) delete p_jac_structure;
 
 }
 
@@ -162,13 +178,14 @@ bool BonminInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
     n = m_vars_binary.size() + m_vars_real.size() + m_vars_integer.size();     // number of variables
     m = m_cons.size();                              // number of constraints
 
-    nnz_jac_g = m*n;        // dense Jacobian
-    nnz_h_lag = n*(n+1)/2;  // dense, symmetric Hessian
+    nnz_jac_g = p_jac_structure->numberOfNonZeros();    // sparse Jacobian
+    nnz_h_lag = n*(n+1)/2;                              // dense, symmetric Hessian
 
     index_style = TNLP::C_STYLE;    // c style numbering, starting at 0
 
     cout << "Number of variables   = " << n << endl;
     cout << "Number of constraints = " << m << endl;
+    cout << "Non-zeros in Jacobian = " << nnz_jac_g << " of " << m*n << endl;
 
 
     return true;
@@ -326,7 +343,7 @@ bool BonminInterface::eval_grad_f(Index n, const Number* x, bool new_x, Number*
     if(!gradientsAreUpdated(n,x))
     {
         cout << "need to calculate new gradients..." << endl;
-        calculateGradients(n,x);
+        if(!calculateGradients(n,x)) return false;
         cout << "done calculating new gradients..." << endl;
     }
 
@@ -398,16 +415,10 @@ bool BonminInterface::eval_jac_g(Index n, const Number* x, bool new_x,
     {
         cout << "Giving bonmin the structure of the jacobian..." << endl;
 
-        int entry = 0;
-        for ( int col = 0; col < n; col++ )
+        for(int i = 0; i < nele_jac; ++i)
         {
-            for ( int row = 0; row < m; row++)
-            {
-                iRow[entry] = row;
-                jCol[entry] = col;
-
-                entry++;
-            }
+            iRow[i] = p_jac_structure->row(i);
+            jCol[i] = p_jac_structure->column(i);
         }
     }
     else    // the structure is already set, getting the values
@@ -417,13 +428,13 @@ bool BonminInterface::eval_jac_g(Index n, const Number* x, bool new_x,
         // checking if gradients are calculated
         if(!gradientsAreUpdated(n,x))
         {
-            calculateGradients(n,x);
+            if(!calculateGradients(n,x)) return false;
         }
 
-        // copying gradients to BonMin
+        // copying the non-zero gradients to BonMin
         for(int i = 0; i < nele_jac; i++)
         {
-            values[i] = m_jac_g.at(i);
+            values[i] = p_gradients->constraintJacobian(p_jac_structure->column(i), p_jac_structure->row(i));
         }
 
 
@@ -553,37 +564,10 @@ bool BonminInterface::newVariableValues(Index n, const Number *x)
     return x_new;
 }
 
-//-----------------------------------------------------------------------------------------------
-// Calculates the perturbated value  a variable
-//-----------------------------------------------------------------------------------------------
-double BonminInterface::perturbedVariableValue(double value, double max, double min)
-{
-    double x_perturbed;
-
-    double span = max - min;
-    double l_slack = value - min;
-    double u_slack = max - value;
-
-    if(u_slack >= l_slack)
-    {
-        x_perturbed = value + p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed > max) x_perturbed = max;
-    }
-    else
-    {
-        x_perturbed = value - p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed < min) x_perturbed = min;
-    }
-
-    return x_perturbed;
-
-}
-
-
 //-----------------------------------------------------------------------------------------------
 // Calculates the gradients
 //-----------------------------------------------------------------------------------------------
-void BonminInterface::calculateGradients(Index n, const Number *x)
+bool BonminInterface::calculateGradients(Index n, const Number *x)
 {
     cout << "CalculateGradients() start" << endl;
 
@@ -591,9 +575,6 @@ void BonminInterface::calculateGradients(Index n, const Number *x)
     int n_grad = m_vars_binary.size() + m_vars_real.size() + m_vars_integer.size();
     if(m_grad_f.size() != n_grad) m_grad_f = QVector<double>(n_grad);
 
-    int n_jac = (m_vars_binary.size() + m_vars_real.size() + m_vars_integer.size())*m_cons.size();
-    if(m_jac_g.size() != n_jac) m_jac_g = QVector<double>(n_jac);
-
 
     // checking if these are new variable values
     if(newVariableValues(n, x))
@@ -627,166 +608,26 @@ void BonminInterface::calculateGradients(Index n, const Number *x)
     if(p_case_gradients != 0) delete p_case_gradients;
     p_case_gradients = new Case(*p_case_last, true);
 
-    cout << "CalculateGradients() starting setting up perturbations" << endl;
-
-    // setting up the case queue with all the perturbations
-    CaseQueue *case_queue = new CaseQueue();
-
-    // adding the real variable perturbations
-    for(int i = 0; i < m_vars_real.size(); ++i)
-    {
-        // calculating the perturbed value of the variable
-        double x_perturbed = perturbedVariableValue(p_case_gradients->realVariableValue(i), m_vars_real.at(i)->max(), m_vars_real.at(i)->min());
-
-        // setting up a new case
-        Case *case_perturbed = new Case(*p_case_gradients);
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setRealVariableValue(i, x_perturbed);
-
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
-    }
-
-    // adding the binary variable perturbations
-    for(int i = 0; i < m_vars_binary.size(); ++i)
-    {
-        // calculating the perturbed value of the variable
-        double x_perturbed = perturbedVariableValue(p_case_gradients->binaryVariableValue(i), m_vars_binary.at(i)->max(), m_vars_binary.at(i)->min());
-
-        // setting up a new case
-        Case *case_perturbed = new Case(*p_case_gradients);
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setBinaryVariableValue(i, x_perturbed);
-
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
-    }
-
-    // adding the integer variable perturbations
-    for(int i = 0; i < m_vars_integer.size(); ++i)
-    {
-        // calculating the perturbed value of the variable
-        int u_slack = m_vars_integer.at(i)->max() - m_vars_integer.at(i)->value();
-        int l_slack = m_vars_integer.at(i)->value() - m_vars_integer.at(i)->min();
-
-        int x_perturbed = (u_slack > l_slack) ? m_vars_integer.at(i)->value() + 1 : m_vars_integer.at(i)->value() -1;
-
-
-        // setting up a new case
-        Case *case_perturbed = new Case(*p_case_gradients);
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setIntegerVariableValue(i, x_perturbed);
-
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
-    }
-
-
-
-    // sending the cases to the runner for evaluation
-    p_optimizer->runCases(case_queue);
-
-
-
-    int n_var = 0;
-
-    // calculating the gradients of the real variables
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // calculating the gradients by perturbation
+    if(!p_gradients->calculate(p_case_gradients))
     {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->realVariableValue(i) - case_queue->at(n_var)->realVariableValue(i);
-
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(n_var)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
-        m_grad_f.replace(n_var, dfdx);
-
-
-        // calculating the gradients of the constraints
-        int entry = n_var*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
-        {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(n_var)->constraintValue(j)) / dx;
-            m_jac_g.replace(entry, dcdx);
-            ++entry;
-
-
-        }
-
-
-        ++n_var;
-    }
-
-    // calculating the gradients of the binary variables
-    for(int i = 0; i < p_case_gradients->numberOfBinaryVariables(); ++i)
-    {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->binaryVariableValue(i) - case_queue->at(n_var)->binaryVariableValue(i);
-
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(n_var)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
-        m_grad_f.replace(n_var, dfdx);
-
+        // the solver is told that the point can not be evaluated, the gradients are calculated again if it asks for them
+        delete p_case_gradients;
+        p_case_gradients = 0;
 
-        // calculating the gradients of the constraints
-        int entry = n_var*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
-        {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(n_var)->constraintValue(j)) / dx;
-            m_jac_g.replace(entry, dcdx);
-            ++entry;
-
-
-        }
-
-
-        ++n_var;
+        return false;
     }
 
-    // calculating the gradients of the integer variables
-    for(int i = 0; i < p_case_gradients->numberOfIntegerVariables(); ++i)
+    // copying the objective gradients, ordered as real, binary, integer variables (the jacobian is read directly from the engine)
+    for(int i = 0; i < n_grad; ++i)
     {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->integerVariableValue(i) - case_queue->at(n_var)->integerVariableValue(i);
-
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(n_var)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
-        m_grad_f.replace(n_var, dfdx);
-
-
-        // calculating the gradients of the constraints
-        int entry = n_var*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
-        {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(n_var)->constraintValue(j)) / dx;
-            m_jac_g.replace(entry, dcdx);
-            ++entry;
-
-
-        }
-
-
-        ++n_var;
+        // the objective gradient (negative since Bonmin is doing minimization)
+        m_grad_f.replace(i, -p_gradients->objectiveGradient(i));
     }
 
-    cout << "CalculateGradients() cleanup" << endl;
-
-    // deleting the perturbed cases
-    for(int i = 0; i < case_queue->size(); ++i) delete case_queue->at(i);
-    delete case_queue;
-
     cout << "CalculateGradients() end" << endl;
 
-
-
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -43,6 +43,8 @@ class Constraint;
 class BonminOptimizer;
 class Case;
 class CaseQueue;
+class GradientEngine;
+class JacobianStructure;
 
 
 /**
@@ -61,9 +63,10 @@ private:
     QVector<shared_ptr<Constraint> > m_cons;
 
     QVector<double> m_grad_f;   // calculated values for df/dx
-    QVector<double> m_jac_g;    // calculated values for dc/dx
     Case *p_case_last;          // the last case that was run
     Case *p_case_gradients;     // case containing variable values where the gradient and jacobian was calculated
+    GradientEngine *p_gradients;
+    JacobianStructure *p_jac_structure; // the non-zero entries of dc/dx
 
     /**
      * @brief Generates a Case based on the values in x.
@@ -81,8 +84,7 @@ private:
      * @return bool
      */
     bool newVariableValues(Index n, const Number *x);
-    double perturbedVariableValue(double value, double max, double min);
-    void calculateGradients(Index n, const Number *x);
+    bool calculateGradients(Index n, const Number *x);
     bool gradientsAreUpdated(Index n, const Number *x);
 
 public:
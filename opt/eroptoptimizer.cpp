@@ -33,6 +33,7 @@
 
 #include <QTextStream>
 #include <QDir>
+#include <QDataStream>
 
 #include <tr1/memory>
 #include <iostream>
@@ -160,6 +161,8 @@ void EroptOptimizer::start()
             result = solve(result_base_case, 0, &converged, m_steps.at(i));
             result_base_case = result;
 
+            // the sub-problems of the iteration are all solved, checkpointing the run
+            iterationFinished();
 
         }
     }
@@ -400,13 +403,54 @@ QString EroptOptimizer::description() const
     str.append(" ITERATIONS " + QString::number(maxIterations()) + "\n");
     str.append(" CONT_ITER " + QString::number(maxIterContineous()) + "\n");
     str.append(" PERTURBATION " + QString::number(pertrurbationSize()) + "\n");
+    str.append(" GRADIENT " + GradientEngine::schemeName(gradientScheme()) + "\n");
     str.append(" PARALLELRUNS " + QString::number(parallelRuns()) + "\n");
     str.append(" TERMINATION " + QString::number(termination()) + " " + QString::number(terminationStart()) + "\n");
     str.append("END OPTIMIZER\n\n");
     return str;
 }
 
+//-----------------------------------------------------------------------------------------------
+// returns the state of the optimizer for a checkpoint
+//-----------------------------------------------------------------------------------------------
+QByteArray EroptOptimizer::saveState()
+{
+    QByteArray state;
+    QDataStream out(&state, QIODevice::WriteOnly);
+
+    // the prefered move directions
+    QVector<qint32> directions;
+    for(int i = 0; i < m_directions.size(); ++i) directions.push_back(m_directions.at(i));
+    out << directions;
+
+    // the solved sub-problems
+    p_evaluator->writeState(out);
+
+    return state;
+}
+
+//-----------------------------------------------------------------------------------------------
+// restores the state of the optimizer from a checkpoint
+//-----------------------------------------------------------------------------------------------
+bool EroptOptimizer::restoreState(const QByteArray &state)
+{
+    QDataStream in(state);
+
+    QVector<qint32> directions;
+    in >> directions;
+
+    if(in.status() != QDataStream::Ok) return false;
+
+    if(!p_evaluator->readState(in)) return false;
 
+    // the directions are only used if the problem has not changed
+    if(directions.size() == m_directions.size())
+    {
+        for(int i = 0; i < directions.size(); ++i) m_directions[i] = (directions.at(i) == UP) ? UP : DOWN;
+    }
+
+    return true;
+}
 
 
 
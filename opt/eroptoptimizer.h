@@ -71,6 +71,12 @@ public:
 
     virtual QString description() const;
 
+    virtual QByteArray saveState();
+
+    virtual bool restoreState(const QByteArray &state);
+
+    virtual bool marksIterations() const {return true;}
+
 
     // set functions
     void setSteps(QList<int> &steps) {m_steps = steps;}
@@ -6,11 +6,19 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <iostream>
+
 #include "case.h"
+#include "casequeue.h"
 #include "model.h"
 #include "runner.h"
 #include "realvariable.h"
 #include "binaryvariable.h"
+#include "intvariable.h"
+#include "constraint.h"
+
+using std::cout;
+using std::endl;
 
 namespace ResOpt
 {
@@ -26,6 +34,12 @@ EvolutionaryStrategyOptimizer::EvolutionaryStrategyOptimizer(Runner *r)
 {
 }
 
+EvolutionaryStrategyOptimizer::~EvolutionaryStrategyOptimizer()
+{
+    for(int i = 0; i < m_parents.size(); ++i) delete m_parents.at(i);
+    for(int i = 0; i < m_children.size(); ++i) delete m_children.at(i);
+}
+
 
 
 //-----------------------------------------------------------------------------------------------
@@ -33,6 +47,10 @@ EvolutionaryStrategyOptimizer::EvolutionaryStrategyOptimizer(Runner *r)
 //-----------------------------------------------------------------------------------------------
 void EvolutionaryStrategyOptimizer::initialize()
 {
+    srand(time(NULL));
+
+    // one generation should keep all the launchers busy
+    if(parallelRuns() > n_children) n_children = parallelRuns();
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -40,13 +58,167 @@ void EvolutionaryStrategyOptimizer::initialize()
 //-----------------------------------------------------------------------------------------------
 void EvolutionaryStrategyOptimizer::start()
 {
+    cout << "Starting the Evolutionary Strategy optimizer..." << endl;
+
+    // the first generation: the starting point, and random cases, as many as in the following generations
+    m_children.push_back(new Case(runner()->model()));
+    while(m_children.size() < n_children) m_children.push_back(randomChild());
+
+    evaluateChildren();
+    selectParents();
+
+    bool destabilize = false;
+
+    for(int gen = 1; gen <= maxIterations(); ++gen)
+    {
+        cout << "ES: generation " << gen << ", best objective = " << m_parents.first()->objectiveValue() << endl;
+
+        // the parents may be deleted by selectParents(), keeping a copy of the best one
+        Case best_before(*m_parents.first(), true);
+
+        getChildren(destabilize);
+        evaluateChildren();
+        selectParents();
+
+        // the children did not beat the best parent, spreading out the search for the next generation
+        destabilize = !isBetter(m_parents.first(), &best_before);
+    }
+
+    // sending the best case to the runner (the runner keeps its own copy, the parents are deleted with the optimizer)
+    sendBestCaseToRunner(m_parents.first());
+
+    // letting the runner know that the optimization has finished
+    emit finished();
+
+    cout << "Optimization finished..." << endl;
 }
 
 //-----------------------------------------------------------------------------------------------
-// starts the optimization
+// makes the children of the next generation
+//-----------------------------------------------------------------------------------------------
+void EvolutionaryStrategyOptimizer::getChildren(bool destabilize)
+{
+    for(int i = 0; i < n_children; ++i)
+    {
+        Case *a = m_parents.at(rand() % m_parents.size());
+        Case *b = m_parents.at(rand() % m_parents.size());
+
+        Case *c = recombine(a, b);
+
+        // only half the children are destabilized, so the neighbourhood of the parents is still searched
+        mutate(c, destabilize && (i % 2 == 1));
+
+        m_children.push_back(c);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// evaluates all the children in parallel
+//-----------------------------------------------------------------------------------------------
+void EvolutionaryStrategyOptimizer::evaluateChildren()
+{
+    CaseQueue *queue = new CaseQueue();
+
+    for(int i = 0; i < m_children.size(); ++i) queue->push_back(m_children.at(i));
+
+    runCases(queue);
+
+    delete queue;
+}
+
 //-----------------------------------------------------------------------------------------------
-void EvolutionaryStrategyOptimizer::getChildren()
+// selects the best cases as parents for the next generation
+//-----------------------------------------------------------------------------------------------
+void EvolutionaryStrategyOptimizer::selectParents()
 {
+    QVector<Case*> pool = m_children;
+    m_children.clear();
+
+    // the old parents compete with the children, unless there are too few children to replace them
+    if(consider_past || pool.size() < n_parents) pool += m_parents;
+    else
+    {
+        for(int i = 0; i < m_parents.size(); ++i) delete m_parents.at(i);
+    }
+
+    m_parents.clear();
+
+    // picking the best cases, in order
+    while(m_parents.size() < n_parents && !pool.isEmpty())
+    {
+        int i_best = 0;
+        for(int i = 1; i < pool.size(); ++i)
+        {
+            if(isBetter(pool.at(i), pool.at(i_best))) i_best = i;
+        }
+
+        m_parents.push_back(pool.at(i_best));
+        pool.remove(i_best);
+    }
+
+    for(int i = 0; i < pool.size(); ++i) delete pool.at(i);
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the total violation of the constraints
+//-----------------------------------------------------------------------------------------------
+double EvolutionaryStrategyOptimizer::constraintViolation(Case *c)
+{
+    if(c->isFailed()) return HUGE_VAL;
+
+    double violation = 0.0;
+
+    for(int i = 0; i < c->numberOfConstraints() && i < runner()->model()->constraints().size(); ++i)
+    {
+        double max = runner()->model()->constraints().at(i)->max();
+        double min = runner()->model()->constraints().at(i)->min();
+
+        if(c->constraintValue(i) > max) violation += c->constraintValue(i) - max;
+        else if(c->constraintValue(i) < min) violation += min - c->constraintValue(i);
+    }
+
+    return violation;
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks if a case is better than another
+//-----------------------------------------------------------------------------------------------
+bool EvolutionaryStrategyOptimizer::isBetter(Case *c, Case *other)
+{
+    bool feasible = runner()->isFeasible(c);
+    bool feasible_other = runner()->isFeasible(other);
+
+    if(feasible && feasible_other) return c->objectiveValue() > other->objectiveValue();
+    else if(feasible != feasible_other) return feasible;
+    else return constraintViolation(c) < constraintViolation(other);
+}
+
+//-----------------------------------------------------------------------------------------------
+// makes a new case from two parents
+//-----------------------------------------------------------------------------------------------
+Case* EvolutionaryStrategyOptimizer::recombine(Case *a, Case *b)
+{
+    Case *c = new Case(*a);
+
+    // the real variables are a weighted average of the parents
+    for(int i = 0; i < c->numberOfRealVariables(); ++i)
+    {
+        double w = 0.0 + 1.0*rand() / RAND_MAX;
+        c->setRealVariableValue(i, w*a->realVariableValue(i) + (1.0 - w)*b->realVariableValue(i));
+    }
+
+    // the binary and integer variables are taken from one of the parents
+    for(int i = 0; i < c->numberOfBinaryVariables(); ++i)
+    {
+        if(rand() % 2 == 1) c->setBinaryVariableValue(i, b->binaryVariableValue(i));
+    }
+
+    for(int i = 0; i < c->numberOfIntegerVariables(); ++i)
+    {
+        if(rand() % 2 == 1) c->setIntegerVariableValue(i, b->integerVariableValue(i));
+    }
+
+    return c;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -77,6 +249,15 @@ Case* EvolutionaryStrategyOptimizer::randomChild()
         c->addBinaryVariableValue(v);
     }
 
+    // creating random values of the integer variables
+    for(int i = 0; i < runner()->model()->integerVariables().size(); ++i)
+    {
+        int min = runner()->model()->integerVariables().at(i)->min();
+        int max = runner()->model()->integerVariables().at(i)->max();
+
+        c->addIntegerVariableValue(min + rand() % (max - min + 1));
+    }
+
 
     return c;
 
@@ -112,11 +293,23 @@ void EvolutionaryStrategyOptimizer::mutate(Case *c, bool destabilize)
         c->setRealVariableValue(i, var_val);
     }
 
-    // mutating binary variables
+    // mutating binary variables, a step smaller than the range can never flip a binary, so each one is flipped with the range as the probability
     for(int i = 0; i < runner()->model()->binaryVariables().size(); ++i)
     {
-        double b_upper = 1;
-        double b_lower = 0;
+        double u = 1.0*rand()/RAND_MAX;
+
+        bool on = c->binaryVariableValue(i) > 0.5;
+
+        if(u < range) on = !on;
+
+        c->setBinaryVariableValue(i, on ? 1 : 0);
+    }
+
+    // mutating integer variables
+    for(int i = 0; i < runner()->model()->integerVariables().size(); ++i)
+    {
+        double b_upper = runner()->model()->integerVariables().at(i)->max();
+        double b_lower = runner()->model()->integerVariables().at(i)->min();
 
         double u = 0.0 + 1.0*rand()/RAND_MAX;
         double s = -1.0 + 2.0*rand()/RAND_MAX;
@@ -125,13 +318,28 @@ void EvolutionaryStrategyOptimizer::mutate(Case *c, bool destabilize)
 
         double mut_mult = s*x*a;	//total mutation multiplier
 
-        double var_val = c->binaryVariableValue(i) + mut_mult;
+        int var_val = static_cast<int>(floor(c->integerVariableValue(i) + mut_mult + 0.5));
 
+        if(var_val < b_lower) var_val = b_lower;
+        if(var_val > b_upper) var_val = b_upper;
 
-        c->setBinaryVariableValue(i, (var_val > 0.5) ? 1 : 0);
+        c->setIntegerVariableValue(i, var_val);
     }
 
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// generates a description for driver file
+//-----------------------------------------------------------------------------------------------
+QString EvolutionaryStrategyOptimizer::description() const
+{
+    QString str("START OPTIMIZER\n");
+    str.append(" TYPE EVOLUTIONARY \n");
+    str.append(" ITERATIONS " + QString::number(maxIterations()) + "\n");
+    str.append(" PARALLELRUNS " + QString::number(parallelRuns()) + "\n");
+    str.append("END OPTIMIZER\n\n");
+    return str;
+}
+
 } // namespace ResOpt
@@ -10,6 +10,19 @@ namespace ResOpt
 class Runner;
 class Case;
 
+/**
+ * @brief Evolutionary strategy optimizer.
+ * @details Each generation, n_children cases are made from the parents by recombination and mutation. The whole generation is sent to the
+ *          Runner as one batch, so that the children are evaluated in parallel by the Launchers. The number of children is at least the number
+ *          of PARALLELRUNS. The n_parents best cases are kept as the parents of the next generation, selected among both the parents and the
+ *          children when consider_past is set (plus selection), or among the children only. If a generation does not improve on the best
+ *          parent, half of the next children are mutated with the larger destabilizing range.
+ *          Binary variables are flipped with the mutation range (or the destabilizing range) as the probability.
+ *
+ *          Feasible cases are always better than infeasible ones, infeasible cases are ranked by the total constraint violation.
+ *          ITERATIONS is the number of generations.
+ *
+ */
 class EvolutionaryStrategyOptimizer : public Optimizer
 {
 private:
@@ -24,17 +37,36 @@ private:
     QVector<Case*> m_children;
 
     void mutate(Case *c, bool destabilize = false);
-    void getChildren();
+    void getChildren(bool destabilize = false);
     Case* randomChild();
+    Case* recombine(Case *a, Case *b);
+
+    /**
+     * @brief Evaluates the children as one batch.
+     *
+     */
+    void evaluateChildren();
+
+    /**
+     * @brief Selects the parents of the next generation. The cases that are not selected are deleted.
+     *
+     */
+    void selectParents();
+
+    double constraintViolation(Case *c);
+    bool isBetter(Case *c, Case *other);
 
 
 public:
     EvolutionaryStrategyOptimizer(Runner *r);
+    virtual ~EvolutionaryStrategyOptimizer();
 
     virtual void initialize();
 
     virtual void start();
 
+    virtual QString description() const;
+
 };
 
 } // namespace ResOpt
@@ -0,0 +1,582 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+
+#include "gradientengine.h"
+
+#include <math.h>
+#include <iostream>
+
+#include "optimizer.h"
+#include "case.h"
+#include "casequeue.h"
+#include "casepool.h"
+#include "realvariable.h"
+#include "binaryvariable.h"
+#include "intvariable.h"
+#include "jacobianstructure.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// limits for the relative step size used by the ADAPTIVE scheme
+static const double ADAPTIVE_STEP_MIN = 1e-8;
+static const double ADAPTIVE_STEP_MAX = 0.1;
+
+// relative change in the outputs above which the ADAPTIVE scheme reduces the step size
+static const double ADAPTIVE_LARGE_CHANGE = 0.1;
+
+
+GradientEngine::GradientEngine(Optimizer *o)
+    : p_optimizer(o),
+      m_scheme(FORWARD),
+      m_number_of_constraints(0),
+      m_number_of_perturbations(0),
+      p_case_pool(new CasePool())
+{
+}
+
+GradientEngine::~GradientEngine()
+{
+    delete p_case_pool;
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the variables to perturb
+//-----------------------------------------------------------------------------------------------
+void GradientEngine::setVariables(const QVector<shared_ptr<RealVariable> > &real,
+                                  const QVector<shared_ptr<BinaryVariable> > &binary,
+                                  const QVector<shared_ptr<IntVariable> > &integer)
+{
+    m_vars_real = real;
+    m_vars_binary = binary;
+    m_vars_integer = integer;
+
+    m_jac_structure.clear();
+    m_obj_structure.clear();
+    m_step.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the structure of the derivatives
+//-----------------------------------------------------------------------------------------------
+void GradientEngine::setStructure(const QVector<bool> &jac_structure, const QVector<bool> &obj_structure)
+{
+    m_jac_structure = jac_structure;
+    m_obj_structure = obj_structure;
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks if a variable can affect any of the outputs
+//-----------------------------------------------------------------------------------------------
+bool GradientEngine::affectsOutput(int var, int n_cons) const
+{
+    if(m_obj_structure.isEmpty() || m_obj_structure.at(var)) return true;
+    if(m_jac_structure.isEmpty()) return true;
+
+    for(int j = 0; j < n_cons; ++j)
+    {
+        if(m_jac_structure.at(var * n_cons + j)) return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the value of one of the variables in a case
+//-----------------------------------------------------------------------------------------------
+void GradientEngine::setVariableValue(Case *c, int var, double x)
+{
+    if(var < m_vars_real.size()) c->setRealVariableValue(var, x);
+    else if(var < m_vars_real.size() + m_vars_binary.size()) c->setBinaryVariableValue(var - m_vars_real.size(), x);
+    else c->setIntegerVariableValue(var - m_vars_real.size() - m_vars_binary.size(), static_cast<int>(x));
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the value of one of the variables in a case
+//-----------------------------------------------------------------------------------------------
+double GradientEngine::variableValue(Case *c, int var) const
+{
+    if(var < m_vars_real.size()) return c->realVariableValue(var);
+    else if(var < m_vars_real.size() + m_vars_binary.size()) return c->binaryVariableValue(var - m_vars_real.size());
+    else return c->integerVariableValue(var - m_vars_real.size() - m_vars_binary.size());
+}
+
+//-----------------------------------------------------------------------------------------------
+// runs the failed cases in a queue once more
+//-----------------------------------------------------------------------------------------------
+void GradientEngine::rerunFailed(CaseQueue *cases)
+{
+    CaseQueue *retry_queue = new CaseQueue();
+    QVector<int> index;
+
+    for(int i = 0; i < cases->size(); ++i)
+    {
+        if(!cases->at(i)->isFailed()) continue;
+
+        retry_queue->push_back(p_case_pool->newCase(*cases->at(i)));
+        index.push_back(i);
+    }
+
+    if(retry_queue->size() > 0)
+    {
+        cout << "Running " << retry_queue->size() << " failed perturbations again..." << endl;
+
+        p_optimizer->runCases(retry_queue);
+        m_number_of_perturbations += retry_queue->size();
+
+        for(int i = 0; i < index.size(); ++i) cases->at(index.at(i))->copyFrom(*retry_queue->at(i), true);
+    }
+
+    p_case_pool->release(retry_queue);
+    delete retry_queue;
+}
+
+//-----------------------------------------------------------------------------------------------
+// replaces a failed point of a variable by the base case, or by a perturbation in the opposite direction
+//-----------------------------------------------------------------------------------------------
+bool GradientEngine::replaceFailed(Case *base_case, int var, CaseQueue *case_queue, CaseQueue *fallback_queue,
+                                   int &i_low, int &i_high, double &x_low, double &x_high, double x_up_alt, double x_down_alt)
+{
+    bool low_failed = i_low >= 0 && case_queue->at(i_low)->isFailed();
+    bool high_failed = i_high >= 0 && case_queue->at(i_high)->isFailed();
+
+    if(!low_failed && !high_failed) return true;
+
+    double x0 = variableValue(base_case, var);
+
+    if(low_failed && high_failed) return false;
+
+    // central difference, falling back to a one sided difference with the point that did not fail
+    else if(high_failed && i_low >= 0)
+    {
+        x_high = x0;
+        i_high = -1;
+    }
+    else if(low_failed && i_high >= 0)
+    {
+        x_low = x0;
+        i_low = -1;
+    }
+
+    // one sided difference, perturbing in the opposite direction
+    else
+    {
+        double x_alt = high_failed ? x_down_alt : x_up_alt;
+
+        if(x_alt == x0) return false;    // at the bound, there is no room in the opposite direction
+
+        Case *c = p_case_pool->newCase(*base_case);
+        setVariableValue(c, var, x_alt);
+
+        int i_alt = case_queue->size();
+        case_queue->push_back(c);
+        fallback_queue->push_back(c);
+
+        if(high_failed)
+        {
+            i_high = -1;
+            x_high = x0;
+            i_low = i_alt;
+            x_low = x_alt;
+        }
+        else
+        {
+            i_low = -1;
+            x_low = x0;
+            i_high = i_alt;
+            x_high = x_alt;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// calculates the gradients at the base case
+//-----------------------------------------------------------------------------------------------
+bool GradientEngine::calculate(Case *base_case)
+{
+    int n_real = m_vars_real.size();
+    int n_binary = m_vars_binary.size();
+    int n = numberOfVariables();
+    int n_cons = base_case->numberOfConstraints();
+
+    m_number_of_constraints = n_cons;
+    m_number_of_perturbations = 0;
+    m_grad_f.fill(0.0, n);
+    m_jac_g.fill(0.0, n * n_cons);
+
+    if(m_step.size() != n) m_step.fill(p_optimizer->pertrurbationSize(), n);
+
+    // there is nothing to take the differences from
+    if(base_case->isFailed())
+    {
+        cout << "The base case failed, the derivatives can not be calculated..." << endl;
+        return false;
+    }
+
+
+    // the points used for each variable, index in the queue (-1 for the base case) and variable value
+    QVector<int> i_low(n, -1);
+    QVector<int> i_high(n, -1);
+    QVector<double> x_low(n);
+    QVector<double> x_high(n);
+
+    // the points used for the objective by the variables that are perturbed on their own for it (see own_obj below)
+    QVector<int> o_low(n, -1);
+    QVector<int> o_high(n, -1);
+    QVector<double> xo_low(n);
+    QVector<double> xo_high(n);
+
+    // the perturbed values for each variable, equal to the base value if not perturbed in that direction
+    QVector<double> x_up(n);
+    QVector<double> x_down(n);
+
+    // the perturbed values in the direction that was not chosen, used if a perturbation fails
+    QVector<double> x_up_alt(n);
+    QVector<double> x_down_alt(n);
+
+    QVector<int> perturbed;     // the variables that can affect the outputs
+
+    for(int k = 0; k < n; ++k)
+    {
+        double x0;
+        double max;
+        double min;
+        bool integer = false;
+
+        if(k < n_real)
+        {
+            x0 = base_case->realVariableValue(k);
+            max = m_vars_real.at(k)->max();
+            min = m_vars_real.at(k)->min();
+        }
+        else if(k < n_real + n_binary)
+        {
+            x0 = base_case->binaryVariableValue(k - n_real);
+            max = m_vars_binary.at(k - n_real)->max();
+            min = m_vars_binary.at(k - n_real)->min();
+        }
+        else
+        {
+            x0 = base_case->integerVariableValue(k - n_real - n_binary);
+            max = m_vars_integer.at(k - n_real - n_binary)->max();
+            min = m_vars_integer.at(k - n_real - n_binary)->min();
+            integer = true;
+        }
+
+        x_low[k] = x0;
+        x_high[k] = x0;
+        xo_low[k] = x0;
+        xo_high[k] = x0;
+        x_up[k] = x0;
+        x_down[k] = x0;
+        x_up_alt[k] = x0;
+        x_down_alt[k] = x0;
+
+        if(!affectsOutput(k, n_cons)) continue;
+
+        perturbed.push_back(k);
+
+        // the perturbed values, within the bounds
+        double h = integer ? 1.0 : m_step.at(k) * (max - min);
+
+        double up = x0 + h;
+        if(up > max) up = max;
+
+        double down = x0 - h;
+        if(down < min) down = min;
+
+
+        // finding the directions to perturb in
+        bool use_up;
+        bool use_down;
+
+        if(m_scheme == CENTRAL)
+        {
+            use_up = true;
+            use_down = true;
+        }
+        else    // towards the bound with the most slack
+        {
+            use_up = integer ? (max - x0 > x0 - min) : (max - x0 >= x0 - min);
+            use_down = !use_up;
+        }
+
+        if(use_up) x_up[k] = up;
+        else x_up_alt[k] = up;
+
+        if(use_down) x_down[k] = down;
+        else x_down_alt[k] = down;
+    }
+
+
+    // setting up the case queue, the variables in a group are perturbed together. The groups are found from the constraints only, the
+    // objective may depend on every variable and would otherwise give one group per variable
+    CaseQueue *case_queue = new CaseQueue();
+
+    QVector<QVector<int> > groups = JacobianStructure::groupColumns(perturbed, n_cons, m_jac_structure, QVector<bool>(n, false));
+
+    QVector<int> group_of(n, -1);       // the group of each perturbed variable
+    QVector<bool> own_obj(n, false);    // true if the variable is perturbed on its own for the objective
+
+    for(int g = 0; g < groups.size(); ++g)
+    {
+        int i_up = -1;      // index in the queue of the cases for this group
+        int i_down = -1;
+
+        bool obj_from_group = false;    // true when one of the variables already gets its objective derivative from the group cases
+
+        for(int i = 0; i < groups.at(g).size(); ++i)
+        {
+            int k = groups.at(g).at(i);
+            group_of[k] = g;
+
+            if(x_up.at(k) != x_high.at(k))
+            {
+                if(i_up < 0)
+                {
+                    i_up = case_queue->size();
+                    case_queue->push_back(p_case_pool->newCase(*base_case));
+                }
+
+                setVariableValue(case_queue->at(i_up), k, x_up.at(k));
+                i_high[k] = i_up;
+                x_high[k] = x_up.at(k);
+            }
+
+            if(x_down.at(k) != x_low.at(k))
+            {
+                if(i_down < 0)
+                {
+                    i_down = case_queue->size();
+                    case_queue->push_back(p_case_pool->newCase(*base_case));
+                }
+
+                setVariableValue(case_queue->at(i_down), k, x_down.at(k));
+                i_low[k] = i_down;
+                x_low[k] = x_down.at(k);
+            }
+
+            // the objective derivative of the first variable that affects the objective is taken from the group cases, with the
+            // contributions from the others subtracted. The others are perturbed on their own for the objective
+            if(!m_obj_structure.isEmpty() && !m_obj_structure.at(k)) continue;
+
+            if(!obj_from_group)
+            {
+                obj_from_group = true;
+                continue;
+            }
+
+            own_obj[k] = true;
+
+            if(x_up.at(k) != xo_high.at(k))
+            {
+                o_high[k] = case_queue->size();
+                case_queue->push_back(p_case_pool->newCase(*base_case));
+                setVariableValue(case_queue->at(o_high.at(k)), k, x_up.at(k));
+                xo_high[k] = x_up.at(k);
+            }
+
+            if(x_down.at(k) != xo_low.at(k))
+            {
+                o_low[k] = case_queue->size();
+                case_queue->push_back(p_case_pool->newCase(*base_case));
+                setVariableValue(case_queue->at(o_low.at(k)), k, x_down.at(k));
+                xo_low[k] = x_down.at(k);
+            }
+        }
+    }
+
+    m_number_of_perturbations = case_queue->size();
+
+
+    // sending all the perturbations to the runner as one batch
+    if(case_queue->size() > 0) p_optimizer->runCases(case_queue);
+
+    // the failure may be temporary (e.g. a timeout), the failed perturbations are run once more
+    rerunFailed(case_queue);
+
+
+    // the variables with a failed perturbation use the base case in its place. If the base case is already the other point, the
+    // variable is perturbed in the opposite direction instead
+    bool ok = true;
+    CaseQueue *fallback_queue = new CaseQueue();
+
+    for(int i = 0; i < perturbed.size(); ++i)
+    {
+        int k = perturbed.at(i);
+
+        if(!replaceFailed(base_case, k, case_queue, fallback_queue, i_low[k], i_high[k], x_low[k], x_high[k], x_up_alt.at(k), x_down_alt.at(k))) ok = false;
+
+        if(own_obj.at(k) && !replaceFailed(base_case, k, case_queue, fallback_queue, o_low[k], o_high[k], xo_low[k], xo_high[k], x_up_alt.at(k), x_down_alt.at(k))) ok = false;
+    }
+
+    if(ok && fallback_queue->size() > 0)
+    {
+        cout << "Perturbing " << fallback_queue->size() << " variables in the opposite direction..." << endl;
+
+        p_optimizer->runCases(fallback_queue);
+        m_number_of_perturbations += fallback_queue->size();
+
+        for(int i = 0; i < fallback_queue->size(); ++i)
+        {
+            if(fallback_queue->at(i)->isFailed()) ok = false;
+        }
+    }
+
+    delete fallback_queue;  // the cases are also in the case queue
+
+
+    // the solver is told that the derivatives could not be evaluated at this point
+    if(!ok)
+    {
+        cout << "Perturbations failed in both directions, the derivatives can not be calculated..." << endl;
+
+        p_case_pool->release(case_queue);
+        delete case_queue;
+
+        return false;
+    }
+
+
+    // calculating the derivatives
+    for(int k = 0; k < n; ++k)
+    {
+        if(i_low.at(k) < 0 && i_high.at(k) < 0) continue;   // not perturbed
+
+        Case *c_low = (i_low.at(k) < 0) ? base_case : case_queue->at(i_low.at(k));
+        Case *c_high = (i_high.at(k) < 0) ? base_case : case_queue->at(i_high.at(k));
+
+        double dx = x_high.at(k) - x_low.at(k);
+
+        // the objective of the variables that are perturbed on their own for it, the others are found from the group cases below
+        Case *c_obj = (c_high == base_case) ? c_low : c_high;
+
+        if(own_obj.at(k))
+        {
+            Case *co_low = (o_low.at(k) < 0) ? base_case : case_queue->at(o_low.at(k));
+            Case *co_high = (o_high.at(k) < 0) ? base_case : case_queue->at(o_high.at(k));
+
+            m_grad_f[k] = (co_high->objectiveValue() - co_low->objectiveValue()) / (xo_high.at(k) - xo_low.at(k));
+            c_obj = (co_high == base_case) ? co_low : co_high;
+        }
+
+        // the constraints
+        int entry = k * n_cons;
+        for(int j = 0; j < n_cons; ++j)
+        {
+            if(m_jac_structure.isEmpty() || m_jac_structure.at(entry))
+            {
+                m_jac_g[entry] = (c_high->constraintValue(j) - c_low->constraintValue(j)) / dx;
+            }
+            ++entry;
+        }
+
+        // updating the step size for the next time
+        if(m_scheme == ADAPTIVE && k < n_real + n_binary) adaptStepSize(k, base_case, (c_high == base_case) ? c_low : c_high, c_obj);
+    }
+
+    // the objective for the variables that use the group cases, the change is the sum of the changes from all the variables that affect
+    // the objective in the same cases, and the known contributions from the others are subtracted
+    for(int k = 0; k < n; ++k)
+    {
+        if(i_low.at(k) < 0 && i_high.at(k) < 0) continue;   // not perturbed
+        if(own_obj.at(k) || (!m_obj_structure.isEmpty() && !m_obj_structure.at(k))) continue;
+
+        Case *c_low = (i_low.at(k) < 0) ? base_case : case_queue->at(i_low.at(k));
+        Case *c_high = (i_high.at(k) < 0) ? base_case : case_queue->at(i_high.at(k));
+
+        double df = c_high->objectiveValue() - c_low->objectiveValue();
+
+        const QVector<int> &group = groups.at(group_of.at(k));
+        for(int i = 0; i < group.size(); ++i)
+        {
+            int o = group.at(i);
+            if(own_obj.at(o)) df -= m_grad_f.at(o) * (variableValue(c_high, o) - variableValue(c_low, o));
+        }
+
+        m_grad_f[k] = df / (x_high.at(k) - x_low.at(k));
+    }
+
+
+    // deleting the perturbed cases
+    p_case_pool->release(case_queue);
+    delete case_queue;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the driver file keyword for a scheme
+//-----------------------------------------------------------------------------------------------
+QString GradientEngine::schemeName(scheme s)
+{
+    if(s == CENTRAL) return QString("CENTRAL");
+    else if(s == ADAPTIVE) return QString("ADAPTIVE");
+    else return QString("FORWARD");
+}
+
+//-----------------------------------------------------------------------------------------------
+// adjusts the step size of a variable for the next call to calculate()
+//-----------------------------------------------------------------------------------------------
+void GradientEngine::adaptStepSize(int var, Case *base_case, Case *c, Case *c_obj)
+{
+    // finding the largest relative change in the objective and constraints that depend on the variable (other variables may be perturbed in the same case)
+    int n_cons = base_case->numberOfConstraints();
+    double change = 0.0;
+
+    if(m_obj_structure.isEmpty() || m_obj_structure.at(var))
+    {
+        change = fabs(c_obj->objectiveValue() - base_case->objectiveValue()) / (fabs(base_case->objectiveValue()) > 1.0 ? fabs(base_case->objectiveValue()) : 1.0);
+    }
+
+    for(int j = 0; j < n_cons; ++j)
+    {
+        if(!m_jac_structure.isEmpty() && !m_jac_structure.at(var * n_cons + j)) continue;
+
+        double scale = fabs(base_case->constraintValue(j)) > 1.0 ? fabs(base_case->constraintValue(j)) : 1.0;
+        double change_con = fabs(c->constraintValue(j) - base_case->constraintValue(j)) / scale;
+
+        if(change_con > change) change = change_con;
+    }
+
+    // no response, the step is too small to be seen through the model
+    if(change == 0.0)
+    {
+        m_step[var] = m_step.at(var) * 10;
+        if(m_step.at(var) > ADAPTIVE_STEP_MAX) m_step[var] = ADAPTIVE_STEP_MAX;
+    }
+
+    // large response, the step is too large for a linear approximation
+    else if(change > ADAPTIVE_LARGE_CHANGE)
+    {
+        m_step[var] = m_step.at(var) / 10;
+        if(m_step.at(var) < ADAPTIVE_STEP_MIN) m_step[var] = ADAPTIVE_STEP_MIN;
+    }
+}
+
+} // namespace ResOpt
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+
+#ifndef GRADIENTENGINE_H
+#define GRADIENTENGINE_H
+
+#include <QVector>
+#include <QString>
+#include <tr1/memory>
+
+using std::tr1::shared_ptr;
+
+namespace ResOpt
+{
+
+class Optimizer;
+class Case;
+class RealVariable;
+class BinaryVariable;
+class IntVariable;
+class CasePool;
+class CaseQueue;
+
+
+/**
+ * @brief Calculates the gradient of the objective and the Jacobian of the constraints by finite differences.
+ * @details All the perturbed cases are set up at once and sent to the Runner as a single batch, so that they are evaluated in parallel
+ *          by the Launchers. The base case is reused, and is not run again. When a structure is set, variables that do not share any constraints
+ *          are perturbed together in the same case (see JacobianStructure::groupColumns()). In each group, one of the variables that affect the
+ *          objective gets its objective derivative from the group case, with the contributions from the others subtracted, and the others are
+ *          perturbed on their own for the objective. With an objective that depends on every variable this is one case per variable, and
+ *          fewer when the objective structure excludes some of them. The variables are ordered real, binary, integer,
+ *          and the Jacobian is stored with one block of constraint derivatives per variable (entry = var * number of constraints + con).
+ *
+ *          The engine is shared by the gradient based optimizer interfaces (Bonmin, Ipopt, LSH, and the MINLP sub-problem).
+ *
+ */
+class GradientEngine
+{
+public:
+
+    /**
+     * @brief The finite difference scheme.
+     * @details FORWARD perturbs each variable towards the bound with the most slack. CENTRAL perturbs in both directions, falling back to a
+     *          one sided difference at the bounds. ADAPTIVE is a forward difference where the step size of each variable is adjusted between
+     *          calls, increased if the perturbation gave no response, and reduced if the response was large.
+     */
+    enum scheme {FORWARD, CENTRAL, ADAPTIVE};
+
+private:
+    Optimizer *p_optimizer;
+    scheme m_scheme;
+
+    QVector<shared_ptr<RealVariable> > m_vars_real;
+    QVector<shared_ptr<BinaryVariable> > m_vars_binary;
+    QVector<shared_ptr<IntVariable> > m_vars_integer;
+
+    QVector<bool> m_jac_structure;      // true if the constraint may depend on the variable, empty if dense
+    QVector<bool> m_obj_structure;      // true if the objective may depend on the variable, empty if dense
+
+    QVector<double> m_step;             // relative step size for each variable (fraction of the span)
+
+    QVector<double> m_grad_f;           // df/dx
+    QVector<double> m_jac_g;            // dc/dx
+    int m_number_of_constraints;
+    int m_number_of_perturbations;      // number of cases run by the last call to calculate()
+
+    CasePool *p_case_pool;              // perturbed cases are reused between calls to calculate()
+
+
+    /**
+     * @brief Checks if the variable can affect the objective or any of the constraints.
+     *
+     */
+    bool affectsOutput(int var, int n_cons) const;
+
+    /**
+     * @brief Sets the value of variable var in the case c.
+     *
+     */
+    void setVariableValue(Case *c, int var, double x);
+
+    /**
+     * @brief Returns the value of variable var in the case c.
+     *
+     */
+    double variableValue(Case *c, int var) const;
+
+    /**
+     * @brief Runs the cases in the queue that failed once more, and copies the new results into them.
+     *
+     */
+    void rerunFailed(CaseQueue *cases);
+
+    /**
+     * @brief Replaces a failed point of a variable by the base case, or by a perturbation in the opposite direction.
+     * @details The points are given by their index in the case queue (-1 for the base case) and variable value, and are updated in place.
+     *          A new perturbation is added to both the case queue and the fallback queue.
+     *
+     * @return bool false if both points failed, or there is no room to perturb in the opposite direction
+     */
+    bool replaceFailed(Case *base_case, int var, CaseQueue *case_queue, CaseQueue *fallback_queue,
+                       int &i_low, int &i_high, double &x_low, double &x_high, double x_up_alt, double x_down_alt);
+
+    /**
+     * @brief Adjusts the step size of a variable based on how much the outputs changed when it was perturbed. Used by ADAPTIVE.
+     * @details c is the case used for the constraints, and c_obj the case used for the objective.
+     *
+     */
+    void adaptStepSize(int var, Case *base_case, Case *c, Case *c_obj);
+
+
+public:
+    GradientEngine(Optimizer *o);
+    ~GradientEngine();
+
+    /**
+     * @brief Calculates the derivatives at the point given by base_case.
+     * @details base_case must already have been evaluated. The perturbed cases are run as one batch, and given back to the case pool afterwards.
+     *          Derivatives that are excluded by the structure set with setStructure() are set to zero.
+     *
+     *          Perturbations that fail (see Case::isFailed()) are run once more. If they still fail, the base case is used in their place
+     *          when the other side was perturbed, and otherwise the variable is perturbed in the opposite direction. When none of this
+     *          works, or the base case itself failed, false is returned, and the derivatives should not be used.
+     *
+     * @param base_case
+     * @return bool false if the derivatives could not be calculated
+     */
+    bool calculate(Case *base_case);
+
+    /**
+     * @brief Returns the driver file keyword for a finite difference scheme.
+     *
+     * @param s
+     * @return QString
+     */
+    static QString schemeName(scheme s);
+
+
+    // set functions
+
+    void setScheme(scheme s) {m_scheme = s;}
+
+    /**
+     * @brief Sets the variables that should be perturbed.
+     * @details The variables must be in the same order as in the cases that are passed to calculate(). Resets the structure and step sizes.
+     *
+     */
+    void setVariables(const QVector<shared_ptr<RealVariable> > &real,
+                      const QVector<shared_ptr<BinaryVariable> > &binary = QVector<shared_ptr<BinaryVariable> >(),
+                      const QVector<shared_ptr<IntVariable> > &integer = QVector<shared_ptr<IntVariable> >());
+
+    /**
+     * @brief Sets which derivatives can be non-zero.
+     * @details jac_structure has one entry per variable and constraint, in the same order as the Jacobian, obj_structure has one entry per
+     *          variable. An empty vector means that all the derivatives may be non-zero. Variables that can not affect the objective or any
+     *          constraint are not perturbed.
+     *
+     * @param jac_structure
+     * @param obj_structure
+     */
+    void setStructure(const QVector<bool> &jac_structure, const QVector<bool> &obj_structure = QVector<bool>());
+
+
+    // get functions
+
+    scheme gradientScheme() const {return m_scheme;}
+
+    int numberOfVariables() const {return m_vars_real.size() + m_vars_binary.size() + m_vars_integer.size();}
+    int numberOfPerturbations() const {return m_number_of_perturbations;}
+
+    const QVector<double>& objectiveGradient() const {return m_grad_f;}
+    const QVector<double>& constraintJacobian() const {return m_jac_g;}
+
+    double objectiveGradient(int var) const {return m_grad_f.at(var);}
+    double constraintJacobian(int var, int con) const {return m_jac_g.at(var * m_number_of_constraints + con);}
+
+};
+
+} // namespace ResOpt
+
+#endif // GRADIENTENGINE_H
@@ -17,6 +17,8 @@
 #include "case.h"
 #include "casequeue.h"
 #include "reservoirsimulator.h"
+#include "gradientengine.h"
+#include "jacobianstructure.h"
 
 using std::cout;
 using std::endl;
@@ -28,11 +30,23 @@ namespace ResOpt
 IpoptInterface::IpoptInterface(IpoptOptimizer *o)
     : p_optimizer(o),
       p_case_last(0),
-      p_case_gradients(0)
+      p_case_gradients(0),
+      p_gradients(0),
+      p_jac_structure(0)
 {
     m_vars = p_optimizer->runner()->model()->realVariables();
     m_cons = p_optimizer->runner()->model()->constraints();
 
+    // setting up the gradient engine
+    p_gradients = new GradientEngine(p_optimizer);
+    p_gradients->setVariables(m_vars);
+    p_gradients->setScheme(p_optimizer->gradientScheme());
+
+    // finding the non-zero entries of the jacobian, only these are calculated
+    p_jac_structure = new JacobianStructure();
+    p_jac_structure->analyze(p_optimizer->runner()->model(), m_cons, m_vars);
+    p_gradients->setStructure(p_jac_structure->structure(), p_jac_structure->objectiveStructure());
+
 
     // setting up the gradients file
     p_grad_file= new QFile(p_optimizer->runner()->reservoirSimulator()->folder() + "/ipopt_gradients.dat");
@@ -59,6 +73,8 @@ IpoptInterface::~IpoptInterface()
 {
     if(p_case_last != 0) delete p_case_last;
     if(p_case_gradients != 0) delete p_case_gradients;
+    if(p_gradients != 0) delete p_gradients;
+    if(p_jac_structure != 0) delete p_jac_structure;
 }
 
 bool IpoptInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
@@ -69,8 +85,8 @@ bool IpoptInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
     n = m_vars.size();  // number of variables
     m = m_cons.size();  // number of constraints
 
-    nnz_jac_g = m*n;        // dense Jacobian
-    nnz_h_lag = n*(n+1)/2;  // dense, symmetric Hessian
+    nnz_jac_g = p_jac_structure->numberOfNonZeros();    // sparse Jacobian
+    nnz_h_lag = n*(n+1)/2;                              // dense, symmetric Hessian
 
     // index style for row/col entries
     // index_style = FORTRAN_STYLE;
@@ -78,6 +94,7 @@ bool IpoptInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
 
     cout << "Number of variables   = " << n << endl;
     cout << "Number of constraints = " << m << endl;
+    cout << "Non-zeros in Jacobian = " << nnz_jac_g << " of " << m*n << endl;
 
     return true;
 }
@@ -183,7 +200,7 @@ bool IpoptInterface::eval_grad_f(Index n, const Number* x, bool new_x, Number* g
     if(!gradientsAreUpdated(n,x))
     {
         cout << "need to calculate new gradients..." << endl;
-        calculateGradients(n,x);
+        if(!calculateGradients(n,x)) return false;
         cout << "done calculating new gradients..." << endl;
     }
     else cout << "gradients are already calculated for this point..." << endl;
@@ -249,16 +266,10 @@ bool IpoptInterface::eval_jac_g(Index n, const Number* x, bool new_x,
     {
         cout << "Giving Ipopt the structure of the jacobian..." << endl;
 
-        int entry = 0;
-        for ( int col = 0; col < n; col++ )
+        for(int i = 0; i < nele_jac; ++i)
         {
-            for ( int row = 0; row < m; row++)
-            {
-                iRow[entry] = row;
-                jCol[entry] = col;
-
-                entry++;
-            }
+            iRow[i] = p_jac_structure->row(i);
+            jCol[i] = p_jac_structure->column(i);
         }
     }
     else    // the structure is already set, getting the values
@@ -268,13 +279,13 @@ bool IpoptInterface::eval_jac_g(Index n, const Number* x, bool new_x,
         // checking if gradients are calculated
         if(!gradientsAreUpdated(n,x))
         {
-            calculateGradients(n,x);
+            if(!calculateGradients(n,x)) return false;
         }
 
-        // copying gradients to Ipopt
+        // copying the non-zero gradients to Ipopt
         for(int i = 0; i < nele_jac; i++)
         {
-            values[i] = m_jac_g.at(i);
+            values[i] = p_gradients->constraintJacobian(p_jac_structure->column(i), p_jac_structure->row(i));
         }
     }
 
@@ -363,46 +374,16 @@ bool IpoptInterface::newVariableValues(Index n, const Number *x)
 
 }
 
-//-----------------------------------------------------------------------------------------------
-// Calculates the perturbated value a variable
-//-----------------------------------------------------------------------------------------------
-double IpoptInterface::perturbedVariableValue(double value, double max, double min)
-{
-    double x_perturbed;
-
-    double span = max - min;
-    double l_slack = value - min;
-    double u_slack = max - value;
-
-    if(u_slack >= l_slack)
-    {
-        x_perturbed = value + p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed > max) x_perturbed = max;
-    }
-    else
-    {
-        x_perturbed = value - p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed < min) x_perturbed = min;
-    }
-
-    return x_perturbed;
-
-}
-
-
 //-----------------------------------------------------------------------------------------------
 // Calculates the gradients
 //-----------------------------------------------------------------------------------------------
-void IpoptInterface::calculateGradients(Index n, const Number *x)
+bool IpoptInterface::calculateGradients(Index n, const Number *x)
 {
     cout << "Starting perturbations to calculate gradients for IPOPT" << endl;
     // checking if the gradient vectors have the correct size
     int n_grad = m_vars.size();
     if(m_grad_f.size() != n_grad) m_grad_f = QVector<double>(n_grad);
 
-    int n_jac = m_vars.size()*m_cons.size();
-    if(m_jac_g.size() != n_jac) m_jac_g = QVector<double>(n_jac);
-
 
     // checking if these are new variable values
     if(newVariableValues(n, x))
@@ -434,33 +415,16 @@ void IpoptInterface::calculateGradients(Index n, const Number *x)
     p_case_gradients = new Case(*p_case_last, true);
 
 
-    // setting up the case queue with all the perturbations
-    CaseQueue *case_queue = new CaseQueue();
-
-    // adding the real variable perturbations
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // calculating the gradients by perturbation
+    if(!p_gradients->calculate(p_case_gradients))
     {
-        // calculating the perturbed value of the variable
-        double x_perturbed = perturbedVariableValue(p_case_gradients->realVariableValue(i), m_vars.at(i)->max(), m_vars.at(i)->min());
+        // the solver is told that the point can not be evaluated, the gradients are calculated again if it asks for them
+        delete p_case_gradients;
+        p_case_gradients = 0;
 
-        cout << "x[" << i << "] perturbed = " << x_perturbed << endl;
-
-        // setting up a new case
-        Case *case_perturbed = new Case(*p_case_gradients);
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setRealVariableValue(i, x_perturbed);
-
-        // running the case
-        p_optimizer->runCase(case_perturbed);
-
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
+        return false;
     }
 
-    // sending the cases to the runner for evaluation
-    //p_optimizer->runCases(case_queue);
-
 
     // setting up the text stream for gradients info
     QTextStream out(p_grad_file);
@@ -477,64 +441,28 @@ void IpoptInterface::calculateGradients(Index n, const Number *x)
 
     out << "\n";
 
-    // calculating the gradients of the real variables
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // copying the gradients of the real variables
+    for(int i = 0; i < n_grad; ++i)
     {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->realVariableValue(i) - case_queue->at(i)->realVariableValue(i);
-
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(i)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
+        // the objective gradient (negative since Ipopt is doing minimization)
+        double dfdx = -p_gradients->objectiveGradient(i);
         m_grad_f.replace(i, dfdx);
 
         //printing var # and obj
         out << i+1 << "\t" << dfdx << "\t";
 
-
-        // calculating the gradients of the constraints
-        int entry = i*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
-        {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(i)->constraintValue(j)) / dx;
-            m_jac_g.replace(entry, dcdx);
-            ++entry;
-
-            // printing con deriv
-            out << dcdx << "\t";
-        }
-
-        out << "\n";
-
-        /*
-        // printing base case
-        out << p_case_gradients->realVariableValue(i) << " (b)\t" << p_case_gradients->objectiveValue() << "\t";
-        for(int k = 0; k < p_case_gradients->numberOfConstraints(); ++k)
+        // printing the constraint gradients
+        for(int j = 0; j < m_cons.size(); ++j)
         {
-            out << p_case_gradients->constraintValue(k) << "\t";
+            out << p_gradients->constraintJacobian(i, j) << "\t";
         }
-        out << "\n";
 
-        // printing pertrubarion
-        out << case_queue->at(i)->realVariableValue(i) << " (p)\t" << case_queue->at(i)->objectiveValue() << "\t";
-        for(int k = 0; k < case_queue->at(i)->numberOfConstraints(); ++k)
-        {
-            out << case_queue->at(i)->constraintValue(k) << "\t";
-        }
         out << "\n";
-        */
-
-
-
     }
 
-    // deleting the perturbed cases
-    for(int i = 0; i < case_queue->size(); ++i) delete case_queue->at(i);
-    delete case_queue;
-
     p_grad_file->flush();
 
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -17,6 +17,8 @@ class RealVariable;
 class Constraint;
 class Case;
 class CaseQueue;
+class GradientEngine;
+class JacobianStructure;
 
 class IpoptInterface : public TNLP
 {
@@ -29,10 +31,11 @@ private:
     QVector<shared_ptr<Constraint> > m_cons;
 
     QVector<double> m_grad_f;   // calculated values for df/dx
-    QVector<double> m_jac_g;    // calculated values for dc/dx
     Case *p_case_last;          // the last case that was run
     Case *p_case_gradients;     // case containing variable values where the gradient and jacobian was calculated
     QFile *p_grad_file;
+    GradientEngine *p_gradients;
+    JacobianStructure *p_jac_structure; // the non-zero entries of dc/dx
 
     /**
      * @brief Generates a Case based on the values in x.
@@ -51,9 +54,7 @@ private:
      */
     bool newVariableValues(Index n, const Number *x);
 
-    double perturbedVariableValue(double value, double max, double min);
-
-    void calculateGradients(Index n, const Number *x);
+    bool calculateGradients(Index n, const Number *x);
 
     bool gradientsAreUpdated(Index n, const Number *x);
 
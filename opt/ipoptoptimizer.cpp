@@ -185,6 +185,7 @@ QString IpoptOptimizer::description() const
     str.append(" ITERATIONS " + QString::number(maxIterations()) + "\n");
     str.append(" CONT_ITER " + QString::number(maxIterContineous()) + "\n");
     str.append(" PERTURBATION " + QString::number(pertrurbationSize()) + "\n");
+    str.append(" GRADIENT " + GradientEngine::schemeName(gradientScheme()) + "\n");
     str.append(" PARALLELRUNS " + QString::number(parallelRuns()) + "\n");
     str.append("END OPTIMIZER\n\n");
     return str;
@@ -0,0 +1,370 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+
+
+
+
+#include "jacobianstructure.h"
+
+#include <QHash>
+#include <iostream>
+
+#include "model.h"
+#include "well.h"
+#include "wellcontrol.h"
+#include "productionwell.h"
+#include "pipeconnection.h"
+#include "midpipe.h"
+#include "pressurebooster.h"
+#include "capacity.h"
+#include "realvariable.h"
+#include "binaryvariable.h"
+#include "intvariable.h"
+#include "constraint.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+JacobianStructure::JacobianStructure()
+{
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks that the time steps of the controls and constraints are the master schedule times
+//-----------------------------------------------------------------------------------------------
+bool JacobianStructure::scheduleAligned(Model *m)
+{
+    int n = m->numberOfMasterScheduleTimes();
+
+    if(n < 1) return false;
+
+    for(int i = 0; i < m->numberOfWells(); ++i)
+    {
+        Well *w = m->well(i);
+
+        if(w->numberOfControls() != n) return false;
+        for(int j = 0; j < n; ++j)
+        {
+            if(w->control(j)->endTime() != m->masterScheduleTime(j)) return false;
+        }
+
+        ProductionWell *prod_well = dynamic_cast<ProductionWell*>(w);
+        if(prod_well != 0)
+        {
+            if(prod_well->numberOfGasLiftControls() != 0 && prod_well->numberOfGasLiftControls() != n) return false;
+            for(int j = 0; j < prod_well->numberOfGasLiftControls(); ++j)
+            {
+                if(prod_well->gasLiftControl(j)->endTime() != m->masterScheduleTime(j)) return false;
+            }
+
+            if(prod_well->numberOfBhpConstraints() > n) return false;
+        }
+    }
+
+    for(int i = 0; i < m->numberOfPipes(); ++i)
+    {
+        PressureBooster *p_boost = dynamic_cast<PressureBooster*>(m->pipe(i));
+        if(p_boost != 0 && p_boost->capacityConstraints().size() != n) return false;
+    }
+
+    // each constrained phase must have one constraint per master schedule time
+    for(int i = 0; i < m->numberOfCapacities(); ++i)
+    {
+        Capacity *cap = m->capacity(i);
+
+        int sizes[4] = {cap->oilConstraints().size(), cap->gasConstraints().size(), cap->waterConstraints().size(), cap->liquidConstraints().size()};
+
+        for(int j = 0; j < 4; ++j)
+        {
+            if(sizes[j] != 0 && sizes[j] != n) return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// finds the structure of the jacobian
+//-----------------------------------------------------------------------------------------------
+void JacobianStructure::analyze(Model *m,
+                                const QVector<shared_ptr<Constraint> > &cons,
+                                const QVector<shared_ptr<RealVariable> > &real,
+                                const QVector<shared_ptr<BinaryVariable> > &binary,
+                                const QVector<shared_ptr<IntVariable> > &integer)
+{
+    // the time step rules below assume that the controls and constraints follow the master schedule, without them every entry is non-zero
+    bool aligned = scheduleAligned(m);
+
+    if(!aligned)
+    {
+        cout << endl << "### Warning ###" << endl
+             << "The well controls or constraints do not follow the MASTERSCHEDULE..." << endl
+             << "Using a dense Jacobian structure." << endl << endl;
+    }
+
+    QHash<Variable*, double> var_time;                      // the end time of the well control variables
+    QHash<Constraint*, double> con_time;                    // the time of the constraints that belong to a time step
+    QHash<Constraint*, QVector<Variable*> > con_routing;    // the routing variables of the routing constraints
+
+
+    // the wells: control variables, bhp constraints, and routing constraints
+    for(int i = 0; i < m->numberOfWells() && aligned; ++i)
+    {
+        Well *w = m->well(i);
+
+        for(int j = 0; j < w->numberOfControls(); ++j) var_time.insert(w->control(j)->controlVar().get(), w->control(j)->endTime());
+
+        ProductionWell *prod_well = dynamic_cast<ProductionWell*>(w);
+        if(prod_well != 0)
+        {
+            for(int j = 0; j < prod_well->numberOfGasLiftControls(); ++j)
+            {
+                var_time.insert(prod_well->gasLiftControl(j)->controlVar().get(), prod_well->gasLiftControl(j)->endTime());
+            }
+
+            for(int j = 0; j < prod_well->numberOfBhpConstraints() && j < prod_well->numberOfControls(); ++j)
+            {
+                con_time.insert(prod_well->bhpConstraint(j).get(), prod_well->control(j)->endTime());
+            }
+
+            if(prod_well->pipeConnectionConstraint() != 0)
+            {
+                QVector<Variable*> routing;
+                for(int j = 0; j < prod_well->numberOfPipeConnections(); ++j) routing.push_back(prod_well->pipeConnection(j)->variable().get());
+
+                con_routing.insert(prod_well->pipeConnectionConstraint().get(), routing);
+            }
+        }
+    }
+
+    // the pipes: routing constraints and booster capacity constraints
+    for(int i = 0; i < m->numberOfPipes() && aligned; ++i)
+    {
+        MidPipe *p_mid = dynamic_cast<MidPipe*>(m->pipe(i));
+        PressureBooster *p_boost = dynamic_cast<PressureBooster*>(m->pipe(i));
+
+        if(p_mid != 0 && p_mid->outletConnectionConstraint() != 0)
+        {
+            QVector<Variable*> routing;
+            for(int j = 0; j < p_mid->numberOfOutletConnections(); ++j) routing.push_back(p_mid->outletConnection(j)->variable().get());
+
+            con_routing.insert(p_mid->outletConnectionConstraint().get(), routing);
+        }
+        else if(p_boost != 0)
+        {
+            QVector<shared_ptr<Constraint> > c = p_boost->capacityConstraints();
+            for(int j = 0; j < c.size() && j < m->numberOfMasterScheduleTimes(); ++j) con_time.insert(c.at(j).get(), m->masterScheduleTime(j));
+        }
+    }
+
+    // the capacities, each constrained phase has one constraint per master schedule time
+    for(int i = 0; i < m->numberOfCapacities() && aligned; ++i)
+    {
+        Capacity *cap = m->capacity(i);
+
+        QVector<shared_ptr<Constraint> > c = cap->oilConstraints() + cap->gasConstraints() + cap->waterConstraints() + cap->liquidConstraints();
+
+        for(int j = 0; j < c.size(); ++j) con_time.insert(c.at(j).get(), m->masterScheduleTime(j % m->numberOfMasterScheduleTimes()));
+    }
+
+
+    // collecting the variables, ordered real, binary, integer
+    QVector<Variable*> vars;
+    vars.reserve(real.size() + binary.size() + integer.size());
+
+    for(int i = 0; i < real.size(); ++i) vars.push_back(real.at(i).get());
+    for(int i = 0; i < binary.size(); ++i) vars.push_back(binary.at(i).get());
+    for(int i = 0; i < integer.size(); ++i) vars.push_back(integer.at(i).get());
+
+
+    // every variable reaches the objective through the end pipe streams or the costs
+    m_obj_structure.fill(true, vars.size());
+
+    // setting up the structure
+    m_structure.fill(true, vars.size() * cons.size());
+    m_rows.clear();
+    m_cols.clear();
+
+    int entry = 0;
+    for(int k = 0; k < vars.size(); ++k)
+    {
+        Variable *v = vars.at(k);
+
+        for(int j = 0; j < cons.size(); ++j)
+        {
+            Constraint *c = cons.at(j).get();
+
+            if(con_routing.contains(c)) m_structure[entry] = con_routing.value(c).contains(v);
+            else if(con_time.contains(c) && var_time.contains(v)) m_structure[entry] = (var_time.value(v) <= con_time.value(c));
+
+            if(m_structure.at(entry))
+            {
+                m_rows.push_back(j);
+                m_cols.push_back(k);
+            }
+
+            ++entry;
+        }
+    }
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// groups columns that do not share any rows
+//-----------------------------------------------------------------------------------------------
+QVector<QVector<int> > JacobianStructure::groupColumns(const QVector<int> &columns, int n_rows, const QVector<bool> &jac_structure, const QVector<bool> &obj_structure)
+{
+    QVector<QVector<int> > groups;
+
+    // with a dense structure every row depends on every column
+    if(jac_structure.isEmpty() || obj_structure.isEmpty())
+    {
+        for(int i = 0; i < columns.size(); ++i) groups.push_back(QVector<int>(1, columns.at(i)));
+        return groups;
+    }
+
+
+    // counting the non-zeros in each column, the objective is row n_rows
+    QVector<int> nnz(columns.size(), 0);
+    for(int i = 0; i < columns.size(); ++i)
+    {
+        int col = columns.at(i);
+
+        for(int j = 0; j < n_rows; ++j)
+        {
+            if(jac_structure.at(col * n_rows + j)) ++nnz[i];
+        }
+        if(obj_structure.at(col)) ++nnz[i];
+    }
+
+    // ordering the columns with the most non-zeros first
+    QVector<int> order;
+    for(int i = 0; i < columns.size(); ++i)
+    {
+        int pos = 0;
+        while(pos < order.size() && nnz.at(order.at(pos)) >= nnz.at(i)) ++pos;
+        order.insert(pos, i);
+    }
+
+
+    // placing each column in the first group where none of its rows are used
+    QVector<QVector<bool> > used;   // the rows used by each group
+
+    for(int i = 0; i < order.size(); ++i)
+    {
+        int col = columns.at(order.at(i));
+
+        int g = 0;
+        for(; g < groups.size(); ++g)
+        {
+            bool conflict = obj_structure.at(col) && used.at(g).at(n_rows);
+
+            for(int j = 0; j < n_rows && !conflict; ++j)
+            {
+                if(jac_structure.at(col * n_rows + j) && used.at(g).at(j)) conflict = true;
+            }
+
+            if(!conflict) break;
+        }
+
+        // starting a new group if the column did not fit in any of the existing ones
+        if(g == groups.size())
+        {
+            groups.push_back(QVector<int>());
+            used.push_back(QVector<bool>(n_rows + 1, false));
+        }
+
+        groups[g].push_back(col);
+
+        for(int j = 0; j < n_rows; ++j)
+        {
+            if(jac_structure.at(col * n_rows + j)) used[g][j] = true;
+        }
+        if(obj_structure.at(col)) used[g][n_rows] = true;
+    }
+
+    return groups;
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks the grouping of a block-diagonal jacobian
+//-----------------------------------------------------------------------------------------------
+bool JacobianStructure::checkGrouping()
+{
+    // 4 blocks of 3 columns and 2 rows, the objective does not depend on any of the columns
+    const int n_blocks = 4;
+    const int block_cols = 3;
+    const int block_rows = 2;
+    const int n_cols = n_blocks * block_cols;
+    const int n_rows = n_blocks * block_rows;
+
+    QVector<bool> jac_structure(n_cols * n_rows, false);
+    QVector<int> columns;
+
+    for(int col = 0; col < n_cols; ++col)
+    {
+        columns.push_back(col);
+
+        int block = col / block_cols;
+        for(int j = block * block_rows; j < (block + 1) * block_rows; ++j) jac_structure[col * n_rows + j] = true;
+    }
+
+    QVector<QVector<int> > groups = groupColumns(columns, n_rows, jac_structure, QVector<bool>(n_cols, false));
+
+    // one column from each block in every group
+    if(groups.size() != block_cols) return false;
+
+    // every column must be in exactly one group, and no row may be used twice in a group
+    QVector<int> n_used(n_cols, 0);
+
+    for(int g = 0; g < groups.size(); ++g)
+    {
+        QVector<bool> used(n_rows, false);
+
+        for(int i = 0; i < groups.at(g).size(); ++i)
+        {
+            int col = groups.at(g).at(i);
+            ++n_used[col];
+
+            for(int j = 0; j < n_rows; ++j)
+            {
+                if(!jac_structure.at(col * n_rows + j)) continue;
+                if(used.at(j)) return false;
+                used[j] = true;
+            }
+        }
+    }
+
+    for(int col = 0; col < n_cols; ++col)
+    {
+        if(n_used.at(col) != 1) return false;
+    }
+
+    // a dense objective row puts every column in its own group
+    return groupColumns(columns, n_rows, jac_structure, QVector<bool>(n_cols, true)).size() == n_cols;
+}
+
+} // namespace ResOpt
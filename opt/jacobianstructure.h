@@ -0,0 +1,143 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+
+#ifndef JACOBIANSTRUCTURE_H
+#define JACOBIANSTRUCTURE_H
+
+#include <QVector>
+#include <tr1/memory>
+
+using std::tr1::shared_ptr;
+
+namespace ResOpt
+{
+
+class Model;
+class RealVariable;
+class BinaryVariable;
+class IntVariable;
+class Constraint;
+
+
+/**
+ * @brief Finds the entries in the constraint Jacobian that can be non-zero.
+ * @details The structure is found by walking through the Model. The routing constraints of wells and pipes (sum of the flow fractions)
+ *          only depend on the routing variables of the well or pipe. The constraints that belong to a time step (well BHP, booster and
+ *          capacity constraints) can not depend on well control variables for later time steps. All other constraints (e.g. user
+ *          defined) are considered to depend on all the variables. The objective is calculated from the end pipe streams and the costs,
+ *          and is also considered to depend on all the variables.
+ *
+ *          The time step rules require the well controls and the time step constraints to follow the master schedule. If they do not,
+ *          the structure is dense.
+ *
+ *          The variables are ordered real, binary, integer, and the structure uses the same layout as GradientEngine
+ *          (entry = var * number of constraints + con).
+ *
+ */
+class JacobianStructure
+{
+private:
+    QVector<bool> m_structure;      // true if the constraint may depend on the variable
+    QVector<bool> m_obj_structure;  // true if the objective may depend on the variable
+    QVector<int> m_rows;            // the constraint for each non-zero entry
+    QVector<int> m_cols;            // the variable for each non-zero entry
+
+    static bool scheduleAligned(Model *m);
+
+public:
+    JacobianStructure();
+
+    /**
+     * @brief Finds the structure of the Jacobian for the variables and constraints.
+     * @details The variables and constraints must belong to the Model m, and be in the same order as passed to the optimizer.
+     *
+     */
+    void analyze(Model *m,
+                 const QVector<shared_ptr<Constraint> > &cons,
+                 const QVector<shared_ptr<RealVariable> > &real,
+                 const QVector<shared_ptr<BinaryVariable> > &binary = QVector<shared_ptr<BinaryVariable> >(),
+                 const QVector<shared_ptr<IntVariable> > &integer = QVector<shared_ptr<IntVariable> >());
+
+
+    /**
+     * @brief Groups the columns (variables) so that no row depends on more than one column in each group.
+     * @details The columns in a group can be perturbed together in one evaluation, and the derivatives separated afterwards. The rows are the
+     *          constraints, and the objective when obj_structure says that it depends on the column. The groups are found by greedy coloring,
+     *          with the columns with the most non-zeros placed first. An empty structure is dense, giving one group per column.
+     *
+     * @param columns the columns to group
+     * @param n_rows number of constraints
+     * @param jac_structure one entry per column and constraint, entry = column * n_rows + row
+     * @param obj_structure one entry per column
+     * @return QVector<QVector<int> > the columns in each group
+     */
+    static QVector<QVector<int> > groupColumns(const QVector<int> &columns, int n_rows, const QVector<bool> &jac_structure, const QVector<bool> &obj_structure);
+
+    /**
+     * @brief Checks groupColumns() on a block-diagonal Jacobian, where each block of columns should share one group per column in the block.
+     * @details Not used during a run, it is run from the command line with ResOpt -check.
+     *
+     * @return bool true if the groups are valid, and fewer than the number of columns
+     */
+    static bool checkGrouping();
+
+
+    // get functions
+
+    /**
+     * @brief Returns the structure in the layout used by GradientEngine::setStructure().
+     *
+     * @return const QVector<bool>
+     */
+    const QVector<bool>& structure() const {return m_structure;}
+
+    /**
+     * @brief Returns the objective structure in the layout used by GradientEngine::setStructure().
+     *
+     * @return const QVector<bool>
+     */
+    const QVector<bool>& objectiveStructure() const {return m_obj_structure;}
+
+    int numberOfNonZeros() const {return m_rows.size();}
+
+    /**
+     * @brief Returns the constraint (row) of non-zero entry k.
+     *
+     * @param k
+     * @return int
+     */
+    int row(int k) const {return m_rows.at(k);}
+
+    /**
+     * @brief Returns the variable (column) of non-zero entry k.
+     *
+     * @param k
+     * @return int
+     */
+    int column(int k) const {return m_cols.at(k);}
+
+};
+
+} // namespace ResOpt
+
+#endif // JACOBIANSTRUCTURE_H
@@ -35,6 +35,7 @@
 #include "objective.h"
 #include "case.h"
 #include "casequeue.h"
+#include "gradientengine.h"
 
 using std::cout;
 using std::endl;
@@ -46,16 +47,23 @@ namespace ResOpt
 LshIpoptInterface::LshIpoptInterface(LshOptimizer *o)
     : p_optimizer(o),
       p_case_last(0),
-      p_case_gradients(0)
+      p_case_gradients(0),
+      p_gradients(0)
 {
     m_vars = p_optimizer->runner()->model()->realVariables();
     m_cons = p_optimizer->runner()->model()->constraints();
+
+    // setting up the gradient engine
+    p_gradients = new GradientEngine(p_optimizer);
+    p_gradients->setVariables(m_vars);
+    p_gradients->setScheme(p_optimizer->gradientScheme());
 }
 
 LshIpoptInterface::~LshIpoptInterface()
 {
     if(p_case_last != 0) delete p_case_last;
     if(p_case_gradients != 0) delete p_case_gradients;
+    if(p_gradients != 0) delete p_gradients;
 }
 
 bool LshIpoptInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
@@ -177,7 +185,7 @@ bool LshIpoptInterface::eval_grad_f(Index n, const Number* x, bool new_x, Number
     if(!gradientsAreUpdated(n,x))
     {
         cout << "need to calculate new gradients..." << endl;
-        calculateGradients(n,x);
+        if(!calculateGradients(n,x)) return false;
         cout << "done calculating new gradients..." << endl;
     }
 
@@ -261,7 +269,7 @@ bool LshIpoptInterface::eval_jac_g(Index n, const Number* x, bool new_x,
         // checking if gradients are calculated
         if(!gradientsAreUpdated(n,x))
         {
-            calculateGradients(n,x);
+            if(!calculateGradients(n,x)) return false;
         }
 
         // copying gradients to Ipopt
@@ -358,37 +366,10 @@ bool LshIpoptInterface::newVariableValues(Index n, const Number *x)
 
 }
 
-//-----------------------------------------------------------------------------------------------
-// Calculates the perturbated value a variable
-//-----------------------------------------------------------------------------------------------
-double LshIpoptInterface::perturbedVariableValue(double value, double max, double min)
-{
-    double x_perturbed;
-
-    double span = max - min;
-    double l_slack = value - min;
-    double u_slack = max - value;
-
-    if(u_slack >= l_slack)
-    {
-        x_perturbed = value + p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed > max) x_perturbed = max;
-    }
-    else
-    {
-        x_perturbed = value - p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed < min) x_perturbed = min;
-    }
-
-    return x_perturbed;
-
-}
-
-
 //-----------------------------------------------------------------------------------------------
 // Calculates the gradients
 //-----------------------------------------------------------------------------------------------
-void LshIpoptInterface::calculateGradients(Index n, const Number *x)
+bool LshIpoptInterface::calculateGradients(Index n, const Number *x)
 {
     // checking if the gradient vectors have the correct size
     int n_grad = m_vars.size();
@@ -428,59 +409,32 @@ void LshIpoptInterface::calculateGradients(Index n, const Number *x)
     p_case_gradients = new Case(*p_case_last, true);
 
 
-    // setting up the case queue with all the perturbations
-    CaseQueue *case_queue = new CaseQueue();
-
-    // adding the real variable perturbations
-    for(int i = 0; i < m_vars.size(); ++i)
+    // calculating the gradients by perturbation, the gradients case already holds the binary and integer variable values
+    if(!p_gradients->calculate(p_case_gradients))
     {
-        // calculating the perturbed value of the variable
-        double x_perturbed = perturbedVariableValue(p_case_gradients->realVariableValue(i), m_vars.at(i)->max(), m_vars.at(i)->min());
-
-        // setting up a new case
-        Case *case_perturbed = generateCase(n,x);;
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setRealVariableValue(i, x_perturbed);
+        // the solver is told that the point can not be evaluated, the gradients are calculated again if it asks for them
+        delete p_case_gradients;
+        p_case_gradients = 0;
 
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
+        return false;
     }
 
-    // sending the cases to the runner for evaluation
-    p_optimizer->sendCasesToOptimizer(case_queue);
-
-    int n_var = 0;
-
-    // calculating the gradients of the real variables
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // copying the gradients of the real variables
+    for(int i = 0; i < n_grad; ++i)
     {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->realVariableValue(i) - case_queue->at(n_var)->realVariableValue(i);
+        // the objective gradient (negative since Ipopt is doing minimization)
+        m_grad_f.replace(i, -p_gradients->objectiveGradient(i));
 
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(n_var)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
-        m_grad_f.replace(n_var, dfdx);
-
-
-        // calculating the gradients of the constraints
-        int entry = n_var*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
+        // the constraint gradients
+        int entry = i*m_cons.size();
+        for(int j = 0; j < m_cons.size(); ++j)
         {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(n_var)->constraintValue(j)) / dx;
-            m_jac_g.replace(entry, dcdx);
+            m_jac_g.replace(entry, p_gradients->constraintJacobian(i, j));
             ++entry;
         }
-
-        ++n_var;
     }
 
-    // deleting the perturbed cases
-    for(int i = 0; i < case_queue->size(); ++i) delete case_queue->at(i);
-    delete case_queue;
-
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -37,6 +37,7 @@ class RealVariable;
 class Constraint;
 class Case;
 class CaseQueue;
+class GradientEngine;
 
 class LshIpoptInterface : public TNLP
 {
@@ -52,6 +53,7 @@ private:
     QVector<double> m_jac_g;    // calculated values for dc/dx
     Case *p_case_last;          // the last case that was run
     Case *p_case_gradients;     // case containing variable values where the gradient and jacobian was calculated
+    GradientEngine *p_gradients;
 
     /**
      * @brief Generates a Case based on the values in x.
@@ -70,9 +72,7 @@ private:
      */
     bool newVariableValues(Index n, const Number *x);
 
-    double perturbedVariableValue(double value, double max, double min);
-
-    void calculateGradients(Index n, const Number *x);
+    bool calculateGradients(Index n, const Number *x);
 
     bool gradientsAreUpdated(Index n, const Number *x);
 
@@ -66,11 +66,66 @@ bool LshNomadEvaluator::eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max,
 
     ///p_optimizer->runCase(c);
 
-    // extracting the objective
-    x.set_bb_output(0, -c->objectiveValue());
+    setOutputs(x, c);
+
+    bool ok = !c->isFailed();
+
+    // deleting the case from the heap
+    delete c;
+    delete cq;
+
+    return ok;
+
+
+}
 
+//-----------------------------------------------------------------------------------------------
+// evaluates a block of points in parallel
+//-----------------------------------------------------------------------------------------------
+bool LshNomadEvaluator::eval_x(std::list<NOMAD::Eval_Point*> &x, const NOMAD::Double &h_max, std::list<bool> &count_eval) const
+{
+    // generating the cases, all of them are sent to the runner as one batch
+    CaseQueue *cq = new CaseQueue();
+
+    for(std::list<NOMAD::Eval_Point*>::iterator it = x.begin(); it != x.end(); ++it) cq->push_back(generateCase(**it));
+
+    p_optimizer->sendCasesToOptimizer(cq);
+
+    // extracting the results
+    bool ok = false;
+    int i = 0;
+
+    count_eval.clear();
+
+    for(std::list<NOMAD::Eval_Point*>::iterator it = x.begin(); it != x.end(); ++it)
+    {
+        Case *c = cq->at(i++);
 
+        setOutputs(**it, c);
 
+        // cancelled points are rejected rather than failed, only real simulator failures are marked as failures
+        if(c->isCancelled()) (*it)->set_eval_status(NOMAD::EVAL_USER_REJECTED);
+        else (*it)->set_eval_status(c->isFailed() ? NOMAD::EVAL_FAIL : NOMAD::EVAL_OK);
+
+        count_eval.push_back(!c->isFailed());
+
+        if(!c->isFailed()) ok = true;
+
+        delete c;
+    }
+
+    delete cq;
+
+    return ok;
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the objective and constraint values of a case to an evaluation point
+//-----------------------------------------------------------------------------------------------
+void LshNomadEvaluator::setOutputs(NOMAD::Eval_Point &x, Case *c) const
+{
+    // extracting the objective
+    x.set_bb_output(0, -c->objectiveValue());
 
 
     // extracting the constraint values
@@ -97,14 +152,6 @@ bool LshNomadEvaluator::eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max,
 
         x.set_bb_output(i+1, val_input);
     }
-
-    // deleting the case from the heap
-    delete c;
-    delete cq;
-
-    return true;
-
-
 }
 
 
@@ -23,24 +23,32 @@
 #define LSHNOMADEVALUATOR_H
 
 #include "nomad.hpp"
+#include <list>
 
 namespace ResOpt
 {
 class LshOptimizer;
 class Case;
 
+/**
+ * @brief Evaluator used by NOMAD in the LSH optimizer.
+ * @details Blocks of points (BB_MAX_BLOCK_SIZE, set from PARALLELRUNS) are sent to the LshOptimizer as one batch, and evaluated in parallel.
+ *
+ */
 class LshNomadEvaluator : public NOMAD::Evaluator
 {
 private:
     LshOptimizer *p_optimizer;
 
-
+    void setOutputs(NOMAD::Eval_Point &x, Case *c) const;
 
 public:
     LshNomadEvaluator(const NOMAD::Parameters &p, LshOptimizer *o);
 
     bool eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max, bool &count_eval) const;
 
+    bool eval_x(std::list<NOMAD::Eval_Point*> &x, const NOMAD::Double &h_max, std::list<bool> &count_eval) const;
+
     Case* generateCase(const NOMAD::Eval_Point &x) const;
 };
 
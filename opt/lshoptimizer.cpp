@@ -390,6 +390,9 @@ NOMAD::Parameters* LshOptimizer::generateNomadParameters(NOMAD::Display *disp)
     // setting the maximum number of iterations
     p_param->set_MAX_BB_EVAL(100);
 
+    // evaluating blocks of points in parallel
+    if(parallelRuns() > 1) p_param->set_BB_MAX_BLOCK_SIZE(parallelRuns());
+
 
 
 
@@ -485,6 +488,7 @@ QString LshOptimizer::description() const
     str.append(" TYPE LSH \n");
     str.append(" ITERATIONS " + QString::number(maxIterations()) + "\n");
     str.append(" PERTURBATION " + QString::number(pertrurbationSize()) + "\n");
+    str.append(" GRADIENT " + GradientEngine::schemeName(gradientScheme()) + "\n");
     str.append(" PARALLELRUNS " + QString::number(parallelRuns()) + "\n");
     str.append("END OPTIMIZER\n\n");
     return str;
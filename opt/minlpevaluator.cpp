@@ -26,9 +26,11 @@
 #include "reservoirsimulator.h"
 #include "minlpipoptinterface.h"
 #include "case.h"
+#include "evaluationcache.h"
 
 
 #include <iostream>
+#include <QDataStream>
 
 using std::cout;
 using std::endl;
@@ -265,4 +267,51 @@ Case* MINLPEvaluator::findResult(Case *c)
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// writes the state of the evaluator to a stream
+//-----------------------------------------------------------------------------------------------
+void MINLPEvaluator::writeState(QDataStream &out)
+{
+    out << qint32(m_iterations) << m_best_objs << m_best_infeas;
+
+    out << qint32(m_results.size());
+    for(int i = 0; i < m_results.size(); ++i) EvaluationCache::writeCase(out, m_results.at(i));
+}
+
+//-----------------------------------------------------------------------------------------------
+// restores the state of the evaluator from a stream
+//-----------------------------------------------------------------------------------------------
+bool MINLPEvaluator::readState(QDataStream &in)
+{
+    qint32 iterations, n_results;
+    QVector<double> best_objs, best_infeas;
+
+    in >> iterations >> best_objs >> best_infeas >> n_results;
+
+    if(in.status() != QDataStream::Ok) return false;
+
+    QList<Case*> results;
+    for(int i = 0; i < n_results; ++i)
+    {
+        Case *c = EvaluationCache::readCase(in);
+
+        if(c == 0)
+        {
+            for(int j = 0; j < results.size(); ++j) delete results.at(j);
+            return false;
+        }
+
+        results.push_back(c);
+    }
+
+    for(int i = 0; i < m_results.size(); ++i) delete m_results.at(i);
+
+    m_results = results;
+    m_best_objs = best_objs;
+    m_best_infeas = best_infeas;
+    m_iterations = iterations;
+
+    return true;
+}
+
 } // namespace
@@ -25,6 +25,8 @@
 #include <QList>
 #include <QVector>
 
+class QDataStream;
+
 namespace ResOpt
 {
 
@@ -53,6 +55,21 @@ public:
     bool shouldContinue(int i, double obj, double infeas);
     Case* findResult(Case *c);
 
+    /**
+     * @brief Writes the solved sub-problems and the best objective history to a stream. Used for checkpoints.
+     *
+     * @param out
+     */
+    void writeState(QDataStream &out);
+
+    /**
+     * @brief Restores the state written by writeState(). Sub-problems that are restored are not solved again.
+     *
+     * @param in
+     * @return bool false if the stream was incomplete
+     */
+    bool readState(QDataStream &in);
+
     int iterations() const {return m_iterations;}
     void resetIterations() {m_iterations = 0;}
 
@@ -40,6 +40,7 @@
 #include "derivative.h"
 #include "casequeue.h"
 #include "reservoirsimulator.h"
+#include "gradientengine.h"
 
 using std::cout;
 using std::endl;
@@ -55,11 +56,17 @@ MINLPIpoptInterface::MINLPIpoptInterface(Optimizer *o, MINLPEvaluator *e, Case *
       p_case_last(0),
       p_case_gradients(0),
       p_best_case(0),
+      p_gradients(0),
       m_adjoints(false)
 {
     m_vars = p_optimizer->runner()->model()->realVariables();
     m_cons = p_optimizer->runner()->model()->constraints();
 
+    // setting up the gradient engine
+    p_gradients = new GradientEngine(p_optimizer);
+    p_gradients->setVariables(m_vars);
+    p_gradients->setScheme(p_optimizer->gradientScheme());
+
     cout << "MINLPIpoptInterface(): m_vars = " << m_vars.size() << endl;
 
 
@@ -94,6 +101,7 @@ MINLPIpoptInterface::~MINLPIpoptInterface()
     if(p_case_last != 0) delete p_case_last;
     if(p_case_gradients != 0) delete p_case_gradients;
     if(p_best_case != 0) delete p_best_case;
+    if(p_gradients != 0) delete p_gradients;
 }
 
 bool MINLPIpoptInterface::get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
@@ -241,7 +249,7 @@ bool MINLPIpoptInterface::eval_grad_f(Index n, const Number* x, bool new_x, Numb
     {
        // cout << "need to calculate new gradients..." << endl;
         if(m_adjoints) ok = copyCaseGradients(n,x);
-        else calculateGradients(n,x);
+        else ok = calculateGradients(n,x);
        // cout << "done calculating new gradients..." << endl;
     }
     //else cout << "gradients are already calculated for this point..." << endl;
@@ -327,7 +335,7 @@ bool MINLPIpoptInterface::eval_jac_g(Index n, const Number* x, bool new_x,
         if(!gradientsAreUpdated(n,x))
         {
             if(m_adjoints) copyCaseGradients(n,x);
-            else calculateGradients(n,x);
+            else if(!calculateGradients(n,x)) return false;
         }
 
         // copying gradients to Ipopt
@@ -466,37 +474,10 @@ bool MINLPIpoptInterface::newVariableValues(Index n, const Number *x)
 
 }
 
-//-----------------------------------------------------------------------------------------------
-// Calculates the perturbated value a variable
-//-----------------------------------------------------------------------------------------------
-double MINLPIpoptInterface::perturbedVariableValue(double value, double max, double min)
-{
-    double x_perturbed;
-
-    double span = max - min;
-    double l_slack = value - min;
-    double u_slack = max - value;
-
-    if(u_slack >= l_slack)
-    {
-        x_perturbed = value + p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed > max) x_perturbed = max;
-    }
-    else
-    {
-        x_perturbed = value - p_optimizer->pertrurbationSize() * span;
-        if(x_perturbed < min) x_perturbed = min;
-    }
-
-    return x_perturbed;
-
-}
-
-
 //-----------------------------------------------------------------------------------------------
 // Calculates the gradients
 //-----------------------------------------------------------------------------------------------
-void MINLPIpoptInterface::calculateGradients(Index n, const Number *x)
+bool MINLPIpoptInterface::calculateGradients(Index n, const Number *x)
 {
     //cout << "Starting perturbations to calculate gradients for IPOPT" << endl;
     // checking if the gradient vectors have the correct size
@@ -537,31 +518,16 @@ void MINLPIpoptInterface::calculateGradients(Index n, const Number *x)
     p_case_gradients = new Case(*p_case_last, true);
 
 
-    // setting up the case queue with all the perturbations
-    CaseQueue *case_queue = new CaseQueue();
-
-    // adding the real variable perturbations
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // calculating the gradients by perturbation
+    if(!p_gradients->calculate(p_case_gradients))
     {
-        // calculating the perturbed value of the variable
-        double x_perturbed = perturbedVariableValue(p_case_gradients->realVariableValue(i), m_vars.at(i)->max(), m_vars.at(i)->min());
-
-        // setting up a new case
-        Case *case_perturbed = new Case(*p_case_gradients);
-
-        // changing the value of the variable to the perturbe value
-        case_perturbed->setRealVariableValue(i, x_perturbed);
+        // the solver is told that the point can not be evaluated, the gradients are calculated again if it asks for them
+        delete p_case_gradients;
+        p_case_gradients = 0;
 
-        // running the case
-        p_optimizer->runCase(case_perturbed);
-
-        // adding the case to the queue
-        case_queue->push_back(case_perturbed);
+        return false;
     }
 
-    // sending the cases to the runner for evaluation
-    //p_optimizer->runCases(case_queue);
-
 
     // setting up the text stream for gradients info
     QTextStream out(p_grad_file);
@@ -578,27 +544,21 @@ void MINLPIpoptInterface::calculateGradients(Index n, const Number *x)
 
     out << "\n";
 
-    // calculating the gradients of the real variables
-    for(int i = 0; i < p_case_gradients->numberOfRealVariables(); ++i)
+    // copying the gradients of the real variables
+    for(int i = 0; i < n_grad; ++i)
     {
-        // calculating the perturbation size of the variable
-        double dx = p_case_gradients->realVariableValue(i) - case_queue->at(i)->realVariableValue(i);
-
-        // calculating the gradient of the objective
-        double dfdx = -(p_case_gradients->objectiveValue() - case_queue->at(i)->objectiveValue()) / dx;
-
-        // setting the value to the objective gradient vector
+        // the objective gradient (negative since Ipopt is doing minimization)
+        double dfdx = -p_gradients->objectiveGradient(i);
         m_grad_f.replace(i, dfdx);
 
         //printing var # and obj
         out << i+1 << "\t" << dfdx << "\t";
 
-
-        // calculating the gradients of the constraints
-        int entry = i*p_case_gradients->numberOfConstraints();
-        for(int j = 0; j < p_case_gradients->numberOfConstraints(); ++j)
+        // the constraint gradients
+        int entry = i*m_cons.size();
+        for(int j = 0; j < m_cons.size(); ++j)
         {
-            double dcdx = (p_case_gradients->constraintValue(j) - case_queue->at(i)->constraintValue(j)) / dx;
+            double dcdx = p_gradients->constraintJacobian(i, j);
             m_jac_g.replace(entry, dcdx);
             ++entry;
 
@@ -607,35 +567,11 @@ void MINLPIpoptInterface::calculateGradients(Index n, const Number *x)
         }
 
         out << "\n";
-
-        /*
-        // printing base case
-        out << p_case_gradients->realVariableValue(i) << " (b)\t" << p_case_gradients->objectiveValue() << "\t";
-        for(int k = 0; k < p_case_gradients->numberOfConstraints(); ++k)
-        {
-            out << p_case_gradients->constraintValue(k) << "\t";
-        }
-        out << "\n";
-
-        // printing pertrubarion
-        out << case_queue->at(i)->realVariableValue(i) << " (p)\t" << case_queue->at(i)->objectiveValue() << "\t";
-        for(int k = 0; k < case_queue->at(i)->numberOfConstraints(); ++k)
-        {
-            out << case_queue->at(i)->constraintValue(k) << "\t";
-        }
-        out << "\n";
-        */
-
-
-
     }
 
-    // deleting the perturbed cases
-    for(int i = 0; i < case_queue->size(); ++i) delete case_queue->at(i);
-    delete case_queue;
-
     p_grad_file->flush();
 
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -39,6 +39,7 @@ class RealVariable;
 class Constraint;
 class Case;
 class CaseQueue;
+class GradientEngine;
 
 class MINLPIpoptInterface : public TNLP
 {
@@ -58,6 +59,7 @@ private:
     Case *p_case_gradients;     // case containing variable values where the gradient and jacobian was calculated
     Case *p_best_case;          // the final optimized solution
     QFile *p_grad_file;
+    GradientEngine *p_gradients;
     bool m_adjoints;            // indicates if adjoints are used
     QVector<double> m_objs;     // objective values for each IPOPT iteration
     QVector<double> m_infeas;      // infeasibility values for each IPOPT iteration
@@ -79,9 +81,7 @@ private:
      */
     bool newVariableValues(Index n, const Number *x);
 
-    double perturbedVariableValue(double value, double max, double min);
-
-    void calculateGradients(Index n, const Number *x);
+    bool calculateGradients(Index n, const Number *x);
     bool copyCaseGradients(Index n, const Number *x);
 
     bool gradientsAreUpdated(Index n, const Number *x);
@@ -2,6 +2,7 @@
 
 #include <tr1/memory>
 #include <iostream>
+#include <math.h>
 
 #include "nomadoptimizer.h"
 #include "runner.h"
@@ -10,6 +11,7 @@
 #include "binaryvariable.h"
 #include "constraint.h"
 #include "case.h"
+#include "casequeue.h"
 
 using std::tr1::shared_ptr;
 using std::endl;
@@ -20,7 +22,8 @@ namespace ResOpt
 
 NomadEvaluator::NomadEvaluator(const NOMAD::Parameters &p, NomadOptimizer *o)
     : NOMAD::Evaluator(p),
-      p_optimizer(o)
+      p_optimizer(o),
+      m_best_objective(-HUGE_VAL)
 {
 }
 
@@ -35,11 +38,79 @@ bool NomadEvaluator::eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max, bo
     // sending the case off for evaluation
     p_optimizer->runCase(c);
 
-    // extracting the objective
-    x.set_bb_output(0, -c->objectiveValue());
+    setOutputs(x, c);
+
+    bool ok = !c->isFailed();
+
+    if(ok && p_optimizer->runner()->isFeasible(c) && c->objectiveValue() > m_best_objective) m_best_objective = c->objectiveValue();
+
+    // deleting the case from the heap
+    //delete c;
+
+    return ok;
+}
+
+//-----------------------------------------------------------------------------------------------
+// evaluates a block of points in parallel
+//-----------------------------------------------------------------------------------------------
+bool NomadEvaluator::eval_x(std::list<NOMAD::Eval_Point*> &x, const NOMAD::Double &h_max, std::list<bool> &count_eval) const
+{
+    // generating the cases
+    CaseQueue *cases = new CaseQueue();
+
+    for(std::list<NOMAD::Eval_Point*>::iterator it = x.begin(); it != x.end(); ++it) cases->push_back(generateCase(**it));
 
+    // running the cases, stopping when one of them is better than the best so far
+    if(p_optimizer->runCasesOpportunistic(cases, m_best_objective)) cout << "NOMAD: found improvement, the rest of the block was cancelled..." << endl;
 
+    // extracting the results
+    bool ok = false;
+    int i = 0;
 
+    count_eval.clear();
+
+    for(std::list<NOMAD::Eval_Point*>::iterator it = x.begin(); it != x.end(); ++it)
+    {
+        Case *c = cases->at(i++);
+
+        setOutputs(**it, c);
+
+        // points that were cancelled by the opportunistic cutoff are not failures, only real simulator failures are
+        if(c->isCancelled())
+        {
+            (*it)->set_eval_status(NOMAD::EVAL_USER_REJECTED);
+            count_eval.push_back(false);
+        }
+        else if(c->isFailed())
+        {
+            (*it)->set_eval_status(NOMAD::EVAL_FAIL);
+            count_eval.push_back(false);
+        }
+        else
+        {
+            (*it)->set_eval_status(NOMAD::EVAL_OK);
+            count_eval.push_back(true);
+            ok = true;
+
+            if(p_optimizer->runner()->isFeasible(c) && c->objectiveValue() > m_best_objective) m_best_objective = c->objectiveValue();
+        }
+
+        // the results have been copied to NOMAD, the cache and the runner keep their own copies
+        delete c;
+    }
+
+    delete cases;
+
+    return ok;
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the objective and constraint values of a case to an evaluation point
+//-----------------------------------------------------------------------------------------------
+void NomadEvaluator::setOutputs(NOMAD::Eval_Point &x, Case *c) const
+{
+    // extracting the objective
+    x.set_bb_output(0, -c->objectiveValue());
 
 
     // extracting the constraint values
@@ -66,13 +137,6 @@ bool NomadEvaluator::eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max, bo
 
         x.set_bb_output(i+1, val_input);
     }
-
-    // deleting the case from the heap
-    //delete c;
-
-    return true;
-
-
 }
 
 
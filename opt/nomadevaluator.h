@@ -2,24 +2,38 @@
 #define NOMADEVALUATOR_H
 
 #include "nomad.hpp"
+#include <list>
 
 namespace ResOpt
 {
 class NomadOptimizer;
 class Case;
 
+/**
+ * @brief Evaluator used by NOMAD.
+ * @details When NOMAD is set up with a block size larger than one (BB_MAX_BLOCK_SIZE, set from PARALLELRUNS), the points in a block are
+ *          sent to the Runner as one batch, so that they are evaluated in parallel. The evaluation is opportunistic: as soon as one of the
+ *          points is a feasible improvement on the best point found so far, the rest of the block is cancelled. Cancelled points are
+ *          reported to NOMAD as rejected by the user (EVAL_USER_REJECTED), so they are not counted and may be evaluated again later.
+ *          Points where the simulator failed are reported as failed evaluations.
+ *
+ */
 class NomadEvaluator : public NOMAD::Evaluator
 {
 private:
     NomadOptimizer *p_optimizer;
 
+    mutable double m_best_objective;    // objective of the best feasible point evaluated so far, -HUGE_VAL until there is one
 
+    void setOutputs(NOMAD::Eval_Point &x, Case *c) const;
 
 public:
     NomadEvaluator(const NOMAD::Parameters &p, NomadOptimizer *o);
 
     bool eval_x(NOMAD::Eval_Point &x, const NOMAD::Double &h_max, bool &count_eval) const;
 
+    bool eval_x(std::list<NOMAD::Eval_Point*> &x, const NOMAD::Double &h_max, std::list<bool> &count_eval) const;
+
     Case* generateCase(const NOMAD::Eval_Point &x) const;
 };
 
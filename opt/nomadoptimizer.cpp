@@ -218,6 +218,9 @@ void NomadOptimizer::generateParameters()
     // setting the maximum number of iterations
     p_param->set_MAX_BB_EVAL(maxIterations());
 
+    // evaluating blocks of points in parallel
+    if(parallelRuns() > 1) p_param->set_BB_MAX_BLOCK_SIZE(parallelRuns());
+
 
     // checking if the parameters file exits
     QDir dir(runner()->reservoirSimulator()->folder());
@@ -22,6 +22,7 @@
 #include "optimizer.h"
 #include "runner.h"
 #include "casequeue.h"
+#include "case.h"
 #include <QEventLoop>
 
 #include <iostream>
@@ -43,6 +44,7 @@ Optimizer::Optimizer(Runner *r)
       m_termination(0.0),
       m_term_start(5),
       m_startingpoint_update(false),
+      m_gradient_scheme(GradientEngine::FORWARD),
       m_initialized(false)
 {
     // the finished() signal should be emitted when the optimizer has converged
@@ -60,17 +62,71 @@ Optimizer::~Optimizer()
 //-----------------------------------------------------------------------------------------------
 void Optimizer::runCases(CaseQueue *cases, Component *comp)
 {
-    // creating an event loop that waits for all the cases to finish in the runner
+    waitForCases(submitCases(cases, comp));
+}
+
+//-----------------------------------------------------------------------------------------------
+// sends off a queue of cases to the runner, returns without waiting
+//-----------------------------------------------------------------------------------------------
+int Optimizer::submitCases(CaseQueue *cases, Component *comp)
+{
+    return p_runner->submit(cases, comp);
+}
+
+//-----------------------------------------------------------------------------------------------
+// waits for a queue of cases to finish in the runner
+//-----------------------------------------------------------------------------------------------
+void Optimizer::waitForCases(int batch_id)
+{
+    // creating an event loop that waits for the batch to finish in the runner
+    QEventLoop loop;
+
+    // the event loop quits every time a batch finishes, looping until it is this one
+    connect(p_runner, SIGNAL(batchFinished(int)), &loop, SLOT(quit()));
+
+    while(!p_runner->isBatchFinished(batch_id)) loop.exec();
+}
+
+//-----------------------------------------------------------------------------------------------
+// runs a queue of cases, cancelling the rest when an improvement is found
+//-----------------------------------------------------------------------------------------------
+bool Optimizer::runCasesOpportunistic(CaseQueue *cases, double best_objective)
+{
+    // without an incumbent any feasible case would be an improvement, the whole batch is evaluated
+    if(best_objective == -HUGE_VAL)
+    {
+        runCases(cases);
+        return false;
+    }
+
+    int batch_id = submitCases(cases);
+
+    // the event loop quits every time a case or a batch finishes
     QEventLoop loop;
 
-    // this makes the event loop wait for the casesFinished() signal to quit
-    connect(p_runner, SIGNAL(casesFinished()), &loop, SLOT(quit()));
+    connect(p_runner, SIGNAL(newCaseFinished(Case*)), &loop, SLOT(quit()));
+    connect(p_runner, SIGNAL(batchFinished(int)), &loop, SLOT(quit()));
+
+    bool cut_off = false;
 
-    // sending the cases to the runner
-    p_runner->evaluate(cases, comp);
+    while(!p_runner->isBatchFinished(batch_id))
+    {
+        // checking if any of the finished cases is an improvement
+        for(int i = 0; i < cases->size() && !cut_off; ++i)
+        {
+            Case *c = cases->at(i);
 
-    // waiting for the runner to finish
-    loop.exec();
+            if(p_runner->isCaseFinished(c) && p_runner->isFeasible(c) && c->objectiveValue() > best_objective)
+            {
+                p_runner->cancel(batch_id);
+                cut_off = true;
+            }
+        }
+
+        if(!p_runner->isBatchFinished(batch_id)) loop.exec();
+    }
+
+    return cut_off;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -95,6 +151,14 @@ void Optimizer::runCase(Case *c, Component *comp)
 
 
 
+//-----------------------------------------------------------------------------------------------
+// called at the end of each iteration, the state of the optimizer is consistent here
+//-----------------------------------------------------------------------------------------------
+void Optimizer::iterationFinished()
+{
+    p_runner->checkpoint();
+}
+
 //-----------------------------------------------------------------------------------------------
 // sends the best case to the runner for printing
 //-----------------------------------------------------------------------------------------------
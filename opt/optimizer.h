@@ -22,6 +22,9 @@
 #define OPTIMIZER_H
 
 #include <QObject>
+#include <QByteArray>
+
+#include "gradientengine.h"
 
 
 namespace ResOpt
@@ -52,6 +55,7 @@ private:
     double m_termination;
     int m_term_start;
     bool m_startingpoint_update;
+    GradientEngine::scheme m_gradient_scheme;
 
 
 
@@ -68,6 +72,40 @@ public:
     virtual QString description() const = 0;
 
 
+    /**
+     * @brief Returns the internal state of the optimizer, to be stored in a checkpoint.
+     * @details The default implementation has no state. Optimizers that can skip work when they are restarted should reimplement this
+     *          together with restoreState().
+     *
+     * @return QByteArray
+     */
+    virtual QByteArray saveState() {return QByteArray();}
+
+    /**
+     * @brief Restores the state returned by saveState(). Called before start() when a run is resumed from a checkpoint.
+     *
+     * @param state
+     * @return bool false if the state could not be read
+     */
+    virtual bool restoreState(const QByteArray &state) {return true;}
+
+    /**
+     * @brief Returns true if the optimizer calls iterationFinished() at the end of each iteration.
+     * @details The state returned by saveState() is only consistent with the run counters at the end of an iteration. For optimizers
+     *          that mark their iterations, the Runner only writes checkpoints from iterationFinished(). For the others, a checkpoint
+     *          may be written whenever a batch of cases has finished.
+     *
+     * @return bool
+     */
+    virtual bool marksIterations() const {return false;}
+
+    /**
+     * @brief Lets the Runner write a checkpoint, if it is time for one. Called by the optimizer at the end of each iteration.
+     *
+     */
+    void iterationFinished();
+
+
     void sendBestCaseToRunner(Case *c);
 
     Runner* runner() {return p_runner;}
@@ -81,6 +119,7 @@ public:
     void setTerminationStart(int i) {m_term_start = i;}
     void setInitialized(bool i) {m_initialized = i;}
     void setStartingpointUpdate(bool b) {m_startingpoint_update = b;}
+    void setGradientScheme(GradientEngine::scheme s) {m_gradient_scheme = s;}
 
     // get functions
     int maxIterations() const {return m_max_iter;}
@@ -91,6 +130,7 @@ public:
     int terminationStart() const {return m_term_start;}
     bool isInitialized() const {return m_initialized;}
     bool startingpointUpdate() const {return m_startingpoint_update;}
+    GradientEngine::scheme gradientScheme() const {return m_gradient_scheme;}
 
 signals:
 
@@ -119,6 +159,39 @@ public slots:
     void runCases(CaseQueue *cases, Component *comp = 0);
 
 
+    /**
+     * @brief Sends a list of cases to the Runner for evaluation without waiting for them to finish.
+     * @details The optimizer can do other work while the cases are evaluated, and submit more cases. Use waitForCases() with the returned id
+     *          before reading the results from the cases.
+     *
+     * @param cases
+     * @return int id of the batch
+     */
+    int submitCases(CaseQueue *cases, Component *comp = 0);
+
+
+    /**
+     * @brief Waits until all the cases in a batch sent with submitCases() have been evaluated.
+     *
+     * @param batch_id
+     */
+    void waitForCases(int batch_id);
+
+
+    /**
+     * @brief Evaluates a list of cases, stopping as soon as one of them is an improvement.
+     * @details The cases are sent to the Runner as one batch, so that they are evaluated in parallel. When a feasible case with an objective
+     *          value above best_objective has finished, the rest of the batch is cancelled (see Runner::cancel()). The cases that were not
+     *          evaluated are marked as cancelled (see Case::isCancelled()). The cutoff is only used once there is an incumbent from a
+     *          completed evaluation: if best_objective is -HUGE_VAL, the whole batch is evaluated.
+     *
+     * @param cases
+     * @param best_objective
+     * @return bool true if the batch was cut off
+     */
+    bool runCasesOpportunistic(CaseQueue *cases, double best_objective);
+
+
     /**
      * @brief Overloaded function.
      * @details This function creates a CaseQueue consisting of a single Case, c, and sends it to runCases().
@@ -72,7 +72,7 @@ Case* MasterOptimizer::generateBaseCase()
 {
     Case *c = new Case();
 
-    Model *m = p_master_runner->runner(0)->model();
+    Model *m = p_master_runner->runner()->model();
 
     // integer variables
     for(int i = 0; i < m->integerVariables().size(); ++i)
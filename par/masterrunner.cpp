@@ -22,12 +22,17 @@
 #include "masterrunner.h"
 
 #include "runner.h"
-#include "modelreader.h"
 #include "model.h"
-#include "reservoir.h"
 #include "case.h"
+#include "remotelauncher.h"
 
 #include <QDir>
+#include <QFileInfo>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QProcess>
+#include <QCoreApplication>
+#include <QTimer>
 #include <iostream>
 
 
@@ -37,21 +42,42 @@ using std::endl;
 namespace ResOpt
 {
 
+// milliseconds to wait for the local workers to shut down
+static const int MASTER_WORKER_EXIT_TIMEOUT = 10000;
+
+
 MasterRunner::MasterRunner(const QString &driver_file, int parallel_runs, QObject *parent) :
     QObject(parent),
     m_driver_file(driver_file),
-    m_parallel_runs(parallel_runs)
+    m_parallel_runs(parallel_runs),
+    m_port(0),
+    p_runner(0),
+    p_server(0)
 {
 }
 
 MasterRunner::~MasterRunner()
 {
-    for(int i = 0; i < m_runners.size(); ++i) m_runners.at(i)->deleteLater();
+    for(int i = 0; i < m_workers.size(); ++i)
+    {
+        disconnect(m_workers.at(i), 0, this, 0);
+        delete m_workers.at(i);
+    }
+
+    for(int i = 0; i < m_processes.size(); ++i)
+    {
+        QProcess *p = m_processes.at(i);
+        if(!p->waitForFinished(MASTER_WORKER_EXIT_TIMEOUT)) p->kill();
+        delete p;
+    }
+
+    if(p_server != 0) delete p_server;
+    if(p_runner != 0) p_runner->deleteLater();
 }
 
 
 //-----------------------------------------------------------------------------------------------
-// initializes the runners etc
+// initializes the runner, and starts listening for workers
 //-----------------------------------------------------------------------------------------------
 bool MasterRunner::initialize()
 {
@@ -61,43 +87,71 @@ bool MasterRunner::initialize()
     // getting the path of the base file
     QFileInfo info(m_driver_file);
     m_path = info.absoluteDir().absolutePath();
-    QString driver_file_name = info.fileName();
 
-    //QDir dir(m_path);
-    //if(!dir.exists("mr")) dir.mkdir("mr");
 
+    // the runner of the master
+    p_runner = new Runner(m_driver_file);
+    p_runner->initialize();
 
+    connect(p_runner, SIGNAL(runnerFinished(Runner*,Case*)), this, SLOT(onRunnerFinished(Runner*,Case*)));
 
-    // initializing the runners
-    for(int i = 0; i < m_parallel_runs; ++i)
-    {
-        // create sub-folder
-        //QDir dir_i(m_path + "/mr");
-        //if(!dir_i.exists(QString::number(i))) dir_i.mkdir(QString::number(i));
 
-        // driver file name for the runnner
-        QString driver_file_i = m_path + "/mr/" + QString::number(i) + "/" + driver_file_name;
+    // listening for workers
+    p_server = new QTcpServer(this);
+    connect(p_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
 
+    if(!p_server->listen(QHostAddress::Any, m_port))
+    {
+        qWarning("MasterRunner could not listen on port %d: %s", m_port, p_server->errorString().toLatin1().constData());
+        return false;
+    }
 
-        // creating runner
-        Runner *r = new Runner(driver_file_i);
+    cout << "MasterRunner listening for workers on port " << port() << endl;
 
 
+    startLocalWorkers();
 
-        cout << "Initializing runner" << endl;
+    return true;
+}
 
-        r->initialize();
+//-----------------------------------------------------------------------------------------------
+// starts the local worker processes
+//-----------------------------------------------------------------------------------------------
+void MasterRunner::startLocalWorkers()
+{
+    QString driver_file_name = QFileInfo(m_driver_file).fileName();
 
-        // connecting signals
-        connect(r, SIGNAL(runnerFinished(Runner*,Case*)), this, SLOT(onRunnerFinished(Runner*,Case*)));
+    for(int i = 0; i < m_parallel_runs; ++i)
+    {
+        // driver file name for the worker
+        QString driver_file_i = m_path + "/mr/" + QString::number(i) + "/" + driver_file_name;
 
+        if(!QFile::exists(driver_file_i))
+        {
+            qWarning("Driver file for local worker #%d not found: %s", i, driver_file_i.toLatin1().constData());
+            continue;
+        }
 
-        m_runners.push_back(r);
-        m_runner_states.push_back(false);
+        QStringList args;
+        args << "--worker" << "localhost:" + QString::number(port()) << driver_file_i;
 
+        QProcess *p = new QProcess();
+        p->setProcessChannelMode(QProcess::ForwardedChannels);
+        p->start(QCoreApplication::applicationFilePath(), args);
 
+        m_processes.push_back(p);
+
+        cout << "Started local worker #" << i << endl;
     }
+}
 
+//-----------------------------------------------------------------------------------------------
+// returns the port the master is listening on
+//-----------------------------------------------------------------------------------------------
+quint16 MasterRunner::port() const
+{
+    if(p_server != 0 && p_server->isListening()) return p_server->serverPort();
+    else return m_port;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -107,23 +161,60 @@ void MasterRunner::run()
 {
     cout << "Running MasterRunner"  << endl;
 
-    if(m_runners.size() != m_parallel_runs) initialize();
+    if(p_runner == 0 && !initialize())
+    {
+        emit optimizationFinished();
+        return;
+    }
 
+    // the optimizer runs in the event loop, so workers can connect while it is running
+    QTimer::singleShot(0, p_runner, SLOT(run()));
+}
 
-    emit optimizationFinished();
+//-----------------------------------------------------------------------------------------------
+// a worker has connected
+//-----------------------------------------------------------------------------------------------
+void MasterRunner::onNewConnection()
+{
+    while(p_server->hasPendingConnections())
+    {
+        QTcpSocket *s = p_server->nextPendingConnection();
 
+        RemoteLauncher *l = new RemoteLauncher(s, p_runner->model());
 
+        connect(l, SIGNAL(disconnected(RemoteLauncher*)), this, SLOT(onWorkerDisconnected(RemoteLauncher*)));
+        connect(p_runner, SIGNAL(resumePaused()), l, SLOT(work()));
+
+        // the launcher starts pulling cases when the worker has said hello
+        p_runner->addExternalLauncher(l);
+
+        m_workers.push_back(l);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// a worker has disconnected
+//-----------------------------------------------------------------------------------------------
+void MasterRunner::onWorkerDisconnected(RemoteLauncher *l)
+{
+    p_runner->removeExternalLauncher(l);
+
+    m_workers.removeAll(l);
+    l->deleteLater();
 }
 
 
 //-----------------------------------------------------------------------------------------------
-// called when a runner finishes
+// called when the runner finishes
 //-----------------------------------------------------------------------------------------------
 void MasterRunner::onRunnerFinished(Runner *r, Case *c)
 {
+    // shutting down the workers
+    for(int i = 0; i < m_workers.size(); ++i) m_workers.at(i)->quit();
 
+    for(int i = 0; i < m_processes.size(); ++i) m_processes.at(i)->waitForFinished(MASTER_WORKER_EXIT_TIMEOUT);
 
-
+    emit optimizationFinished();
 }
 
 
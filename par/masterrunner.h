@@ -26,24 +26,48 @@
 #include <QList>
 #include <QString>
 
+class QTcpServer;
+class QProcess;
+
 namespace ResOpt
 {
 
 class Runner;
 class Case;
+class RemoteLauncher;
 
 
+/**
+ * @brief Runs an optimization with cases evaluated by worker processes.
+ * @details The MasterRunner holds a Runner for the driver file, and listens for worker processes on a TCP port. Each worker that connects
+ *          gets a RemoteLauncher in the master Runner, and pulls cases from the same CaseScheduler as the Launchers of the master. Workers
+ *          are started with "ResOpt --worker host:port driver_file", and must have the same problem as the master.
+ *
+ *          The MasterRunner starts parallel_runs local workers itself, using the driver files in the mr/<i>/ sub folders of the master
+ *          driver file (so that each worker has its own output folder). Workers on other machines may connect at any time.
+ *
+ */
 class MasterRunner : public QObject
 {
     Q_OBJECT
 private:
     QString m_driver_file;
     int m_parallel_runs;
+    quint16 m_port;
 
     QString m_path;
 
-    QList<Runner*> m_runners;
-    QList<bool> m_runner_states;
+    Runner *p_runner;
+    QTcpServer *p_server;
+
+    QList<RemoteLauncher*> m_workers;
+    QList<QProcess*> m_processes;
+
+    /**
+     * @brief Starts the local worker processes.
+     *
+     */
+    void startLocalWorkers();
 
 public:
     explicit MasterRunner(const QString &driver_file, int parallel_runs, QObject *parent = 0);
@@ -53,8 +77,13 @@ public:
     bool initialize();
 
 
+    // set functions
+    void setPort(quint16 port) {m_port = port;}
+
     // get functions
-    Runner* runner(int i) {return m_runners.at(i);}
+    Runner* runner() {return p_runner;}
+    int numberOfWorkers() const {return m_workers.size();}
+    quint16 port() const;
 
 
 
@@ -66,6 +95,10 @@ signals:
 public slots:
     void run();
     void onRunnerFinished(Runner *r, Case *c);
+
+private slots:
+    void onNewConnection();
+    void onWorkerDisconnected(RemoteLauncher *l);
     
 };
 
@@ -0,0 +1,291 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "remotelauncher.h"
+
+#include <iostream>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QDataStream>
+
+#include "workerprotocol.h"
+#include "model.h"
+#include "case.h"
+#include "evaluationcache.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+RemoteLauncher::RemoteLauncher(QTcpSocket *s, Model *master_model, QObject *parent)
+    : Launcher(parent),
+      p_socket(s),
+      p_master_model(master_model),
+      m_capacity(0),
+      m_next_job_id(0)
+{
+    p_socket->setParent(this);
+
+    connect(p_socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(p_socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+}
+
+RemoteLauncher::~RemoteLauncher()
+{
+    // the socket is deleted with the launcher, and should not call back into it
+    disconnect(p_socket, 0, this, 0);
+}
+
+//-----------------------------------------------------------------------------------------------
+// sends jobs to the worker
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::work()
+{
+    // not ready before the worker has said hello
+    if(scheduler() == 0 || m_capacity == 0) return;
+
+    // the master thread must not block on a paused scheduler
+    if(scheduler()->isPaused()) return;
+
+    CaseScheduler::Job job;
+
+    while(m_jobs.size() < m_capacity && scheduler()->take(this, &job))
+    {
+        quint32 id = m_next_job_id++;
+
+        m_jobs.insert(id, job);
+        send(id, job);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// sends a case to the worker
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::send(quint32 job_id, const CaseScheduler::Job &job)
+{
+    Case *c = job.c;
+
+    QVector<double> real_vars;
+    QVector<double> binary_vars;
+    QVector<qint32> int_vars;
+
+    for(int i = 0; i < c->numberOfRealVariables(); ++i) real_vars.push_back(c->realVariableValue(i));
+    for(int i = 0; i < c->numberOfBinaryVariables(); ++i) binary_vars.push_back(c->binaryVariableValue(i));
+    for(int i = 0; i < c->numberOfIntegerVariables(); ++i) int_vars.push_back(c->integerVariableValue(i));
+
+    QByteArray msg;
+    QDataStream out(&msg, QIODevice::WriteOnly);
+    out.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+    out << quint8(WorkerProtocol::EVALUATE) << job_id;
+    WorkerProtocol::encodeComponent(out, p_master_model, job.comp);
+    out << real_vars << binary_vars << int_vars;
+
+    WorkerProtocol::send(p_socket, msg);
+}
+
+//-----------------------------------------------------------------------------------------------
+// processes the messages from the worker
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::onReadyRead()
+{
+    m_buffer.append(p_socket->readAll());
+
+    QByteArray msg;
+    bool ok;
+    while(WorkerProtocol::next(&m_buffer, &msg, &ok))
+    {
+        QDataStream in(msg);
+        in.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+        quint8 type;
+        in >> type;
+
+        bool msg_ok = false;
+
+        if(type == WorkerProtocol::HELLO) msg_ok = processHello(in);
+        else if(type == WorkerProtocol::RESULT) msg_ok = processResult(in);
+        else
+        {
+            qWarning("Unknown message from worker %s, disconnecting", p_socket->peerAddress().toString().toLatin1().constData());
+            p_socket->abort();
+        }
+
+        // the socket has been aborted, the rest of the data is not processed
+        if(!msg_ok)
+        {
+            m_buffer.clear();
+            return;
+        }
+    }
+
+    if(!ok)
+    {
+        qWarning("Too long message from worker %s, disconnecting", p_socket->peerAddress().toString().toLatin1().constData());
+        m_buffer.clear();
+        p_socket->abort();
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// the worker has connected, checking that it has the same problem as the master
+//-----------------------------------------------------------------------------------------------
+bool RemoteLauncher::processHello(QDataStream &in)
+{
+    qint32 version, capacity, n_real, n_binary, n_int, n_cons;
+
+    in >> version >> capacity >> n_real >> n_binary >> n_int >> n_cons;
+
+    bool ok = in.status() == QDataStream::Ok && version == WorkerProtocol::VERSION;
+    ok = ok && n_real == p_master_model->realVariables().size();
+    ok = ok && n_binary == p_master_model->binaryVariables().size();
+    ok = ok && n_int == p_master_model->integerVariables().size();
+    ok = ok && n_cons == p_master_model->constraints().size();
+
+    if(!ok)
+    {
+        qWarning("Worker %s does not have the same problem as the master, disconnecting", p_socket->peerAddress().toString().toLatin1().constData());
+        p_socket->abort();
+        return false;
+    }
+
+    m_capacity = qMax(capacity, 1);
+
+    cout << "Worker connected from " << p_socket->peerAddress().toString().toLatin1().constData() << " with " << m_capacity << " launchers..." << endl;
+
+    work();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// a case has been evaluated by the worker
+//-----------------------------------------------------------------------------------------------
+bool RemoteLauncher::processResult(QDataStream &in)
+{
+    quint32 job_id;
+    qint32 res_sim_runs;
+
+    in >> job_id >> res_sim_runs;
+
+    Case *result = EvaluationCache::readCase(in);
+
+    if(result == 0 || !m_jobs.contains(job_id))
+    {
+        qWarning("Corrupt result from worker %s, disconnecting", p_socket->peerAddress().toString().toLatin1().constData());
+        delete result;
+        p_socket->abort();
+        return false;
+    }
+
+    CaseScheduler::Job job = m_jobs.take(job_id);
+
+    // copying the results to the case of the master
+    job.c->copyFrom(*result, true);
+    delete result;
+
+    // the worker stopped the evaluation, the point itself may be fine
+    if(m_cancelled_jobs.remove(job_id) && job.c->isFailed()) job.c->setCancelled(p_master_model);
+
+    for(int i = 0; i < res_sim_runs; ++i) emit runningReservoirSimulator();
+
+    emit finished(this, job.comp, job.c);
+
+    // the worker has room for more
+    work();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// the worker is gone, giving its jobs to someone else
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::onDisconnected()
+{
+    cout << "Worker disconnected, " << m_jobs.size() << " cases are sent back to the queue..." << endl;
+
+    m_capacity = 0;
+
+    // the cancelled jobs are not evaluated again, they are finished as cancelled
+    QVector<CaseScheduler::Job> cancelled;
+    for(QSet<quint32>::const_iterator it = m_cancelled_jobs.constBegin(); it != m_cancelled_jobs.constEnd(); ++it)
+    {
+        if(m_jobs.contains(*it)) cancelled.push_back(m_jobs.take(*it));
+    }
+    m_cancelled_jobs.clear();
+
+    // unregistering first, so the jobs are not handed back to this launcher
+    if(scheduler() != 0)
+    {
+        scheduler()->removeLauncher(this);
+        if(!m_jobs.isEmpty()) scheduler()->submit(m_jobs.values().toVector());
+    }
+    m_jobs.clear();
+
+    for(int i = 0; i < cancelled.size(); ++i)
+    {
+        cancelled.at(i).c->setCancelled(p_master_model);
+        emit finished(this, cancelled.at(i).comp, cancelled.at(i).c);
+    }
+
+    emit disconnected(this);
+}
+
+//-----------------------------------------------------------------------------------------------
+// tells the worker to stop evaluating some of the cases
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::cancel(const QVector<Case*> &cases)
+{
+    for(QHash<quint32, CaseScheduler::Job>::const_iterator it = m_jobs.constBegin(); it != m_jobs.constEnd(); ++it)
+    {
+        if(!cases.contains(it.value().c) || m_cancelled_jobs.contains(it.key())) continue;
+
+        QByteArray msg;
+        QDataStream out(&msg, QIODevice::WriteOnly);
+        out.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+        out << quint8(WorkerProtocol::CANCEL) << it.key();
+
+        WorkerProtocol::send(p_socket, msg);
+
+        m_cancelled_jobs.insert(it.key());
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// tells the worker to shut down
+//-----------------------------------------------------------------------------------------------
+void RemoteLauncher::quit()
+{
+    QByteArray msg;
+    QDataStream out(&msg, QIODevice::WriteOnly);
+    out.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+    out << quint8(WorkerProtocol::QUIT);
+
+    WorkerProtocol::send(p_socket, msg);
+    p_socket->flush();
+}
+
+} // namespace ResOpt
@@ -0,0 +1,110 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef REMOTELAUNCHER_H
+#define REMOTELAUNCHER_H
+
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+
+#include "launcher.h"
+#include "casescheduler.h"
+
+class QTcpSocket;
+
+namespace ResOpt
+{
+
+class Model;
+
+
+/**
+ * @brief A Launcher that forwards cases to a worker process.
+ * @details The RemoteLauncher lives in the thread of the master Runner, and pulls cases from the CaseScheduler like the other Launchers.
+ *          Instead of evaluating the cases itself, it sends them to the worker over a socket (see WorkerProtocol). The worker evaluates the
+ *          cases with its own Runner and Launchers, and sends the results back. As many cases as the worker has Launchers are kept in flight.
+ *
+ *          If the worker disconnects, the cases it had not finished are put back in the CaseScheduler, so they are evaluated by someone else.
+ *          Cancelled cases are forwarded to the worker as CANCEL messages, and are not put back in the CaseScheduler.
+ *
+ */
+class RemoteLauncher : public Launcher
+{
+    Q_OBJECT
+private:
+    QTcpSocket *p_socket;
+    Model *p_master_model;                      // the model of the master Runner, used for encoding components
+
+    int m_capacity;                             // number of cases the worker can evaluate at the same time, 0 until HELLO is received
+    quint32 m_next_job_id;
+    QHash<quint32, CaseScheduler::Job> m_jobs;  // jobs sent to the worker, waiting for results
+    QSet<quint32> m_cancelled_jobs;             // jobs in m_jobs that the worker has been told to cancel
+    QByteArray m_buffer;                        // data received from the worker, not yet processed
+
+    void send(quint32 job_id, const CaseScheduler::Job &job);
+    bool processHello(QDataStream &in);     // false if the socket was aborted
+    bool processResult(QDataStream &in);
+
+public:
+    RemoteLauncher(QTcpSocket *s, Model *master_model, QObject *parent = 0);
+    virtual ~RemoteLauncher();
+
+    /**
+     * @brief Tells the worker to stop evaluating the cases in the list that have been sent to it.
+     * @details Sends a CANCEL message for each of the jobs. The results still come back from the worker, and failed results are reported
+     *          as cancelled. Must be called from the thread of the master Runner, where the RemoteLauncher lives.
+     *
+     * @param cases
+     */
+    virtual void cancel(const QVector<Case*> &cases);
+
+    /**
+     * @brief Tells the worker to shut down.
+     *
+     */
+    void quit();
+
+    // get functions
+    int capacity() const {return m_capacity;}
+    int numberOfJobsInFlight() const {return m_jobs.size();}
+
+signals:
+    void disconnected(RemoteLauncher *l);
+
+public slots:
+
+    /**
+     * @brief Sends cases from the CaseScheduler to the worker, until the worker is busy or the queue is empty.
+     *
+     */
+    virtual void work();
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+
+};
+
+} // namespace ResOpt
+
+#endif // REMOTELAUNCHER_H
@@ -0,0 +1,228 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "workerclient.h"
+
+#include <iostream>
+#include <QTcpSocket>
+#include <QDataStream>
+#include <QVector>
+
+#include "workerprotocol.h"
+#include "runner.h"
+#include "model.h"
+#include "case.h"
+#include "casequeue.h"
+#include "component.h"
+#include "evaluationcache.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// seconds to wait for the master to accept the connection
+static const int WORKER_CONNECT_TIMEOUT = 30;
+
+
+WorkerClient::WorkerClient(Runner *r, QObject *parent)
+    : QObject(parent),
+      p_runner(r),
+      p_socket(0),
+      m_res_sim_runs_reported(0)
+{
+    connect(p_runner, SIGNAL(batchFinished(int)), this, SLOT(onBatchFinished(int)));
+}
+
+WorkerClient::~WorkerClient()
+{
+    for(QHash<int, CaseQueue*>::iterator it = m_batch_cases.begin(); it != m_batch_cases.end(); ++it)
+    {
+        CaseQueue *q = it.value();
+        for(int i = 0; i < q->size(); ++i) delete q->at(i);
+        delete q;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// connects to the master
+//-----------------------------------------------------------------------------------------------
+bool WorkerClient::connectToMaster(const QString &host, quint16 port)
+{
+    p_socket = new QTcpSocket(this);
+    p_socket->connectToHost(host, port);
+
+    if(!p_socket->waitForConnected(WORKER_CONNECT_TIMEOUT * 1000))
+    {
+        qWarning("Could not connect to master at %s:%d", host.toLatin1().constData(), port);
+        return false;
+    }
+
+    connect(p_socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(p_socket, SIGNAL(disconnected()), this, SIGNAL(finished()));
+
+    // telling the master what this worker can do
+    Model *m = p_runner->model();
+
+    QByteArray msg;
+    QDataStream out(&msg, QIODevice::WriteOnly);
+    out.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+    out << quint8(WorkerProtocol::HELLO) << WorkerProtocol::VERSION << qint32(p_runner->numberOfLaunchers());
+    out << qint32(m->realVariables().size()) << qint32(m->binaryVariables().size()) << qint32(m->integerVariables().size());
+    out << qint32(m->constraints().size());
+
+    WorkerProtocol::send(p_socket, msg);
+
+    cout << "Connected to master at " << host.toLatin1().constData() << ":" << port << "..." << endl;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// processes the messages from the master
+//-----------------------------------------------------------------------------------------------
+void WorkerClient::onReadyRead()
+{
+    m_buffer.append(p_socket->readAll());
+
+    QByteArray msg;
+    bool ok;
+    while(WorkerProtocol::next(&m_buffer, &msg, &ok))
+    {
+        QDataStream in(msg);
+        in.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+        quint8 type;
+        in >> type;
+
+        if(type == WorkerProtocol::EVALUATE)
+        {
+            // the connection has been closed, the rest of the data is not processed
+            if(!processEvaluate(in))
+            {
+                m_buffer.clear();
+                return;
+            }
+        }
+        else if(type == WorkerProtocol::CANCEL) processCancel(in);
+        else
+        {
+            // QUIT, or something this worker does not understand
+            p_socket->disconnectFromHost();
+            emit finished();
+            return;
+        }
+    }
+
+    if(!ok)
+    {
+        qWarning("Too long message from the master, shutting down");
+        m_buffer.clear();
+        p_socket->abort();
+        emit finished();
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// submits a case from the master to the runner
+//-----------------------------------------------------------------------------------------------
+bool WorkerClient::processEvaluate(QDataStream &in)
+{
+    quint32 job_id;
+    Component *comp;
+    QVector<double> real_vars;
+    QVector<double> binary_vars;
+    QVector<qint32> int_vars;
+
+    in >> job_id;
+    bool ok = WorkerProtocol::decodeComponent(in, p_runner->model(), &comp);
+    in >> real_vars >> binary_vars >> int_vars;
+
+    if(!ok || in.status() != QDataStream::Ok)
+    {
+        qWarning("Could not read case from the master, shutting down");
+        p_socket->disconnectFromHost();
+        emit finished();
+        return false;
+    }
+
+    Case *c = new Case();
+
+    for(int i = 0; i < real_vars.size(); ++i) c->addRealVariableValue(real_vars.at(i));
+    for(int i = 0; i < binary_vars.size(); ++i) c->addBinaryVariableValue(binary_vars.at(i));
+    for(int i = 0; i < int_vars.size(); ++i) c->addIntegerVariableValue(int_vars.at(i));
+
+    CaseQueue *q = new CaseQueue();
+    q->push_back(c);
+
+    int batch_id = p_runner->submit(q, comp);
+
+    m_batch_jobs.insert(batch_id, job_id);
+    m_batch_cases.insert(batch_id, q);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// stops the evaluation of a case from the master
+//-----------------------------------------------------------------------------------------------
+void WorkerClient::processCancel(QDataStream &in)
+{
+    quint32 job_id;
+    in >> job_id;
+
+    // the case may already have finished, the result is then on its way to the master
+    int batch_id = m_batch_jobs.key(job_id, -1);
+    if(in.status() != QDataStream::Ok || batch_id < 0) return;
+
+    p_runner->cancel(batch_id);
+}
+
+//-----------------------------------------------------------------------------------------------
+// sends the result of a case back to the master
+//-----------------------------------------------------------------------------------------------
+void WorkerClient::onBatchFinished(int batch_id)
+{
+    if(!m_batch_jobs.contains(batch_id)) return;
+
+    quint32 job_id = m_batch_jobs.take(batch_id);
+    CaseQueue *q = m_batch_cases.take(batch_id);
+
+    int res_sim_runs = p_runner->numberOfReservoirSimRuns() - m_res_sim_runs_reported;
+    m_res_sim_runs_reported += res_sim_runs;
+
+    QByteArray msg;
+    QDataStream out(&msg, QIODevice::WriteOnly);
+    out.setVersion(WorkerProtocol::DATA_STREAM_VERSION);
+
+    out << quint8(WorkerProtocol::RESULT) << job_id << qint32(res_sim_runs);
+    EvaluationCache::writeCase(out, q->at(0));
+
+    WorkerProtocol::send(p_socket, msg);
+
+    delete q->at(0);
+    delete q;
+}
+
+} // namespace ResOpt
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef WORKERCLIENT_H
+#define WORKERCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+
+class QTcpSocket;
+class QDataStream;
+
+namespace ResOpt
+{
+
+class Runner;
+class CaseQueue;
+
+
+/**
+ * @brief The worker side of the master/worker mode.
+ * @details The WorkerClient connects to a MasterRunner, and evaluates the cases it receives with the Runner of the worker process. The cases
+ *          are submitted to the Runner as they arrive, so all the Launchers of the worker are kept busy. The results are sent back as soon as
+ *          each case has finished. See WorkerProtocol for the messages.
+ *
+ */
+class WorkerClient : public QObject
+{
+    Q_OBJECT
+private:
+    Runner *p_runner;
+    QTcpSocket *p_socket;
+    QByteArray m_buffer;
+
+    QHash<int, quint32> m_batch_jobs;       // job id of the case in each batch submitted to the runner
+    QHash<int, CaseQueue*> m_batch_cases;
+    int m_res_sim_runs_reported;            // number of reservoir simulator runs included in the results sent so far
+
+    bool processEvaluate(QDataStream &in);  // false if the connection was closed
+    void processCancel(QDataStream &in);
+
+public:
+    explicit WorkerClient(Runner *r, QObject *parent = 0);
+    ~WorkerClient();
+
+    /**
+     * @brief Connects to the master, and says hello.
+     *
+     * @param host
+     * @param port
+     * @return bool false if the connection could not be made
+     */
+    bool connectToMaster(const QString &host, quint16 port);
+
+signals:
+
+    /**
+     * @brief Emitted when the master says QUIT, or the connection is lost.
+     *
+     */
+    void finished();
+
+private slots:
+    void onReadyRead();
+    void onBatchFinished(int batch_id);
+
+};
+
+} // namespace ResOpt
+
+#endif // WORKERCLIENT_H
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "workerprotocol.h"
+
+#include <QIODevice>
+#include <QDataStream>
+
+#include "model.h"
+#include "well.h"
+#include "pipe.h"
+#include "component.h"
+
+namespace ResOpt
+{
+
+//-----------------------------------------------------------------------------------------------
+// sends a length prefixed message
+//-----------------------------------------------------------------------------------------------
+void WorkerProtocol::send(QIODevice *d, const QByteArray &msg)
+{
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out.setVersion(DATA_STREAM_VERSION);
+
+    out << quint32(msg.size());
+    frame.append(msg);
+
+    d->write(frame);
+}
+
+//-----------------------------------------------------------------------------------------------
+// takes the next complete message from the buffer
+//-----------------------------------------------------------------------------------------------
+bool WorkerProtocol::next(QByteArray *buffer, QByteArray *msg, bool *ok)
+{
+    *ok = true;
+
+    if(buffer->size() < int(sizeof(quint32))) return false;
+
+    QDataStream in(*buffer);
+    in.setVersion(DATA_STREAM_VERSION);
+    quint32 length;
+    in >> length;
+
+    // checking the length before it is used in any size calculations
+    if(length > MAX_MESSAGE_SIZE)
+    {
+        *ok = false;
+        return false;
+    }
+
+    if(buffer->size() - int(sizeof(quint32)) < int(length)) return false;
+
+    *msg = buffer->mid(sizeof(quint32), length);
+    buffer->remove(0, sizeof(quint32) + length);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// writes a component to a message
+//-----------------------------------------------------------------------------------------------
+void WorkerProtocol::encodeComponent(QDataStream &out, Model *m, Component *comp)
+{
+    if(comp == 0)
+    {
+        out << quint8(MODEL) << qint32(0);
+        return;
+    }
+
+    // wells are identified by their index in the model
+    for(int i = 0; i < m->numberOfWells(); ++i)
+    {
+        if(m->well(i) == comp)
+        {
+            out << quint8(WELL) << qint32(i);
+            return;
+        }
+    }
+
+    // pipes by their number
+    Pipe *p = dynamic_cast<Pipe*>(comp);
+    if(p != 0)
+    {
+        out << quint8(PIPE) << qint32(p->number());
+        return;
+    }
+
+    // not something the worker can evaluate, the worker will reject it
+    out << quint8(0xff) << qint32(0);
+}
+
+//-----------------------------------------------------------------------------------------------
+// finds a component from a message in the model
+//-----------------------------------------------------------------------------------------------
+bool WorkerProtocol::decodeComponent(QDataStream &in, Model *m, Component **comp)
+{
+    quint8 type;
+    qint32 id;
+
+    in >> type >> id;
+
+    *comp = 0;
+
+    if(type == MODEL) return true;
+
+    if(type == WELL)
+    {
+        if(id < 0 || id >= m->numberOfWells()) return false;
+
+        *comp = m->well(id);
+        return true;
+    }
+
+    if(type == PIPE)
+    {
+        for(int i = 0; i < m->numberOfPipes(); ++i)
+        {
+            if(m->pipe(i)->number() == id)
+            {
+                *comp = m->pipe(i);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace ResOpt
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef WORKERPROTOCOL_H
+#define WORKERPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+
+class QIODevice;
+
+namespace ResOpt
+{
+
+class Model;
+class Component;
+
+
+/**
+ * @brief The messages sent between the MasterRunner and the worker processes.
+ * @details Each message is sent as a frame: the length of the message (quint32), followed by the message. Frames longer than
+ *          MAX_MESSAGE_SIZE are a protocol violation, and the connection is dropped. The message is written with
+ *          QDataStream, with the version fixed to DATA_STREAM_VERSION so that the master and the workers may use different Qt builds,
+ *          and starts with the message type (quint8):
+ *
+ *          HELLO (worker -> master): protocol version, number of launchers in the worker, and the number of real, binary and integer
+ *          variables and constraints in the model of the worker. The master only uses workers with the same problem dimensions.
+ *
+ *          EVALUATE (master -> worker): job id, the component to evaluate (see encodeComponent()), and the variable values of the case.
+ *
+ *          RESULT (worker -> master): job id, the number of reservoir simulator runs in the worker since the last RESULT, and the evaluated
+ *          case in the EvaluationCache record format.
+ *
+ *          CANCEL (master -> worker): job id. The worker stops evaluating the case (see Runner::cancel()), and still sends a RESULT for
+ *          it. A failed result for a cancelled job is reported as cancelled on the master.
+ *
+ *          QUIT (master -> worker): the worker should shut down.
+ *
+ */
+class WorkerProtocol
+{
+public:
+    enum MessageType {HELLO = 1, EVALUATE = 2, RESULT = 3, QUIT = 4, CANCEL = 5};
+
+    enum ComponentType {MODEL = 0, WELL = 1, PIPE = 2};
+
+    static const qint32 VERSION = 3;
+
+    static const quint32 MAX_MESSAGE_SIZE = 64 * 1024 * 1024;   // largest message accepted, in bytes
+
+    static const int DATA_STREAM_VERSION = QDataStream::Qt_5_0; // serialization format of the messages
+
+
+    /**
+     * @brief Sends a message as a length prefixed frame.
+     *
+     * @param d
+     * @param msg
+     */
+    static void send(QIODevice *d, const QByteArray &msg);
+
+    /**
+     * @brief Takes the next complete message out of the received data.
+     *
+     * @param buffer data received so far, the message is removed from the front
+     * @param msg the message (output)
+     * @param ok set to false if the next frame is longer than MAX_MESSAGE_SIZE, the connection should then be dropped (output)
+     * @return bool false if the buffer does not hold a complete message yet, or the frame is too long
+     */
+    static bool next(QByteArray *buffer, QByteArray *msg, bool *ok);
+
+    /**
+     * @brief Writes the component to a message, in a form that is valid in another process.
+     * @details Component ids are only unique within a process, so wells are sent by their index in the Model, and pipes by their number.
+     *
+     * @param out
+     * @param m
+     * @param comp null for the entire model
+     */
+    static void encodeComponent(QDataStream &out, Model *m, Component *comp);
+
+    /**
+     * @brief Finds the component written by encodeComponent() in the Model of this process.
+     *
+     * @param in
+     * @param m
+     * @param comp the component, null for the entire model (output)
+     * @return bool false if the component does not exist in the Model
+     */
+    static bool decodeComponent(QDataStream &in, Model *m, Component **comp);
+};
+
+} // namespace ResOpt
+
+#endif // WORKERPROTOCOL_H
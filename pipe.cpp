@@ -72,8 +72,7 @@ void Pipe::initialize(const QVector<double> &schedule)
 {
     m_schedule = schedule;
 
-    clearStreams();
-    for(int i = 0; i < m_schedule.size(); ++i) addStream(new Stream(schedule.at(i), 0, 0, 0, 0));
+    setupStreams(m_schedule);
 
 }
 
@@ -83,14 +82,7 @@ void Pipe::initialize(const QVector<double> &schedule)
 //-----------------------------------------------------------------------------------------------
 void Pipe::emptyStreams()
 {
-    for(int i = 0; i < numberOfStreams(); ++i)
-    {
-        stream(i)->setGasRate(0);
-        stream(i)->setOilRate(0);
-        stream(i)->setWaterRate(0);
-        stream(i)->setPressure(0);
-
-    }
+    streamSeries().zero();
 }
 
 
@@ -130,6 +122,69 @@ void Pipe::cleanFeedConnections()
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Calculates the inlet pressures for all the time steps
+//-----------------------------------------------------------------------------------------------
+void Pipe::calculateInletPressures(const QVector<double> &p_outlet)
+{
+    int n = numberOfStreams();
+    if(n == 0) return;
+
+    // the batch calculation needs all the streams to have the same units
+    Stream::units unit = stream(0)->inputUnits();
+    bool same_units = true;
+
+    for(int i = 1; i < n; ++i)
+    {
+        if(stream(i)->inputUnits() != unit)
+        {
+            same_units = false;
+            break;
+        }
+    }
+
+    if(!same_units)
+    {
+        for(int i = 0; i < n; ++i)
+        {
+            Stream::units u = stream(i)->inputUnits();
+            double p_out = Stream::fromFieldUnits<Units::Pressure>(p_outlet.at(i), u);
+
+            double dp = calculator()->pressureDrop(stream(i), p_out, u);
+            stream(i)->setPressure(dp + p_out);
+        }
+
+        return;
+    }
+
+
+    // collecting the rates and outlet pressures in the units of the streams, the conversion factors are the same for all the time steps
+    double f_liquid = Units::factor<Units::LiquidRate>(Units::FIELD, static_cast<Units::system>(unit));
+    double f_gas = Units::factor<Units::GasRate>(Units::FIELD, static_cast<Units::system>(unit));
+    double f_pres = Units::factor<Units::Pressure>(Units::FIELD, static_cast<Units::system>(unit));
+
+    m_qo.resize(n);
+    m_qg.resize(n);
+    m_qw.resize(n);
+    m_p.resize(n);
+    m_dp.resize(n);
+
+    for(int i = 0; i < n; ++i)
+    {
+        m_qo[i] = stream(i)->oilRate<Units::FIELD>().value() * f_liquid;
+        m_qg[i] = stream(i)->gasRate<Units::FIELD>().value() * f_gas;
+        m_qw[i] = stream(i)->waterRate<Units::FIELD>().value() * f_liquid;
+        m_p[i] = p_outlet.at(i) * f_pres;
+    }
+
+    // calculating the pressure drops for all the time steps
+    calculator()->pressureDrops(n, m_qo.constData(), m_qg.constData(), m_qw.constData(), m_p.constData(), unit, m_dp.data());
+
+    // setting the inlet pressures, converting the pressure drops back to field units
+    for(int i = 0; i < n; ++i) stream(i)->setPressure(Units::Psia(m_dp.at(i) / f_pres + p_outlet.at(i)));
+
+}
+
 //-----------------------------------------------------------------------------------------------
 // Calculates the inlet pressures for all the pipes in the branch
 //-----------------------------------------------------------------------------------------------
@@ -54,6 +54,12 @@ private:
     QVector<ProductionWell*> m_feed_wells;          // pointers to wells entering this pipe directly
     QVector<double> m_schedule;                     // a copy of the master schedule set in the model
 
+    QVector<double> m_qo;                           // work vectors for the batch pressure drop calculation
+    QVector<double> m_qg;
+    QVector<double> m_qw;
+    QVector<double> m_p;
+    QVector<double> m_dp;
+
 
 
     /**
@@ -73,6 +79,19 @@ private:
     bool isEmpty(const QStringList &list);
 
 
+protected:
+
+    /**
+     * @brief Calculates and sets the inlet pressures for all the time steps, given the outlet pressures.
+     * @details The pressure drops for all the time steps are calculated in one call to PressureDropCalculator::pressureDrops().
+     *          The outlet pressures are passed between the components in field units, and are only converted to the input units of
+     *          the streams for the calculator.
+     *
+     * @param p_outlet outlet pressure for each time step (psia)
+     */
+    void calculateInletPressures(const QVector<double> &p_outlet);
+
+
 public:
     Pipe();
     Pipe(const Pipe &p);
@@ -5,6 +5,9 @@
 #include "beggsbrillcalculator.h"
 #include "dptablecalculator.h"
 #include "dptable.h"
+#include "tablefile.h"
+
+#include <QMutexLocker>
 
 using std::cout;
 using std::endl;
@@ -25,6 +28,24 @@ PressureDropCalculator* PipeReader::readFile(const QString &file_name)
     PressureDropCalculator *calc = 0;
 
 
+    // only one launcher compiles the table, the others use the compiled file when it is done
+    QMutexLocker locker(TableFile::compileMutex());
+
+    // using the compiled dp table if it is up to date with the input file
+    shared_ptr<TableFile> table_file = TableFile::open(file_name + ".bin", file_name);
+
+    if(table_file != 0 && table_file->numberOfTables() == 1 && table_file->numberOfAxes(0) == 3 && table_file->numberOfGrids(0) == 1)
+    {
+        DpTableCalculator *dpc = new DpTableCalculator();
+        DpTable *table = new DpTable();
+
+        table->setTableFile(table_file, 0);
+        dpc->setDpTable(table);
+
+        return dpc;
+    }
+
+
     // opening the input file
     QFile input(file_name);
 
@@ -91,6 +112,7 @@ BeggsBrillCalculator* PipeReader::readBeggsBrill(QFile &file)
     double l_den_wat = 0.0;
     double l_vis_oil = 0.0;
     double l_vis_wat = 0.0;
+    BeggsBrillCalculator::z_factor_mode l_z_mode = BeggsBrillCalculator::ZTABLE;
 
 
     bool ok = true;
@@ -110,6 +132,13 @@ BeggsBrillCalculator* PipeReader::readBeggsBrill(QFile &file)
         else if(list.at(0).startsWith("WATERDENSITY")) l_den_wat = list.at(1).toDouble(&ok);    // getting the water den
         else if(list.at(0).startsWith("OILVISCOSITY")) l_vis_oil = list.at(1).toDouble(&ok);    // getting the oil visc
         else if(list.at(0).startsWith("WATERVISCOSITY")) l_vis_wat = list.at(1).toDouble(&ok);  // getting the water visc
+        else if(list.at(0).startsWith("ZFACTOR"))                                               // getting how to find the gas z-factor
+        {
+            if(list.at(1).startsWith("TABLE")) l_z_mode = BeggsBrillCalculator::ZTABLE;
+            else if(list.at(1).startsWith("EXACT")) l_z_mode = BeggsBrillCalculator::EXACT;
+            else if(list.at(1).startsWith("CHECK")) l_z_mode = BeggsBrillCalculator::CHECK;
+            else ok = false;
+        }
         else
         {
             if(!isEmpty(list))
@@ -155,6 +184,7 @@ BeggsBrillCalculator* PipeReader::readBeggsBrill(QFile &file)
     bb->setTemperature(l_temperature);
     bb->setWaterDensity(l_den_wat);
     bb->setWaterViscosity(l_vis_wat);
+    bb->setZFactorMode(l_z_mode);
 
 
     return bb;
@@ -231,6 +261,11 @@ DpTableCalculator* PipeReader::readDpTable(QFile &file)
 
     cout << "Added " << table->numberOfRows() << " rows to the table..." << endl;
 
+    // writing the compiled table, used the next time the file is read
+    if(table->numberOfRows() > 0)
+    {
+        table->setTableFile(TableFile::create(file.fileName() + ".bin", file.fileName(), QList<TableFile::TableData>() << table->compile()), 0);
+    }
 
     dpc->setDpTable(table);
 
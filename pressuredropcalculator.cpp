@@ -32,4 +32,22 @@ PressureDropCalculator::PressureDropCalculator()
 PressureDropCalculator::~PressureDropCalculator()
 {}
 
+//-----------------------------------------------------------------------------------------------
+// calculates the pressure drops for a list of points, one at the time
+//-----------------------------------------------------------------------------------------------
+void PressureDropCalculator::pressureDrops(int n, const double *qo, const double *qg, const double *qw, const double *p_outlet, Stream::units unit, double *dp)
+{
+    Stream s;
+    s.setInputUnits(unit);
+
+    for(int i = 0; i < n; ++i)
+    {
+        s.setOilRate(qo[i]);
+        s.setGasRate(qg[i]);
+        s.setWaterRate(qw[i]);
+
+        dp[i] = pressureDrop(&s, p_outlet[i], unit);
+    }
+}
+
 } // namespace ResOpt
@@ -42,6 +42,22 @@ public:
 
 
     virtual double pressureDrop(Stream *s, double p_outlet, Stream::units unit) = 0;
+
+    /**
+     * @brief Calculates the pressure drops for a list of rates and outlet pressures in one go.
+     * @details The rates and outlet pressures are given as separate arrays (structure of arrays), all in the units given by unit, and the
+     *          pressure drop for point i is written to dp[i]. The points are typically all the time steps of a pipe. The default implementation
+     *          calls pressureDrop() for each point, calculators with an expensive pressureDrop() should override it.
+     *
+     * @param n number of points
+     * @param qo oil rates
+     * @param qg gas rates
+     * @param qw water rates
+     * @param p_outlet outlet pressures
+     * @param unit
+     * @param dp output, the pressure drops
+     */
+    virtual void pressureDrops(int n, const double *qo, const double *qg, const double *qw, const double *p_outlet, Stream::units unit, double *dp);
 };
 
 } // namespace ResOpt
@@ -188,7 +188,7 @@ void ProductionWell::updateBhpConstraint()
             double tot_frac = 0;
             for(int j = 0; j < numberOfPipeConnections(); ++j)
             {
-                p_in += pipeConnection(j)->variable()->value() * pipeConnection(j)->pipe()->stream(i)->pressure(stream(i)->inputUnits());
+                p_in += pipeConnection(j)->variable()->value() * pipeConnection(j)->pipe()->stream(i)->pressure<Units::FIELD>().value();
                 tot_frac += pipeConnection(j)->variable()->value();
             }
 
@@ -205,7 +205,7 @@ void ProductionWell::updateBhpConstraint()
 
 
             // calculating constraint value
-            double p_wf = stream(i)->pressure(true);
+            double p_wf = stream(i)->pressure<Units::FIELD>().value();   // same units as p_in
             if(p_wf < 0.001) p_wf = 0.001;
 
             c_ts = (p_wf - p_in) / p_wf;
@@ -27,6 +27,7 @@ namespace ResOpt
 Reservoir::Reservoir()
     : m_use_mrst_script(false),
       m_keep_mat_file(false),
+      m_resident_matlab(false),
       m_gas_phase(false),
       m_oil_phase(false),
       m_wat_phase(false),
@@ -47,6 +48,7 @@ QString Reservoir::description() const
     str.append(" MRST " + mrstPath() + "\n");
     str.append(" MATLAB " + matlabPath() + "\n");
     str.append(" SCRIPT " + mrstScript() + "\n");
+    if(residentMatlab()) str.append(" RESIDENT_MATLAB\n");
 
     str.append(" TIME " + QString::number(endTime()) + "\n");
 
@@ -44,6 +44,7 @@ private:
     QString m_mrst_script;
     bool m_use_mrst_script;
     bool m_keep_mat_file;
+    bool m_resident_matlab;     // true if MATLAB is kept running between runs
     double m_endtime; /**< TODO */
 
     bool m_gas_phase;
@@ -84,6 +85,7 @@ public:
     void setMatlabPath(const QString &p) {m_matlab_path = p;}
     void setMrstScript(const QString &s) {m_mrst_script = s; m_use_mrst_script = true;}
     void setKeepMatFile(bool b) {m_keep_mat_file = b;}
+    void setResidentMatlab(bool b) {m_resident_matlab = b;}
     void setUseMrstScript(bool b) {m_use_mrst_script = b;}
 
     /**
@@ -127,6 +129,7 @@ public:
     QString mrstScript() const {return m_mrst_script;}
     bool useMrstScript() const {return m_use_mrst_script;}
     bool keepMatFile() const {return m_keep_mat_file;}
+    bool residentMatlab() const {return m_resident_matlab;}
 
     /**
      * @brief Returns the end time of the simulation
@@ -21,19 +21,63 @@
 
 #include "reservoirsimulator.h"
 
+#include <iostream>
+#include <QProcess>
+#include <QElapsedTimer>
+
+using std::cout;
+using std::endl;
+
 namespace ResOpt
 {
 
+// milliseconds between each check for timeout and cancellation while a simulator process is running
+static const int PROCESS_POLL_INTERVAL = 500;
+
 
 ReservoirSimulator::ReservoirSimulator()
+    : m_timeout(0),
+      m_cancelled(0)
 {}
 
 ReservoirSimulator::ReservoirSimulator(const ReservoirSimulator &r)
+    : m_cancelled(0)
 {
     m_folder = r.m_folder;
+    m_timeout = r.m_timeout;
 }
 
 ReservoirSimulator::~ReservoirSimulator()
 {}
 
+//-----------------------------------------------------------------------------------------------
+// waits for a simulator process, killing it on timeout or cancellation
+//-----------------------------------------------------------------------------------------------
+bool ReservoirSimulator::waitForProcess(QProcess *p)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while(!p->waitForFinished(PROCESS_POLL_INTERVAL))
+    {
+        // the process has already finished, or never started
+        if(p->state() == QProcess::NotRunning) break;
+
+        bool timed_out = m_timeout > 0 && timer.elapsed() > 1000 * qint64(m_timeout);
+
+        if(timed_out || isCancelled())
+        {
+            if(timed_out) cout << "Simulator run timed out after " << m_timeout << " seconds..." << endl;
+            else cout << "Simulator run cancelled..." << endl;
+
+            p->kill();
+            p->waitForFinished(-1);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace ResOpt
@@ -23,6 +23,9 @@
 #define RESERVOIRSIMULATOR_H
 
 #include <QString>
+#include <QAtomicInt>
+
+class QProcess;
 
 
 
@@ -36,12 +39,28 @@ class Model;
 
 /**
  * @brief Abstract base class for interfaces to reservoir simulators.
+ * @details A simulator run may be limited by a wall-clock timeout, and may be cancelled from another thread through cancel(). Sub classes
+ *          that run the simulator in a separate process should wait for it through waitForProcess(), which kills the process when the
+ *          run times out or is cancelled, so that launchSimulator() returns false instead of blocking the Launcher.
  *
  */
 class ReservoirSimulator
 {
 private:
     QString m_folder;
+    int m_timeout;              // maximum number of seconds for a simulator run, 0 = no limit
+    QAtomicInt m_cancelled;
+
+protected:
+
+    /**
+     * @brief Waits for a simulator process to finish.
+     * @details The process is killed if it runs for longer than the timeout, or if the run is cancelled.
+     *
+     * @param p
+     * @return bool false if the process was killed
+     */
+    bool waitForProcess(QProcess *p);
 
 public:
     ReservoirSimulator();
@@ -59,11 +78,26 @@ public:
     virtual bool launchSimulator() = 0;
     virtual bool readOutput(Model *m) = 0;
 
+    /**
+     * @brief Cancels the current simulator run. May be called from any thread.
+     *
+     */
+    void cancel() {m_cancelled.storeRelease(1);}
+
+    /**
+     * @brief Clears a cancellation, called by the Launcher before each run.
+     *
+     */
+    void resetCancelled() {m_cancelled.storeRelease(0);}
+
     // set functions
     void setFolder(const QString &f) {m_folder = f;}
+    void setTimeout(int seconds) {m_timeout = seconds;}
 
     // get functions
     const QString& folder() {return m_folder;}
+    int timeout() const {return m_timeout;}
+    bool isCancelled() const {return m_cancelled.loadAcquire() != 0;}
 
 };
 
@@ -26,6 +26,11 @@
 #include <QThread>
 #include <QDir>
 #include <QEventLoop>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStringList>
+#include <QSet>
 
 #include "launcher.h"
 #include "modelreader.h"
@@ -51,12 +56,16 @@
 #include "case.h"
 #include "cost.h"
 #include "logger.h"
+#include "evaluationcache.h"
+#include "casescheduler.h"
+#include "summarylog.h"
 
 // needed for debug
 #include "productionwell.h"
 #include "userconstraint.h"
 #include "vlpsimulator.h"
 #include "vlptable.h"
+#include "adjointscoupledmodel.h"
 
 
 
@@ -67,9 +76,17 @@ using std::endl;
 namespace ResOpt
 {
 
+// identifies the checkpoint file format
+static const quint32 CHECKPOINT_MAGIC = 0x52534f4b;
+static const qint32 CHECKPOINT_VERSION = 3;
+
+const double Runner::FEASIBILITY_TOLERANCE = 0.0001;
+
 
 Runner::Runner(const QString &driver_file, QObject *parent)
     : QObject(parent),
+      p_scheduler(0),
+      m_next_batch_id(0),
       p_reader(0),
       p_model(0),
       p_simulator(0),
@@ -78,16 +95,23 @@ Runner::Runner(const QString &driver_file, QObject *parent)
       p_debug(0),
       m_number_of_runs(1),
       m_number_of_res_sim_runs(0),
-      p_cases(0),
+      p_cache(0),
       p_last_run_launcher(0),
       m_paused(false),
       m_debug(false),
       m_debug_case(0),
-      p_best_case(0)
+      p_best_case(0),
+      p_incumbent(0),
+      m_checkpoint_interval(600),
+      m_last_checkpoint(0),
+      m_resume(false),
+      m_resumed_time(0)
 
 {
     p_reader = new ModelReader(driver_file);
     p_logger = new Logger(Logger::CONSOLE, this);
+    p_cache = new EvaluationCache();
+    p_scheduler = new CaseScheduler();
 }
 
 Runner::~Runner()
@@ -102,8 +126,10 @@ Runner::~Runner()
     for(int i = 0; i < m_launchers.size(); ++i) delete m_launchers.at(i);
 
     if(p_best_case != 0) delete p_best_case;
+    if(p_incumbent != 0) delete p_incumbent;
 
-
+    if(p_cache != 0) delete p_cache;
+    if(p_scheduler != 0) delete p_scheduler;
 
 }
 
@@ -124,6 +150,11 @@ void Runner::initialize()
     // reading the pipe pressure drop definition files
     p_model->readPipeFiles();
 
+    // identifying the problem, for checkpoints and cache files
+    computeFingerprint();
+
+    // connecting the evaluation cache to its file, cases from a different problem are discarded
+    if(!m_cache_file.isEmpty()) p_cache->setFile(m_cache_file, m_fingerprint);
 
 
     // validating the model
@@ -179,8 +210,8 @@ void Runner::initialize()
     if(p_optimizer == 0) p_optimizer = new RunonceOptimizer(this);
 
 
-    // setting up the summary file
-    setSummaryFile("run_summary.out");
+    // setting up the summary file, a resumed run continues the old one
+    setSummaryFile("run_summary.bin");
 
 
 
@@ -190,6 +221,25 @@ void Runner::initialize()
 
     p_optimizer->initialize();
 
+
+    // restoring the state of an interrupted run
+    if(m_resume)
+    {
+        if(m_checkpoint_file.isEmpty())
+        {
+            cout << endl << "### Runtime Error ###" << endl
+                 << "Can not resume the run, no CHECKPOINT file is given in the driver file..." << endl << endl;
+            exit(1);
+        }
+
+        if(!readCheckpoint())
+        {
+            cout << endl << "### Runtime Error ###" << endl
+                 << "Could not resume the run from the checkpoint file: " << m_checkpoint_file.toLatin1().constData() << endl << endl;
+            exit(1);
+        }
+    }
+
     cout << "Done initializing the model..." << endl;
 
 
@@ -213,7 +263,7 @@ void Runner::initializeLaunchers()
     */
     m_threads.resize(0);
 
-    m_launcher_running.resize(0);
+    p_scheduler->clear();
 
 
 
@@ -264,8 +314,14 @@ void Runner::initializeLaunchers()
             exit(1);
         }
 
+        // the launcher pulls its cases from the scheduler
+        l->setScheduler(p_scheduler);
+        p_scheduler->addLauncher(l);
+
         // connecting signals and slots
-        connect(l, SIGNAL(finished(Launcher*, Component*, Case*)), this, SLOT(onLauncherFinished(Launcher*, Component*, Case*)));
+        // when debugging, the launcher waits for the debug info to be printed before continuing with the next case
+        Qt::ConnectionType finished_type = (p_debug != 0) ? Qt::BlockingQueuedConnection : Qt::QueuedConnection;
+        connect(l, SIGNAL(finished(Launcher*, Component*, Case*)), this, SLOT(onLauncherFinished(Launcher*, Component*, Case*)), finished_type);
         connect(l, SIGNAL(runningReservoirSimulator()), this, SLOT(incrementReservoirSimRuns()));
 
 
@@ -277,7 +333,6 @@ void Runner::initializeLaunchers()
 
         // adding launcher and thread to the vectors
         m_launchers.push_back(l);
-        m_launcher_running.push_back(false);
         m_threads.push_back(t);
 
 
@@ -292,17 +347,46 @@ void Runner::initializeLaunchers()
 
 
 //-----------------------------------------------------------------------------------------------
-// Main control loop
+// lets a launcher owned by someone else pull cases from the scheduler
 //-----------------------------------------------------------------------------------------------
-void Runner::run()
+void Runner::addExternalLauncher(Launcher *l)
 {
-    writeProblemDefToSummary();
+    l->setScheduler(p_scheduler);
+    p_scheduler->addLauncher(l);
+
+    connect(l, SIGNAL(finished(Launcher*, Component*, Case*)), this, SLOT(onLauncherFinished(Launcher*, Component*, Case*)), Qt::QueuedConnection);
+    connect(l, SIGNAL(runningReservoirSimulator()), this, SLOT(incrementReservoirSimRuns()));
+
+    // picking up cases that are already waiting
+    QMetaObject::invokeMethod(l, "work", Qt::QueuedConnection);
+}
+
+//-----------------------------------------------------------------------------------------------
+// removes a launcher added with addExternalLauncher()
+//-----------------------------------------------------------------------------------------------
+void Runner::removeExternalLauncher(Launcher *l)
+{
+    p_scheduler->removeLauncher(l);
+
+    disconnect(l, 0, this, 0);
+
+    if(p_last_run_launcher == l) p_last_run_launcher = 0;
+}
 
-    m_start_time = time(NULL);     // storing the start time of the run
 
+//-----------------------------------------------------------------------------------------------
+// Main control loop
+//-----------------------------------------------------------------------------------------------
+void Runner::run()
+{
     // checking if the model has been initialized
     if(p_model == 0) initialize();
 
+    writeProblemDefToSummary();
+
+    m_start_time = time(NULL) - time_t(m_resumed_time);     // storing the start time of the run
+    m_last_checkpoint = time(NULL);
+
 
     // starting the optimizer
     p_optimizer->start();
@@ -321,27 +405,7 @@ bool Runner::runFromCase(Case *starting_point)
 
 
     // setting the starting point according to the case
-    if(starting_point->numberOfBinaryVariables() != model()->binaryVariables().size()) return false;
-    if(starting_point->numberOfIntegerVariables() != model()->integerVariables().size()) return false;
-    if(starting_point->numberOfRealVariables() != model()->realVariables().size()) return false;
-
-    // binary variables
-    for(int i = 0; i < starting_point->numberOfBinaryVariables(); ++i)
-    {
-        model()->binaryVariables().at(i)->setValue(starting_point->binaryVariableValue(i));
-    }
-
-    // integer variables
-    for(int i = 0; i < starting_point->numberOfIntegerVariables(); ++i)
-    {
-        model()->integerVariables().at(i)->setValue(starting_point->integerVariableValue(i));
-    }
-
-    // real variables
-    for(int i = 0; i < starting_point->numberOfRealVariables(); ++i)
-    {
-        model()->realVariables().at(i)->setValue(starting_point->realVariableValue(i));
-    }
+    if(!setModelVariables(starting_point)) return false;
 
 
     // starting the optimization
@@ -354,288 +418,252 @@ bool Runner::runFromCase(Case *starting_point)
 
 
 //-----------------------------------------------------------------------------------------------
-// Running a set of cases for the optimizer
+// Hashes the driver file and the input files it refers to
 //-----------------------------------------------------------------------------------------------
-void Runner::evaluate(CaseQueue *cases, Component *comp)
+void Runner::computeFingerprint()
 {
-    // TODO: checking that none of the launchers are working
-
-
-    // updating the case queue
-    p_cases = cases;
-
-
-    // sending out the first batch of cases to the launchers
-    for(int i = 0; i < m_launchers.size(); ++i)
+    QStringList files;
+    files.push_back(p_reader->driverFileName());
+    if(p_model->reservoir() != 0) files.push_back(p_model->driverPath() + "/" + p_model->reservoir()->file());
+    for(int i = 0; i < p_model->numberOfPipes(); ++i)
     {
-        Case *c = p_cases->next();
-        if(c != 0)
-        {
-            m_launcher_running.replace(i, true);
-
-            // connecting the launcher
-            connect(this, SIGNAL(sendCase(Case*, Component*)), m_launchers.at(i), SLOT(evaluate(Case*, Component*)));
-
-            // sending the case to the launcher
-            emit sendCase(c, comp);
+        if(!p_model->pipe(i)->fileName().isEmpty()) files.push_back(p_model->pipe(i)->fileName());
+    }
 
-            // disconnecting the launcher
-            disconnect(this, SIGNAL(sendCase(Case*, Component*)), m_launchers.at(i), SLOT(evaluate(Case*, Component*)));
+    QCryptographicHash hash(QCryptographicHash::Sha1);
 
-        }
-        else break; // no more cases to run
+    for(int i = 0; i < files.size(); ++i)
+    {
+        QFile file(files.at(i));
 
+        // a missing file is part of the fingerprint too
+        if(file.open(QIODevice::ReadOnly)) hash.addData(file.readAll());
+        hash.addData(QByteArray(1, '\0'));
     }
 
+    m_fingerprint = hash.result();
 }
 
-
-
 //-----------------------------------------------------------------------------------------------
-// Initializes the summary file
+// Checks if the model produces derivatives
 //-----------------------------------------------------------------------------------------------
-void Runner::setSummaryFile(const QString &f)
+bool Runner::needsDerivatives()
 {
-    p_summary = new QFile(p_simulator->folder() + "/" + f);
-
-    if(!p_summary->open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        qWarning("Could not connect to summary file: %s", p_summary->fileName().toLatin1().constData());
-
-        delete p_summary;
-        p_summary = 0;
-    }
-    else
-    {
-        // deleting content from previous launches
-        p_summary->resize(0);
-    }
-
+    return dynamic_cast<AdjointsCoupledModel*>(p_model) != 0;
 }
 
 //-----------------------------------------------------------------------------------------------
-// Initializes the debug file
+// Checks if the number of variables in a case matches the model
 //-----------------------------------------------------------------------------------------------
-void Runner::setDebugFileName(const QString &f)
+bool Runner::matchesModel(Case *c)
 {
+    return c->numberOfBinaryVariables() == model()->binaryVariables().size() &&
+           c->numberOfIntegerVariables() == model()->integerVariables().size() &&
+           c->numberOfRealVariables() == model()->realVariables().size();
+}
 
-    m_debug = true;
-
-    m_debug_filename = f;
-
-    p_debug = new QFile(f);
-
+//-----------------------------------------------------------------------------------------------
+// Sets the variable values of the model to the values in a case
+//-----------------------------------------------------------------------------------------------
+bool Runner::setModelVariables(Case *c)
+{
+    if(!matchesModel(c)) return false;
 
-    if(!p_debug->open(QIODevice::WriteOnly | QIODevice::Text))
+    // binary variables
+    for(int i = 0; i < c->numberOfBinaryVariables(); ++i)
     {
-        qWarning("Could not connect to debug file: %s", p_debug->fileName().toLatin1().constData());
-
-        delete p_debug;
-        p_debug = 0;
+        model()->binaryVariables().at(i)->setValue(c->binaryVariableValue(i));
     }
-    else
+
+    // integer variables
+    for(int i = 0; i < c->numberOfIntegerVariables(); ++i)
     {
-        // deleting content from previous launches
-        p_debug->resize(0);
+        model()->integerVariables().at(i)->setValue(c->integerVariableValue(i));
     }
 
+    // real variables
+    for(int i = 0; i < c->numberOfRealVariables(); ++i)
+    {
+        model()->realVariables().at(i)->setValue(c->realVariableValue(i));
+    }
 
-
+    return true;
 }
 
-
 //-----------------------------------------------------------------------------------------------
-// Writes the problem definition to the summary file
+// Submits a set of cases for evaluation
 //-----------------------------------------------------------------------------------------------
-void Runner::writeProblemDefToSummary()
+int Runner::submit(CaseQueue *cases, Component *comp)
 {
-    if(p_summary != 0)
-    {
-        QTextStream out(p_summary);
-
-        out << "----------------------------------------------------------------------\n";
-        out << "------------------------ ResOpt Summary File -------------------------\n";
-        out << "----------------------------------------------------------------------\n\n";
-
-        out << "MODEL DESCRIPTION:" << "\n";
-        out << "Number of wells      = " << p_model->numberOfWells() << "\n";
-        out << "Number of pipes      = " << p_model->numberOfPipes() << "\n";
-        out << "Number of separators = " << p_model->numberOfCapacities() << "\n\n";
-
+    int batch_id = m_next_batch_id++;
 
-        QVector<shared_ptr<BinaryVariable> >  binary_vars = p_model->binaryVariables();
-        QVector<shared_ptr<RealVariable> > real_vars = p_model->realVariables();
-        QVector<shared_ptr<IntVariable> > int_vars = p_model->integerVariables();
-        QVector<shared_ptr<Constraint> > cons = p_model->constraints();
+    Batch b;
+    b.cases = cases;
+    b.comp = comp;
+    b.remaining = 0;
 
+    // finding the cases that must be sent to the launchers
+    QVector<CaseScheduler::Job> jobs;
+    QSet<Case*> submitted;
 
-        out << "OPTIMIZATION PROBLEM:" << "\n";
-        out << "Number of contineous variables  = " << real_vars.size() << "\n";
-        out << "Number of binary variables      = " << binary_vars.size() << "\n";
-        out << "Number of constraints           = " << cons.size() << "\n\n";
+    for(int i = 0; i < cases->size(); ++i)
+    {
+        Case *c = cases->at(i);
 
-        out << "CONTINEOUS VARIABLES:" << "\n";
-        for(int i = 0; i < real_vars.size(); ++i)
-        {
-            out << "VAR_C" << i +1 << ": " << real_vars.at(i)->name();
-            out << ", bounds: (" << real_vars.at(i)->min() << " < " << real_vars.at(i)->value() << " < " << real_vars.at(i)->max() << ")\n";
-        }
-        out << "\n";
+        // a case that is listed more than once in the batch is only evaluated once
+        if(submitted.contains(c)) continue;
+        submitted.insert(c);
 
-        out << "BINARY VARIABLES:" << "\n";
-        for(int i = 0; i < binary_vars.size(); ++i)
+        // the same case can not be evaluated by two launchers at the same time
+        if(m_case_batch.contains(c))
         {
-            out << "VAR_B" << i +1 << ": " << binary_vars.at(i)->name();
-            out << ", bounds: (" << binary_vars.at(i)->min() << " < " << binary_vars.at(i)->value() << " < " << binary_vars.at(i)->max() << ")\n";
+            cout << endl << "### Runtime Error ###" << endl
+                 << "A case was submitted for evaluation while it is still being evaluated in another batch..." << endl << endl;
+            exit(1);
         }
 
-        out << "\n";
-
-        out << "INTEGER VARIABLES:" << "\n";
-        for(int i = 0; i < int_vars.size(); ++i)
+        // only evaluations of the entire model are cached
+        if(comp == 0 && p_cache->lookup(c, needsDerivatives()))
         {
-            out << "VAR_I" << i +1 << ": " << int_vars.at(i)->name();
-            out << ", bounds: (" << int_vars.at(i)->min() << " < " << int_vars.at(i)->value() << " < " << int_vars.at(i)->max() << ")\n";
+            cout << "Case found in the evaluation cache, no need to evaluate the model..." << endl;
+            emit newCaseFinished(c);
         }
-
-        out << "\n";
-
-        out << "CONSTRAINTS:" << "\n";
-        for(int i = 0; i < cons.size(); i++)
+        else
         {
-            out << "CON" << i +1 << ": " << cons.at(i)->name();
-            out << ", bounds: (" << cons.at(i)->min() << " < c < " << cons.at(i)->max() << ")\n";
+            jobs.push_back(CaseScheduler::Job(c, comp));
+            m_case_batch.insert(c, batch_id);
+            ++b.remaining;
         }
+    }
 
+    m_batches.insert(batch_id, b);
 
-        out << "\nMODEL EVALUATIONS:" << "\n";
-        out << "----------------------------------------------------------------------\n";
-
-
-        // header
-
-        out << "#\t" << "FEAS\t" << "OBJ\t";
-
-
-        for(int i = 0; i < real_vars.size(); ++i)
-        {
-            out << "VAR_C" << i +1 << "\t";
-        }
+    // if all the cases were found in the cache, the batch is finished
+    // (this is queued, since the caller has not started waiting for the signals yet)
+    if(b.remaining == 0) QMetaObject::invokeMethod(this, "onBatchFinished", Qt::QueuedConnection, Q_ARG(int, batch_id));
+    else p_scheduler->submit(jobs);
 
-        for(int i = 0; i < binary_vars.size(); ++i)
-        {
-            out << "VAR_B" << i + 1 << "\t";
-        }
+    return batch_id;
+}
 
-        for(int i = 0; i < int_vars.size(); ++i)
-        {
-            out << "VAR_I" << i + 1 << "\t";
-        }
+//-----------------------------------------------------------------------------------------------
+// Cancels the unfinished cases in a batch
+//-----------------------------------------------------------------------------------------------
+void Runner::cancel(int batch_id)
+{
+    if(!m_batches.contains(batch_id)) return;
 
+    Batch &b = m_batches[batch_id];
 
-        for(int i = 0; i < cons.size(); ++i)
-        {
-            out << "CON" << i +1 << "\t";
-        }
+    // finding the cases that have not finished yet
+    QVector<Case*> unfinished;
 
+    for(int i = 0; i < b.cases->size(); ++i)
+    {
+        if(m_case_batch.value(b.cases->at(i), -1) == batch_id) unfinished.push_back(b.cases->at(i));
+    }
 
-        out << "\n";
+    if(unfinished.isEmpty()) return;
 
+    cout << "Cancelling " << unfinished.size() << " unfinished cases..." << endl;
 
-        p_summary->flush();
+    // the running cases come back through onLauncherFinished(), the waiting ones are finished here
+    QVector<Case*> removed = p_scheduler->cancel(unfinished);
 
+    for(int i = 0; i < removed.size(); ++i)
+    {
+        removed.at(i)->setCancelled(model());
+        m_case_batch.remove(removed.at(i));
+        --b.remaining;
     }
+
+    // (this is queued, the caller may not have started waiting for the signals yet)
+    if(b.remaining == 0) QMetaObject::invokeMethod(this, "onBatchFinished", Qt::QueuedConnection, Q_ARG(int, batch_id));
 }
 
 //-----------------------------------------------------------------------------------------------
-// Writes the results from the current iteration to the summary file
+// Running a set of cases for the optimizer
 //-----------------------------------------------------------------------------------------------
-void Runner::writeCasesToSummary()
+void Runner::evaluate(CaseQueue *cases, Component *comp)
 {
-    if(p_summary != 0)
-    {
-        QTextStream out(p_summary);
-        out.setRealNumberPrecision(8);
-
-        // looping through the cases, writing to sumary
-
-        for(int i = 0; i < p_cases->size(); ++i)
-        {
-            Case *c = p_cases->at(i);
-
-            bool feas = isFeasible(c);
+    submit(cases, comp);
+}
 
-            // run #
-            out << m_number_of_runs << "\t";
 
-            // is feasible?
-            if(feas) out << "yes\t";
-            else out << "no\t";
 
-            // objective value
-            out << c->objectiveValue() << "\t";
+//-----------------------------------------------------------------------------------------------
+// Initializes the summary file
+//-----------------------------------------------------------------------------------------------
+void Runner::setSummaryFile(const QString &f)
+{
+    if(p_summary != 0) delete p_summary;
 
-            // real variables
-            for(int j = 0; j < c->numberOfRealVariables(); ++j)
-            {
-                out << c->realVariableValue(j) << "\t";
-            }
+    p_summary = new SummaryLog();
 
-            // binary variables
-            for(int j = 0; j < c->numberOfBinaryVariables(); ++j)
-            {
-                out << c->binaryVariableValue(j) << "\t";
-            }
+    if(!p_summary->open(p_simulator->folder() + "/" + f, m_resume))
+    {
+        delete p_summary;
+        p_summary = 0;
+    }
 
-            // integer variables
-            for(int j = 0; j < c->numberOfIntegerVariables(); ++j)
-            {
-                out << c->integerVariableValue(j) << "\t";
-            }
+}
 
+//-----------------------------------------------------------------------------------------------
+// Connects the evaluation cache to a file
+//-----------------------------------------------------------------------------------------------
+void Runner::setCacheFile(const QString &f)
+{
+    // the file is opened when the fingerprint of the problem is known (see initialize())
+    m_cache_file = f;
+}
 
-            // constraints
+//-----------------------------------------------------------------------------------------------
+// Initializes the debug file
+//-----------------------------------------------------------------------------------------------
+void Runner::setDebugFileName(const QString &f)
+{
 
-            // if the solution is feasible:
-            if(feas)
-            {
-                for(int j = 0; j < c->numberOfConstraints(); ++j)
-                {
-                    out << c->constraintValue(j) << "\t";
-                }
-            }
+    m_debug = true;
 
-            // if the solution is not feasible
-            else
-            {
-                for(int j = 0; j < c->numberOfConstraints(); ++j)
-                {
-                    double max = model()->constraints().at(j)->max();
-                    double min = model()->constraints().at(j)->min();
-
-                    if(c->constraintValue(j) > max || c->constraintValue(j) < min)
-                    {
-                        out << c->constraintValue(j) << "*\t";
-                    }
-                    else out << c->constraintValue(j) << "\t";
-                }
-            }
+    m_debug_filename = f;
 
-            out << "\n";
+    p_debug = new QFile(f);
 
-            ++m_number_of_runs;
 
-        }
+    if(!p_debug->open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning("Could not connect to debug file: %s", p_debug->fileName().toLatin1().constData());
 
+        delete p_debug;
+        p_debug = 0;
+    }
+    else
+    {
+        // deleting content from previous launches
+        p_debug->resize(0);
+    }
 
 
 
+}
 
-        p_summary->flush();
 
-    }
+//-----------------------------------------------------------------------------------------------
+// Writes the problem definition to the summary file
+//-----------------------------------------------------------------------------------------------
+void Runner::writeProblemDefToSummary()
+{
+    if(p_summary != 0) p_summary->writeHeader(p_model);
+}
 
+//-----------------------------------------------------------------------------------------------
+// Writes the results from the current iteration to the summary file
+//-----------------------------------------------------------------------------------------------
+void Runner::writeCasesToSummary(CaseQueue *cases)
+{
+    if(p_summary != 0) p_summary->writeCases(cases, m_number_of_runs);
 
+    m_number_of_runs += cases->size();
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -643,17 +671,19 @@ void Runner::writeCasesToSummary()
 //-----------------------------------------------------------------------------------------------
 bool Runner::isFeasible(Case *c)
 {
-    double l_tol = 0.0001;
-
     bool ok = true;
+
+    // cases that could not be evaluated are never feasible
+    if(c->isFailed()) return false;
+
     // first checking that the number of constraints match
     if(c->numberOfConstraints() != model()->constraints().size()) return false;
     else
     {
         for(int i = 0; i < c->numberOfConstraints(); ++i)
         {
-            double max = model()->constraints().at(i)->max() + l_tol;
-            double min = model()->constraints().at(i)->min() - l_tol;
+            double max = model()->constraints().at(i)->max() + FEASIBILITY_TOLERANCE;
+            double min = model()->constraints().at(i)->min() - FEASIBILITY_TOLERANCE;
 
             if(c->constraintValue(i) > max || c->constraintValue(i) < min)
             {
@@ -678,176 +708,244 @@ void Runner::writeBestCaseToSummary(Case *c)
 
     if(p_summary != 0)
     {
-        QTextStream out(p_summary);
-
-
-        out << "\nBEST CASE:\n";
+        time_t end_time = time(NULL);
 
+        p_summary->writeBestCase(c, difftime(end_time, m_start_time), m_number_of_runs - 1, m_number_of_res_sim_runs, p_cache->hits());
+    }
 
-        // header
+    // the final checkpoint
+    if(!m_checkpoint_file.isEmpty()) writeCheckpoint();
 
-        out << "#\t\t" << "OBJ\t";
 
 
-        for(int i = 0; i < c->numberOfRealVariables(); ++i)
-        {
-            out << "VAR_C" << i +1 << "\t";
-        }
+}
 
-        for(int i = 0; i < c->numberOfBinaryVariables(); ++i)
-        {
-            out << "VAR_B" << i + 1 << "\t";
-        }
 
-        for(int i = 0; i < c->numberOfIntegerVariables(); ++i)
-        {
-            out << "VAR_I" << i + 1 << "\t";
-        }
+//-----------------------------------------------------------------------------------------------
+// This function is called whenever a Launcher emits finished
+//-----------------------------------------------------------------------------------------------
+void Runner::onLauncherFinished(Launcher *l, Component *comp, Case *finished_case)
+{
+    //cout << "Runner::onLauncherFinished() starting..." << endl;
 
 
+    // this is connected to the GUI...
+    emit newCaseFinished(finished_case);
 
-        out << "\n";
+    // the case is no longer running, it can not be cancelled any more
+    p_scheduler->finished(l, finished_case);
 
+    // storing the results, only evaluations of the entire model are cached
+    // failed cases are not cached, the failure may be temporary (e.g. a timeout or cancellation)
+    if(comp == 0 && !finished_case->isFailed() && finished_case->numberOfConstraints() == model()->constraints().size()) p_cache->insert(finished_case);
 
-        // data
+    //update the last run launcher pointer (remote launchers have no model, and may be deleted when their worker disconnects)
+    if(l->model() != 0) p_last_run_launcher = l;
 
+    // printing debug info if enabled
+    if(p_debug != 0 && l->model() != 0) printDebug(l);
 
-        out << "xx" << "\t\t" << c->objectiveValue() << "\t";
 
-        // real variables
-        for(int j = 0; j < c->numberOfRealVariables(); ++j)
-        {
-            out << c->realVariableValue(j) << "\t";
-        }
+    // checking if all the cases in the batch have finished, cases that are not in any batch are ignored (0 is a valid batch id)
+    int batch_id = m_case_batch.value(finished_case, -1);
+    m_case_batch.remove(finished_case);
 
+    if(batch_id >= 0 && m_batches.contains(batch_id))
+    {
+        Batch &b = m_batches[batch_id];
 
-        // binary variables
-        for(int j = 0; j < c->numberOfBinaryVariables(); ++j)
-        {
-            out << c->binaryVariableValue(j) << "\t";
-        }
+        --b.remaining;
 
-        // integer variables
-        for(int j = 0; j < c->numberOfIntegerVariables(); ++j)
-        {
-            out << c->integerVariableValue(j) << "\t";
-        }
+        if(b.remaining == 0) onBatchFinished(batch_id);
+    }
 
+    //cout << "runner onLauncherFinished finished..." << endl;
 
-        // constraints
-        for(int j = 0; j < c->numberOfConstraints(); ++j)
-        {
-            out << c->constraintValue(j) << "\t";
-        }
+}
 
-        out << "\n\n";
+//-----------------------------------------------------------------------------------------------
+// Called when all the cases in a batch have finished
+//-----------------------------------------------------------------------------------------------
+void Runner::onBatchFinished(int batch_id)
+{
+    if(!m_batches.contains(batch_id)) return;
 
-        time_t end_time = time(NULL);
+    Batch b = m_batches.take(batch_id);
 
-        out << "Total execution time: " << difftime(end_time, m_start_time) << " seconds\n";
-        out << "Total number of model evaluations: " << m_number_of_runs -1 << "\n";
-        out << "Number of reservoir simulator launches: " << m_number_of_res_sim_runs << "\n";
+    p_cache->flush();
 
+    writeCasesToSummary(b.cases);
 
+    // keeping track of the best case, and checkpointing the run
+    // optimizers that mark their iterations are only checkpointed at the end of an iteration, where their state is consistent
+    if(b.comp == 0) updateIncumbent(b.cases);
 
-        p_summary->flush();
+    if(!p_optimizer->marksIterations()) checkpoint();
 
-    }
+    // letting the optimizer know
+    emit batchFinished(batch_id);
+    emit casesFinished();
+}
 
+//-----------------------------------------------------------------------------------------------
+// Keeps the best feasible case
+//-----------------------------------------------------------------------------------------------
+void Runner::updateIncumbent(CaseQueue *cases)
+{
+    for(int i = 0; i < cases->size(); ++i)
+    {
+        Case *c = cases->at(i);
 
+        if(!isFeasible(c)) continue;
 
+        if(p_incumbent == 0) p_incumbent = new Case(*c, true);
+        else if(c->objectiveValue() > p_incumbent->objectiveValue()) *p_incumbent = *c;
+    }
 }
 
+//-----------------------------------------------------------------------------------------------
+// Writes a checkpoint if it is time for one
+//-----------------------------------------------------------------------------------------------
+void Runner::checkpoint()
+{
+    if(!m_checkpoint_file.isEmpty() && difftime(time(NULL), m_last_checkpoint) >= m_checkpoint_interval) writeCheckpoint();
+}
 
 //-----------------------------------------------------------------------------------------------
-// This function is called whenever a Launcher emits finished
+// Writes the state of the run to the checkpoint file
 //-----------------------------------------------------------------------------------------------
-void Runner::onLauncherFinished(Launcher *l, Component *comp, Case *finished_case)
+void Runner::writeCheckpoint()
 {
-    //cout << "Runner::onLauncherFinished() starting..." << endl;
+    QSaveFile file(m_checkpoint_file);
 
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qWarning("Could not connect to checkpoint file: %s", m_checkpoint_file.toLatin1().constData());
+        return;
+    }
 
-    // this is connected to the GUI...
-    emit newCaseFinished(finished_case);
+    QDataStream out(&file);
 
-    //update the last run launcher pointer
-    p_last_run_launcher = l;
+    out << CHECKPOINT_MAGIC << CHECKPOINT_VERSION;
 
-    // printing debug info if enabled
-    if(p_debug != 0) printDebug(l);
+    // the problem the checkpoint belongs to
+    out << m_fingerprint;
 
-    // check if the optimization should be paused
-    if(m_paused)
-    {
-        cout << "pausing optimization..." << endl;
+    // the counters
+    out << qint32(m_number_of_runs) << qint32(m_number_of_res_sim_runs) << difftime(time(NULL), m_start_time);
+
+    // the best case so far
+    out << (p_incumbent != 0);
+    if(p_incumbent != 0) EvaluationCache::writeCase(out, p_incumbent);
+
+    // all the evaluated cases
+    p_cache->write(out);
 
-        QEventLoop pause_loop;
+    // the optimizer
+    out << p_optimizer->saveState();
 
-        connect(this, SIGNAL(resumePaused()), &pause_loop, SLOT(quit()));
+    // the old checkpoint is only replaced if everything was written
+    if(!file.commit()) qWarning("Could not write checkpoint file: %s", m_checkpoint_file.toLatin1().constData());
 
-        pause_loop.exec();
+    m_last_checkpoint = time(NULL);
+}
 
-        cout << "pause ended...." << endl;
+//-----------------------------------------------------------------------------------------------
+// Restores the state of the run from the checkpoint file
+//-----------------------------------------------------------------------------------------------
+bool Runner::readCheckpoint()
+{
+    QFile file(m_checkpoint_file);
 
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning("Could not open checkpoint file: %s", m_checkpoint_file.toLatin1().constData());
+        return false;
     }
 
+    QDataStream in(&file);
 
-    // check if there are more cases to run
-    Case *c = p_cases->next();
+    quint32 magic;
+    qint32 version;
+    in >> magic >> version;
 
+    if(in.status() != QDataStream::Ok || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+    {
+        qWarning("The checkpoint file is not in the right format: %s", m_checkpoint_file.toLatin1().constData());
+        return false;
+    }
+
+    // the problem the checkpoint belongs to
+    QByteArray fingerprint;
+    in >> fingerprint;
 
-    if(c != 0)      // found a new case, sending it to the launcher
+    if(in.status() != QDataStream::Ok || fingerprint != m_fingerprint)
     {
+        qWarning("The checkpoint was written for a different driver or input file: %s", m_checkpoint_file.toLatin1().constData());
+        return false;
+    }
 
-        // connecting the launcher
-        connect(this, SIGNAL(sendCase(Case*, Component*)), l, SLOT(evaluate(Case*, Component*)));
+    // the counters
+    qint32 n_runs, n_res_sim_runs;
+    double run_time;
+    in >> n_runs >> n_res_sim_runs >> run_time;
 
-        // sending the case to the launcher
-        emit sendCase(c, comp);
+    // the best case so far
+    bool has_incumbent;
+    Case *incumbent = 0;
 
-        // disconnecting the launcher
-        disconnect(this, SIGNAL(sendCase(Case*, Component*)), l, SLOT(evaluate(Case*, Component*)));
-    }
-    else    // no more cases, checking if all launchers have finished
+    in >> has_incumbent;
+    if(has_incumbent) incumbent = EvaluationCache::readCase(in);
+
+    // all the evaluated cases
+    QVector<Case*> cases;
+    bool cases_ok = in.status() == QDataStream::Ok && (!has_incumbent || incumbent != 0) && EvaluationCache::readCases(in, &cases);
+
+    // the optimizer
+    QByteArray state;
+    if(cases_ok) in >> state;
+
+    if(!cases_ok || in.status() != QDataStream::Ok)
     {
-        int place = 0;
+        qWarning("The checkpoint file is incomplete: %s", m_checkpoint_file.toLatin1().constData());
+        delete incumbent;
+        qDeleteAll(cases);
+        return false;
+    }
 
-        // finding which launcher this is
-        for(int i = 0; i < m_launchers.size(); ++i)
-        {
-            if(l == m_launchers.at(i))
-            {
-                place = i;
-                break;
-            }
-        }
+    // the starting point must match the model
+    if(incumbent != 0 && !matchesModel(incumbent))
+    {
+        qWarning("The checkpoint does not match the model in the driver file: %s", m_checkpoint_file.toLatin1().constData());
+        delete incumbent;
+        qDeleteAll(cases);
+        return false;
+    }
 
-        // setting the status of this launcher to not running
-        m_launcher_running.replace(place, false);
+    // the optimizer validates its state before using it
+    if(!p_optimizer->restoreState(state))
+    {
+        qWarning("The optimizer state in the checkpoint could not be restored: %s", m_checkpoint_file.toLatin1().constData());
+        delete incumbent;
+        qDeleteAll(cases);
+        return false;
+    }
 
-        // checking if any launchers are still running
-        bool all_finished = true;
-        for(int i = 0; i < m_launcher_running.size(); ++i)
-        {
-            if(m_launcher_running.at(i))    // found a launcher that is still running
-            {
-                all_finished = false;
-                break;
-            }
-        }
+    // everything is read, restoring the run
+    p_cache->add(cases);
 
-        // if all launchers are finished, letting the optimizer know
-        if(all_finished)
-        {
+    if(incumbent != 0) setModelVariables(incumbent);
 
-            writeCasesToSummary();
-            emit casesFinished();
-        }
+    if(p_incumbent != 0) delete p_incumbent;
+    p_incumbent = incumbent;
 
-    }
+    m_number_of_runs = n_runs;
+    m_number_of_res_sim_runs = n_res_sim_runs;
+    m_resumed_time = run_time;
 
-    //cout << "runner onLauncherFinished finished..." << endl;
+    cout << "Resumed from checkpoint: " << n_runs - 1 << " model evaluations, " << p_cache->size() << " cases in cache..." << endl;
 
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -855,7 +953,7 @@ void Runner::onLauncherFinished(Launcher *l, Component *comp, Case *finished_cas
 //-----------------------------------------------------------------------------------------------
 void Runner::transferModelStateFromLauncher()
 {
-    if(p_last_run_launcher != 0)
+    if(p_last_run_launcher != 0 && p_last_run_launcher->model() != 0)
     {
         *p_model = *p_last_run_launcher->model();
     }
@@ -1087,6 +1185,9 @@ void Runner::setPaused(bool paused)
 
     m_paused = paused;
 
+    // the launchers will not get any new cases while paused
+    p_scheduler->setPaused(paused);
+
     if(!paused) emit resumePaused();
 }
 
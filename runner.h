@@ -35,6 +35,8 @@
 #include <QFile>
 #include <QVector>
 #include <QObject>
+#include <QHash>
+#include <QByteArray>
 
 class QThread;
 
@@ -54,6 +56,9 @@ class CaseQueue;
 class Case;
 class Component;
 class Logger;
+class EvaluationCache;
+class CaseScheduler;
+class SummaryLog;
 
 /**
  * @brief Main execution class.
@@ -63,22 +68,38 @@ class Runner : public QObject
 {
     Q_OBJECT
 private:
+
+    /**
+     * @brief A list of cases submitted for evaluation, and the number of them that are not finished yet.
+     *
+     */
+    struct Batch
+    {
+        CaseQueue *cases;
+        Component *comp;
+        int remaining;
+    };
+
     QVector<Launcher*> m_launchers;
-    QVector<bool> m_launcher_running;
     QVector<QThread*> m_threads;
 
+    CaseScheduler *p_scheduler;
+    QHash<int, Batch> m_batches;
+    QHash<Case*, int> m_case_batch;     // the batch each case in the scheduler belongs to
+    int m_next_batch_id;
+
     ModelReader *p_reader;
     Model *p_model;
     ReservoirSimulator *p_simulator;
     Optimizer *p_optimizer;
 
-    QFile *p_summary;
+    SummaryLog *p_summary;
     QFile *p_debug;
     int m_number_of_runs;
     int m_number_of_res_sim_runs;
     time_t m_start_time;
 
-    CaseQueue *p_cases;
+    EvaluationCache *p_cache;
     Launcher *p_last_run_launcher;
     bool m_paused;
     QString m_debug_filename;
@@ -87,6 +108,15 @@ private:
     int m_debug_case;
 
     Case *p_best_case;
+    Case *p_incumbent;                  // the best feasible case evaluated so far, used as starting point when resuming
+
+    QString m_checkpoint_file;
+    int m_checkpoint_interval;          // minimum number of seconds between two checkpoints
+    time_t m_last_checkpoint;
+    bool m_resume;
+    double m_resumed_time;              // execution time before the run was resumed
+    QByteArray m_fingerprint;           // hash of the driver file and the input files it refers to
+    QString m_cache_file;
 
     Logger *p_logger;
 
@@ -94,17 +124,83 @@ private:
 
 
     /**
-     * @brief Writes the problem definition to the summary file
-     * @details A list of all the variables and constraints are printed to the summary file.
+     * @brief Writes the problem definition to the summary log
+     * @details A list of all the variables and constraints are stored in the summary log.
      */
     void writeProblemDefToSummary();
 
 
     /**
-     * @brief Writes the results from all the cases to the summary file
-     * @details The variable, constraints and objective values are printed as a new line to the summary file.
+     * @brief Writes the results from all the cases to the summary log
+     * @details The variable, constraints and objective values are stored as one fixed width record per case (see SummaryLog).
+     */
+    void writeCasesToSummary(CaseQueue *cases);
+
+
+    /**
+     * @brief Updates the incumbent with the feasible cases in the list that are better than the current incumbent.
+     *
+     * @param cases
+     */
+    void updateIncumbent(CaseQueue *cases);
+
+
+    /**
+     * @brief Computes the fingerprint of the problem definition.
+     * @details The fingerprint is a hash of the driver file, the reservoir input file, and the pipe definition files. Checkpoints and
+     *          cache files written for a different problem are recognized by their fingerprint, and are not used.
+     *
      */
-    void writeCasesToSummary();
+    void computeFingerprint();
+
+
+    /**
+     * @brief Checks if the evaluations of the Model include derivatives (AdjointsCoupledModel). Cached cases without derivatives can not
+     *        be used for such a Model.
+     *
+     * @return bool
+     */
+    bool needsDerivatives();
+
+
+    /**
+     * @brief Checks if the number of variables in the Case matches the Model.
+     *
+     * @param c
+     * @return bool
+     */
+    bool matchesModel(Case *c);
+
+
+    /**
+     * @brief Sets the variable values of the Model to the values in the Case.
+     *
+     * @param c
+     * @return bool false if the number of variables does not match the Model
+     */
+    bool setModelVariables(Case *c);
+
+
+    /**
+     * @brief Writes the state of the run to the checkpoint file.
+     * @details The checkpoint contains the run counters, the incumbent, all the cases in the EvaluationCache, and the state of the Optimizer.
+     *          The file is written to a temporary file that replaces the old checkpoint when it is complete, so a crash while writing
+     *          leaves the previous checkpoint intact.
+     *
+     */
+    void writeCheckpoint();
+
+
+    /**
+     * @brief Restores the state of the run from the checkpoint file.
+     * @details The entire checkpoint is read and validated before anything is restored, so nothing is changed if this fails. The
+     *          checkpoint must have been written for the same problem (see computeFingerprint()). The evaluated cases are added to the
+     *          EvaluationCache, so they are not sent to the simulator again. The variables of the Model are set to the incumbent, which
+     *          becomes the starting point of the Optimizer.
+     *
+     * @return bool false if the checkpoint could not be read
+     */
+    bool readCheckpoint();
 
 
 
@@ -112,6 +208,8 @@ private:
 
 
 public:
+    static const double FEASIBILITY_TOLERANCE;      // how far a constraint may be outside its bounds in a feasible case, see isFeasible()
+
     explicit Runner(const QString &driver_file, QObject *parent = 0);
     ~Runner();
 
@@ -126,6 +224,31 @@ public:
     void initializeLaunchers();
 
 
+    /**
+     * @brief Writes a checkpoint if a checkpoint file is set, and the checkpoint interval has passed since the last one.
+     * @details Called by optimizers that mark their iterations (see Optimizer::marksIterations()), so the checkpoint is consistent
+     *          with the state of the optimizer.
+     *
+     */
+    void checkpoint();
+
+
+    /**
+     * @brief Lets a Launcher that is owned by someone else pull cases from the CaseScheduler.
+     * @details Used by the MasterRunner for the RemoteLaunchers of the worker processes. The Launcher must live in the thread of the Runner.
+     *
+     * @param l
+     */
+    void addExternalLauncher(Launcher *l);
+
+    /**
+     * @brief Stops handing out cases to a Launcher added with addExternalLauncher().
+     *
+     * @param l
+     */
+    void removeExternalLauncher(Launcher *l);
+
+
     void printDebug(Launcher *l);
 
     void transferModelStateFromLauncher();
@@ -139,10 +262,38 @@ public:
     bool isFeasible(Case *c);
 
 
+    /**
+     * @brief Checks if all the cases in a batch sent to submit() have finished.
+     *
+     * @param batch_id
+     * @return bool
+     */
+    bool isBatchFinished(int batch_id) const {return batch_id < m_next_batch_id && !m_batches.contains(batch_id);}
+
+
+    /**
+     * @brief Checks if a case in a batch sent to submit() has finished.
+     *
+     * @param c
+     * @return bool
+     */
+    bool isCaseFinished(Case *c) const {return !m_case_batch.contains(c);}
+
+
     // set functions
 
     void setSummaryFile(const QString &f);
     void setDebugFileName(const QString &f);
+    void setCacheFile(const QString &f);
+    void setCheckpointFile(const QString &f, int interval = 600) {m_checkpoint_file = f; m_checkpoint_interval = interval;}
+
+    /**
+     * @brief If set, the run is resumed from the checkpoint file when the Runner is initialized.
+     * @details The run is aborted if the checkpoint can not be restored. The summary log of the interrupted run is appended to.
+     *
+     * @param b
+     */
+    void setResume(bool b) {m_resume = b;}
 
     void setOptimizer(Optimizer *o) {p_optimizer = o;}
     void setReservoirSimulator(ReservoirSimulator *s) {p_simulator = s;}
@@ -158,14 +309,24 @@ public:
 
     Logger* logger() {return p_logger;}
 
+    EvaluationCache* cache() {return p_cache;}
+
+    CaseScheduler* scheduler() {return p_scheduler;}
+
+    int numberOfLaunchers() const {return m_launchers.size();}
+    int numberOfReservoirSimRuns() const {return m_number_of_res_sim_runs;}
+
+    const QByteArray& fingerprint() const {return m_fingerprint;}
+
 
 
 public slots:
 
     /**
      * @brief This slot is called whenever a Launcher finishes with its model evaluation.
-     * @details If there are more cases to run in the queue, the launcher is sent a new case from the queue to evaluate. If there are no more cases to run, this function checks if all the other
-     *          launchers have finished. If all the launchers have finished, casesFinished() is emitted, and the results are written to the summary file.
+     * @details The Launcher continues with the next case in the CaseScheduler by itself. This function stores the result in the EvaluationCache,
+     *          and checks if all the cases in the batch the finished case belongs to are done. If so, the results are written to the summary file,
+     *          and batchFinished() and casesFinished() are emitted.
      *
      * @param l
      */
@@ -182,13 +343,39 @@ public slots:
     bool runFromCase(Case *starting_point);
 
 
+    /**
+     * @brief Submits a list of cases for evaluation, and returns right away.
+     * @details The cases are added to the CaseScheduler, where idle Launchers pull them from. New cases may be submitted while earlier
+     *          batches are still being evaluated. When all the cases in the list have been evaluated, batchFinished() is emitted with the
+     *          returned id (followed by casesFinished()). The signals are always emitted from the event loop, never from within this function.
+     *
+     *          When the entire Model is evaluated, cases that have already been evaluated are looked up in the EvaluationCache, and get their
+     *          results from there without being sent to a Launcher. A case that is listed more than once is only evaluated once. Submitting
+     *          a case that is still being evaluated in another batch is an error.
+     *
+     * @param cases A list of the cases that should be run
+     * @param comp A pointer to the component of the Model that should be evaluated. If this is a null pointer, the entire Model is evaluated.
+     * @return int id of the batch
+     */
+    int submit(CaseQueue *cases, Component *comp);
+
+
+    /**
+     * @brief Cancels the cases in a batch that have not finished yet.
+     * @details Used by optimizers that no longer need the rest of a batch (e.g. when an improvement has already been found). The cases
+     *          still waiting in the CaseScheduler are not evaluated, and the simulator runs of the cases being evaluated are stopped.
+     *          All the unfinished cases are marked as failed (see Case::setFailed()). batchFinished() is still emitted for the batch,
+     *          when the running cases have stopped.
+     *
+     * @param batch_id
+     */
+    void cancel(int batch_id);
+
+
     /**
      * @brief Evaluates a list of cases.
-     * @details This function is called by an Optimizer, or another class that needs to evaluate the Model.
-     *          The cases in the queue is distrubuted among the Launchers for model evaluation. When a Launcher finishes the evaluation,
-     *          it emits a signal that is connected to the onLauncherFinished() slot. Further distrubution of cases is take from there. When
-     *          calling this function, it should be done within an event loop. The event loop should wait for the casesFinished() signal before
-     *          proceeding.
+     * @details Same as submit(), but without returning the batch id. When calling this function, it should be done within an event loop.
+     *          The event loop should wait for the casesFinished() signal before proceeding.
      *
      * @param cases A list of the cases that should be run
      * @param comp A pointer to the component of the Model that should be evaluated. If this is a null pointer, the entire Model is evaluated.
@@ -212,11 +399,21 @@ public slots:
     void onOptimizationFinished();
 
 
+private slots:
+
+    /**
+     * @brief Called when all the cases in a batch have finished.
+     * @details Writes the cases to the summary file, and emits batchFinished() and casesFinished().
+     *
+     */
+    void onBatchFinished(int batch_id);
+
 
 
 signals:
     void runnerFinished(Runner *r, Case *c);
     void casesFinished();
+    void batchFinished(int batch_id);
     void sendCase(Case *c, Component *comp);
     void newCaseFinished(Case *c);
     void resumePaused();
@@ -113,7 +113,7 @@ void Separator::calculateInletPressure()
     for(int i = 0; i < numberOfStreams(); i++)
     {
         // getting the outlet pressure
-        double p_out = outletConnection()->pipe()->stream(i)->pressure(stream(i)->inputUnits());
+        Units::Psia p_out = outletConnection()->pipe()->stream(i)->pressure<Units::FIELD>();
 
         // setting inlet pressure = outlet pressure
         stream(i)->setPressure(p_out);
@@ -0,0 +1,186 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "simulatorprocess.h"
+
+#include <iostream>
+#include <QProcess>
+#include <QElapsedTimer>
+
+#include "reservoirsimulator.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// milliseconds to wait for the process to start
+static const int SIMULATOR_START_TIMEOUT = 60000;
+
+// milliseconds to wait for the process to exit when stopped
+static const int SIMULATOR_EXIT_TIMEOUT = 10000;
+
+// milliseconds between each check for timeout and cancellation while waiting for output
+static const int SIMULATOR_POLL_INTERVAL = 500;
+
+
+SimulatorProcess::SimulatorProcess(const QString &program, const QStringList &args)
+    : p_process(0),
+      m_program(program),
+      m_args(args),
+      m_exit_command("exit")
+{
+}
+
+SimulatorProcess::~SimulatorProcess()
+{
+    stop();
+}
+
+//-----------------------------------------------------------------------------------------------
+// checks if the process is running
+//-----------------------------------------------------------------------------------------------
+bool SimulatorProcess::isRunning() const
+{
+    return p_process != 0 && p_process->state() == QProcess::Running;
+}
+
+//-----------------------------------------------------------------------------------------------
+// starts the process
+//-----------------------------------------------------------------------------------------------
+bool SimulatorProcess::start()
+{
+    if(isRunning()) return true;
+
+    if(p_process != 0) delete p_process;
+
+    p_process = new QProcess();
+
+    // the done marker is read from standard output, error messages are discarded
+    p_process->setProcessChannelMode(QProcess::SeparateChannels);
+    p_process->setReadChannel(QProcess::StandardOutput);
+    p_process->setStandardErrorFile(QProcess::nullDevice());
+    p_process->setWorkingDirectory(m_folder);
+
+    p_process->start(m_program, m_args);
+
+    if(!p_process->waitForStarted(SIMULATOR_START_TIMEOUT))
+    {
+        cout << endl << "### Runtime Error ###" << endl
+             << "Could not start simulator process: " << m_program.toLatin1().constData() << endl
+             << "Reason: " << p_process->errorString().toLatin1().constData() << endl << endl;
+
+        // the process may still be starting if the wait timed out
+        p_process->kill();
+        p_process->waitForFinished(SIMULATOR_EXIT_TIMEOUT);
+
+        delete p_process;
+        p_process = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// runs a command in the process
+//-----------------------------------------------------------------------------------------------
+int SimulatorProcess::run(const QString &command, const QString &done_marker, const ReservoirSimulator *sim)
+{
+    if(!start()) return -1;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // output left over from earlier commands is not part of this run
+    p_process->readAll();
+
+    p_process->write((command + "\n").toLatin1());
+
+    while(true)
+    {
+        while(p_process->canReadLine())
+        {
+            QString line = QString(p_process->readLine()).trimmed();
+
+            // the marker may come after a prompt (e.g. ">> " from MATLAB), and is only accepted when followed by a status code
+            int pos = line.indexOf(done_marker);
+            if(pos < 0) continue;
+
+            QStringList tokens = line.mid(pos + done_marker.size()).split(' ', QString::SkipEmptyParts);
+
+            bool ok = false;
+            int status = tokens.isEmpty() ? 0 : tokens.first().toInt(&ok);
+
+            if(ok) return status;
+        }
+
+        if(p_process->state() != QProcess::Running) return -1;
+
+        // the process is still busy with the command, so it must be killed to stop the run
+        if(sim != 0)
+        {
+            bool timed_out = sim->timeout() > 0 && timer.elapsed() > 1000 * qint64(sim->timeout());
+
+            if(timed_out || sim->isCancelled())
+            {
+                if(timed_out) cout << "Simulator run timed out after " << sim->timeout() << " seconds..." << endl;
+                else cout << "Simulator run cancelled..." << endl;
+
+                p_process->kill();
+                p_process->waitForFinished(-1);
+
+                return -1;
+            }
+        }
+
+        // waits until more output arrives, or the process dies
+        if(!p_process->waitForReadyRead(SIMULATOR_POLL_INTERVAL) && p_process->state() != QProcess::Running) return -1;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// stops the process
+//-----------------------------------------------------------------------------------------------
+void SimulatorProcess::stop()
+{
+    if(p_process == 0) return;
+
+    if(p_process->state() == QProcess::Running)
+    {
+        p_process->write((m_exit_command + "\n").toLatin1());
+        p_process->closeWriteChannel();
+
+        if(!p_process->waitForFinished(SIMULATOR_EXIT_TIMEOUT))
+        {
+            p_process->kill();
+            p_process->waitForFinished(-1);
+        }
+    }
+
+    delete p_process;
+    p_process = 0;
+}
+
+} // namespace ResOpt
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef SIMULATORPROCESS_H
+#define SIMULATORPROCESS_H
+
+#include <QString>
+#include <QStringList>
+
+class QProcess;
+
+namespace ResOpt
+{
+
+class ReservoirSimulator;
+
+/**
+ * @brief A simulator process that is kept running between model evaluations.
+ * @details The process is started once, and is then fed one command per evaluation on its standard input. The process must write a line
+ *          with the done marker, followed by a status code, when the command has finished. The marker may be preceded by a prompt, and a
+ *          marker that is not followed by a status code (e.g. an echo of the command) is ignored. Everything else written to the standard
+ *          output is discarded. This way the start-up cost of the simulator (e.g. starting MATLAB) is paid once per Launcher, instead of once
+ *          for each evaluation.
+ *
+ *          If the process dies while running a command, run() fails, and the process is started again for the next command. The same
+ *          happens when the run times out or is cancelled through the ReservoirSimulator, the process is then killed, since it is
+ *          still busy with the command.
+ *
+ *          The process is not shared between threads. It is created by the first call to start(), from the thread of the Launcher.
+ *
+ */
+class SimulatorProcess
+{
+private:
+    QProcess *p_process;
+    QString m_program;
+    QStringList m_args;
+    QString m_folder;
+    QString m_exit_command;
+
+public:
+    SimulatorProcess(const QString &program, const QStringList &args);
+    ~SimulatorProcess();
+
+    /**
+     * @brief Starts the process, if it is not already running.
+     *
+     * @return bool false if the process could not be started, or did not start within the start timeout
+     */
+    bool start();
+
+    /**
+     * @brief Sends a command to the process, and waits for the done marker.
+     *
+     * @param command
+     * @param done_marker
+     * @param sim if given, the timeout and cancellation of this simulator are respected
+     * @return int the status code after the done marker, or -1 if the process died or was killed
+     */
+    int run(const QString &command, const QString &done_marker, const ReservoirSimulator *sim = 0);
+
+    /**
+     * @brief Sends the exit command, and waits for the process to finish. The process is killed if it does not exit.
+     *
+     */
+    void stop();
+
+
+    // set functions
+    void setWorkingDirectory(const QString &f) {m_folder = f;}
+    void setExitCommand(const QString &c) {m_exit_command = c;}
+
+    // get functions
+    bool isRunning() const;
+    const QString& workingDirectory() const {return m_folder;}
+};
+
+} // namespace ResOpt
+
+#endif // SIMULATORPROCESS_H
@@ -49,6 +49,15 @@ Stream::Stream(double t, double qo, double qg, double qw, double p)
       m_input_units(Stream::FIELD)
 {}
 
+Stream::Stream(double t, double qo, double qg, double qw, double p, Stream::units u)
+    : m_time(t),
+      m_oil_rate(toFieldUnits<Units::LiquidRate>(qo, u)),
+      m_water_rate(toFieldUnits<Units::LiquidRate>(qw, u)),
+      m_gas_rate(toFieldUnits<Units::GasRate>(qg, u)),
+      m_pressure(toFieldUnits<Units::Pressure>(p, u)),
+      m_input_units(u)
+{}
+
 
 Stream::Stream(const Stream &s)
 {
@@ -80,10 +89,11 @@ void Stream::avg(const QVector<Stream *> &input, double t_start)
     double cum_pres = 0;
     for(int i = 0; i < input.size(); ++i)
     {
-        cum_gas += input.at(i)->gasRate(inputUnits()) * (input.at(i)->time() - ts_start);
-        cum_oil += input.at(i)->oilRate(inputUnits()) * (input.at(i)->time() - ts_start);
-        cum_water += input.at(i)->waterRate(inputUnits()) * (input.at(i)->time() - ts_start);
-        cum_pres += input.at(i)->pressure(inputUnits()) * (input.at(i)->time() - ts_start);
+        // all the streams are stored in field units, no conversion needed
+        cum_gas += input.at(i)->m_gas_rate * (input.at(i)->time() - ts_start);
+        cum_oil += input.at(i)->m_oil_rate * (input.at(i)->time() - ts_start);
+        cum_water += input.at(i)->m_water_rate * (input.at(i)->time() - ts_start);
+        cum_pres += input.at(i)->m_pressure * (input.at(i)->time() - ts_start);
 
         ts_start = input.at(i)->time();
     }
@@ -113,102 +123,6 @@ void Stream::printToCout() const
 
 }
 
-//-----------------------------------------------------------------------------------------------
-// Returns the gas rate
-//-----------------------------------------------------------------------------------------------
-double Stream::gasRate(Stream::units u) const
-{
-    if(u != m_input_units)
-    {
-        if(u == Stream::METRIC) return m_gas_rate * 28.3168466;
-        else return m_gas_rate /  28.3168466;
-    }
-    else return m_gas_rate;
-}
-
-double Stream::gasRate(bool input_units) const
-{
-    if(input_units) return m_gas_rate;
-    else
-    {
-        if(inputUnits() == Stream::METRIC) return gasRate(Stream::FIELD);
-        else return gasRate(Stream::METRIC);
-    }
-}
-
-//-----------------------------------------------------------------------------------------------
-// Returns the oil rate
-//-----------------------------------------------------------------------------------------------
-double Stream::oilRate(Stream::units u) const
-{
-    if(u != m_input_units)
-    {
-        if(u == Stream::METRIC) return m_oil_rate * 0.158987295;
-        else return m_oil_rate /  0.158987295;
-    }
-    else return m_oil_rate;
-}
-
-double Stream::oilRate(bool input_units) const
-{
-    if(input_units) return m_oil_rate;
-    else
-    {
-        if(inputUnits() == Stream::METRIC) return oilRate(Stream::FIELD);
-        else return oilRate(Stream::METRIC);
-    }
-}
-
-
-//-----------------------------------------------------------------------------------------------
-// Returns the water rate
-//-----------------------------------------------------------------------------------------------
-double Stream::waterRate(Stream::units u) const
-{
-    if(u != m_input_units)
-    {
-        if(u == Stream::METRIC) return m_water_rate * 0.158987295;
-        else return m_water_rate /  0.158987295;
-    }
-    else return m_water_rate;
-}
-
-double Stream::waterRate(bool input_units) const
-{
-    if(input_units) return m_water_rate;
-    else
-    {
-        if(inputUnits() == Stream::METRIC) return waterRate(Stream::FIELD);
-        else return waterRate(Stream::METRIC);
-    }
-}
-
-
-//-----------------------------------------------------------------------------------------------
-// Returns the pressure
-//-----------------------------------------------------------------------------------------------
-double Stream::pressure(Stream::units u) const
-{
-    if(u != m_input_units)
-    {
-        if(u == Stream::METRIC) return m_pressure / 14.5037738;
-        else return m_pressure * 14.5037738;
-    }
-    else return m_pressure;
-}
-
-double Stream::pressure(bool input_units) const
-{
-    if(input_units) return m_pressure;
-    else
-    {
-        if(inputUnits() == Stream::METRIC) return pressure(Stream::FIELD);
-        else return pressure(Stream::METRIC);
-    }
-}
-
-
-
 //-----------------------------------------------------------------------------------------------
 // Assignment operator
 //-----------------------------------------------------------------------------------------------
@@ -216,12 +130,12 @@ Stream& Stream::operator =(const Stream &rhs)
 {
     if(this != &rhs)
     {
-        setTime(rhs.time());
-        setGasRate(rhs.gasRate(true));
-        setOilRate(rhs.oilRate(true));
-        setWaterRate(rhs.waterRate(true));
-        setPressure(rhs.pressure(true));
-        setInputUnits(rhs.inputUnits());
+        m_time = rhs.m_time;
+        m_gas_rate = rhs.m_gas_rate;
+        m_oil_rate = rhs.m_oil_rate;
+        m_water_rate = rhs.m_water_rate;
+        m_pressure = rhs.m_pressure;
+        m_input_units = rhs.m_input_units;
     }
 
     return *this;
@@ -233,16 +147,15 @@ Stream& Stream::operator =(const Stream &rhs)
 Stream& Stream::operator +=(const Stream& rhs)
 {
 
-    setTime(rhs.time());
-    setPressure(0.0);
+    m_time = rhs.m_time;
+    m_pressure = 0.0;
 
-    // setting the rates with the same units as the lhs
-    setGasRate(gasRate(rhs.inputUnits()) + rhs.gasRate(rhs.inputUnits()));
-    setOilRate(oilRate(rhs.inputUnits()) + rhs.oilRate(rhs.inputUnits()));
-    setWaterRate(waterRate(rhs.inputUnits()) + rhs.waterRate(rhs.inputUnits()));
+    // both streams are stored in field units, the result is reported in the units of the rhs
+    m_gas_rate += rhs.m_gas_rate;
+    m_oil_rate += rhs.m_oil_rate;
+    m_water_rate += rhs.m_water_rate;
 
-    // setting the units
-    setInputUnits(rhs.inputUnits());
+    m_input_units = rhs.m_input_units;
 
 
     return *this;
@@ -265,9 +178,9 @@ const Stream Stream::operator +(const Stream &rhs) const
 const Stream Stream::operator *(const double &rhs) const
 {
     Stream result = *this;
-    result.setGasRate(result.gasRate(result.inputUnits())*rhs);
-    result.setOilRate(result.oilRate(result.inputUnits())*rhs);
-    result.setWaterRate(result.waterRate(result.inputUnits())*rhs);
+    result.m_gas_rate *= rhs;
+    result.m_oil_rate *= rhs;
+    result.m_water_rate *= rhs;
 
     return result;
 }
@@ -24,6 +24,7 @@
 
 #include <QVector>
 
+#include "units.h"
 
 namespace ResOpt
 {
@@ -31,19 +32,22 @@ namespace ResOpt
 
 /**
  * @brief Container for rates for a given time step
+ * @details The rates and pressure are always stored in field units. The input units are the units the values are given in
+ *          and reported in by the double valued set and get functions (see Units for the conversions). Code that needs the values in a
+ *          given unit system should use the typed get functions, where the conversion is resolved at compile time.
  *
  */
 class Stream
 {
 public:
-    enum units{METRIC, FIELD};
+    enum units{METRIC = Units::METRIC, FIELD = Units::FIELD};
 
 private:
     double m_time;
-    double m_oil_rate;
-    double m_water_rate;
-    double m_gas_rate;
-    double m_pressure;
+    double m_oil_rate;      // bbl/d
+    double m_water_rate;    // bbl/d
+    double m_gas_rate;      // mcf/d
+    double m_pressure;      // psia
 
     units m_input_units;
 
@@ -54,8 +58,24 @@ public:
  */
     Stream();
     Stream(double t, double qo, double qg, double qw, double p);
+    Stream(double t, double qo, double qg, double qw, double p, Stream::units u);
     Stream(const Stream &s);
 
+    /**
+     * @brief Converts a value of quantity Q from field units to the unit system u.
+     *
+     */
+    template<class Q>
+    static double fromFieldUnits(double v, Stream::units u) {return (u == FIELD) ? v : Units::Conversion<Q, Units::FIELD, Units::METRIC>::apply(v);}
+
+    /**
+     * @brief Converts a value of quantity Q from the unit system u to field units.
+     *
+     */
+    template<class Q>
+    static double toFieldUnits(double v, Stream::units u) {return (u == FIELD) ? v : Units::Conversion<Q, Units::METRIC, Units::FIELD>::apply(v);}
+
+
     // misc functions
 
     void printToCout() const;
@@ -80,32 +100,42 @@ public:
     /**
      * @brief Sets the oil rate for the time step
      *
-     * @param q rate in bbl/d
+     * @param q rate in the input units (bbl/d or m^3/d)
      */
-    void setOilRate(double q) {m_oil_rate = q;}
+    void setOilRate(double q) {m_oil_rate = toFieldUnits<Units::LiquidRate>(q, m_input_units);}
+    template<Units::system U> void setOilRate(const Units::Quantity<Units::LiquidRate, U> &q) {m_oil_rate = Units::BarrelsPerDay(q).value();}
 
     /**
      * @brief Sets the water rate for the time step
      *
-     * @param q rate in bbl/d
+     * @param q rate in the input units (bbl/d or m^3/d)
      */
-    void setWaterRate(double q) {m_water_rate = q;}
+    void setWaterRate(double q) {m_water_rate = toFieldUnits<Units::LiquidRate>(q, m_input_units);}
+    template<Units::system U> void setWaterRate(const Units::Quantity<Units::LiquidRate, U> &q) {m_water_rate = Units::BarrelsPerDay(q).value();}
 
     /**
      * @brief Sets the gas rate for the time step
      *
-     * @param q rate in mcf/d
+     * @param q rate in the input units (mcf/d or m^3/d)
      */
-    void setGasRate(double q) {m_gas_rate = q;}
+    void setGasRate(double q) {m_gas_rate = toFieldUnits<Units::GasRate>(q, m_input_units);}
+    template<Units::system U> void setGasRate(const Units::Quantity<Units::GasRate, U> &q) {m_gas_rate = Units::McfPerDay(q).value();}
 
 
     /**
      * @brief Sets the pressure
      *
-     * @param p
+     * @param p pressure in the input units (psia or bara)
      */
-    void setPressure(double p) {m_pressure = p;}
+    void setPressure(double p) {m_pressure = toFieldUnits<Units::Pressure>(p, m_input_units);}
+    template<Units::system U> void setPressure(const Units::Quantity<Units::Pressure, U> &p) {m_pressure = Units::Psia(p).value();}
 
+    /**
+     * @brief Sets the units used by the double valued set and get functions.
+     * @details The stored rates and pressure are not changed, so the input units should be set before the values.
+     *
+     * @param u
+     */
     void setInputUnits(Stream::units u) {m_input_units = u;}
 
     // get functions
@@ -120,37 +150,42 @@ public:
     /**
      * @brief Returns the oil rate for the time step
      *
-     * @return oil rate in bbl/d
+     * @return oil rate in the units u, the input units, or the other units
      */
-    double oilRate(Stream::units u) const;
-    double oilRate(bool input_units) const;
+    double oilRate(Stream::units u) const {return fromFieldUnits<Units::LiquidRate>(m_oil_rate, u);}
+    double oilRate(bool input_units) const {return oilRate(input_units ? m_input_units : otherUnits());}
+    template<Units::system U> Units::Quantity<Units::LiquidRate, U> oilRate() const {return Units::BarrelsPerDay(m_oil_rate);}
 
     /**
      * @brief Returns the water rate for the time step
      *
-     * @return water rate in bbl/d
+     * @return water rate in the units u, the input units, or the other units
      */
-    double waterRate(Stream::units u) const;
-    double waterRate(bool input_units) const;
+    double waterRate(Stream::units u) const {return fromFieldUnits<Units::LiquidRate>(m_water_rate, u);}
+    double waterRate(bool input_units) const {return waterRate(input_units ? m_input_units : otherUnits());}
+    template<Units::system U> Units::Quantity<Units::LiquidRate, U> waterRate() const {return Units::BarrelsPerDay(m_water_rate);}
 
     /**
      * @brief Returns the gas rate for the time step
      *
-     * @return gas rate in mcf/d
+     * @return gas rate in the units u, the input units, or the other units
      */
-    double gasRate(Stream::units u) const;
-    double gasRate(bool input_units) const;
+    double gasRate(Stream::units u) const {return fromFieldUnits<Units::GasRate>(m_gas_rate, u);}
+    double gasRate(bool input_units) const {return gasRate(input_units ? m_input_units : otherUnits());}
+    template<Units::system U> Units::Quantity<Units::GasRate, U> gasRate() const {return Units::McfPerDay(m_gas_rate);}
 
 
     /**
      * @brief Returns the pressure
      *
-     * @return double
+     * @return pressure in the units u, the input units, or the other units
      */
-    double pressure(Stream::units u) const;
-    double pressure(bool input_units) const;
+    double pressure(Stream::units u) const {return fromFieldUnits<Units::Pressure>(m_pressure, u);}
+    double pressure(bool input_units) const {return pressure(input_units ? m_input_units : otherUnits());}
+    template<Units::system U> Units::Quantity<Units::Pressure, U> pressure() const {return Units::Psia(m_pressure);}
 
     Stream::units inputUnits() const {return m_input_units;}
+    Stream::units otherUnits() const {return (m_input_units == FIELD) ? METRIC : FIELD;}
 
 
     // overloaded operators
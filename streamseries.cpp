@@ -0,0 +1,104 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "streamseries.h"
+
+namespace ResOpt
+{
+
+StreamSeries::StreamSeries()
+{
+}
+
+StreamSeries::StreamSeries(const StreamSeries &s)
+{
+    // copying into a new block, so that pointers into the original are never shared with the copy
+    m_streams.reserve(s.size());
+    for(int i = 0; i < s.size(); ++i) m_streams.push_back(*s.at(i));
+}
+
+StreamSeries& StreamSeries::operator=(const StreamSeries &rhs)
+{
+    if(this != &rhs)
+    {
+        m_streams.resize(rhs.size());
+        for(int i = 0; i < rhs.size(); ++i) *at(i) = *rhs.at(i);
+    }
+
+    return *this;
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets up one empty stream for each time
+//-----------------------------------------------------------------------------------------------
+void StreamSeries::setup(const QVector<double> &times)
+{
+    m_streams.resize(times.size());
+
+    for(int i = 0; i < times.size(); ++i) m_streams[i] = Stream(times.at(i), 0, 0, 0, 0);
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets the values of stream i
+//-----------------------------------------------------------------------------------------------
+void StreamSeries::set(int i, double t, double qo, double qg, double qw, double p, Stream::units u)
+{
+    Stream *s = at(i);
+
+    // the units must be set first, the values are converted when they are set
+    s->setInputUnits(u);
+    s->setTime(t);
+    s->setOilRate(qo);
+    s->setGasRate(qg);
+    s->setWaterRate(qw);
+    s->setPressure(p);
+}
+
+//-----------------------------------------------------------------------------------------------
+// sets all the rates and pressures to zero
+//-----------------------------------------------------------------------------------------------
+void StreamSeries::zero()
+{
+    Stream *s = m_streams.data();
+
+    for(int i = 0; i < m_streams.size(); ++i)
+    {
+        s[i].setOilRate(0);
+        s[i].setGasRate(0);
+        s[i].setWaterRate(0);
+        s[i].setPressure(0);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns pointers to all the streams
+//-----------------------------------------------------------------------------------------------
+QVector<Stream*> StreamSeries::pointers()
+{
+    QVector<Stream*> p(size());
+
+    for(int i = 0; i < size(); ++i) p[i] = at(i);
+
+    return p;
+}
+
+} // namespace ResOpt
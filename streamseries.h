@@ -0,0 +1,94 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef STREAMSERIES_H
+#define STREAMSERIES_H
+
+#include <QVector>
+
+#include "stream.h"
+
+namespace ResOpt
+{
+
+/**
+ * @brief The Streams going through a Component, one for each time step, stored in a single contiguous block.
+ * @details The series is set up once, when the Component is initialized, and the Streams are then updated in place by the simulators
+ *          and the network propagation. The block is not reallocated unless setup() is called again, so pointers returned by at() stay
+ *          valid between evaluations. A copy of the series always gets its own block, it is never shared with the original.
+ *
+ */
+class StreamSeries
+{
+private:
+    QVector<Stream> m_streams;
+
+public:
+    StreamSeries();
+    StreamSeries(const StreamSeries &s);
+
+    StreamSeries& operator=(const StreamSeries &rhs);
+
+    /**
+     * @brief Sets up one empty Stream for each of the times.
+     *
+     * @param times
+     */
+    void setup(const QVector<double> &times);
+
+    /**
+     * @brief Removes all the Streams.
+     *
+     */
+    void clear() {m_streams.resize(0);}
+
+    /**
+     * @brief Sets all the values of Stream i.
+     *
+     */
+    void set(int i, double t, double qo, double qg, double qw, double p, Stream::units u);
+
+    /**
+     * @brief Sets the rates and pressure of all the Streams to zero.
+     *
+     */
+    void zero();
+
+
+    // get functions
+    int size() const {return m_streams.size();}
+
+    Stream* at(int i) {return m_streams.data() + i;}
+    const Stream* at(int i) const {return m_streams.constData() + i;}
+
+    /**
+     * @brief Returns pointers to all the Streams, for code that works on vectors of Stream*.
+     *
+     * @return QVector<Stream *>
+     */
+    QVector<Stream*> pointers();
+
+};
+
+} // namespace ResOpt
+
+#endif // STREAMSERIES_H
@@ -0,0 +1,521 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "summarylog.h"
+
+#include <iostream>
+#include <QFile>
+#include <QThread>
+#include <QDataStream>
+#include <QTextStream>
+#include <QVector>
+#include <QStringList>
+
+#include "runner.h"
+#include "model.h"
+#include "case.h"
+#include "casequeue.h"
+#include "realvariable.h"
+#include "binaryvariable.h"
+#include "intvariable.h"
+#include "constraint.h"
+
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// identifies the summary file format
+static const quint32 SUMMARY_MAGIC = 0x52534f53;
+static const qint32 SUMMARY_VERSION = 1;
+
+// serialization format of the log, fixed so that it can be read by a different Qt build
+static const int SUMMARY_DATA_STREAM_VERSION = QDataStream::Qt_5_0;
+
+
+//-----------------------------------------------------------------------------------------------
+// writes an encoded block to the file (writer thread)
+//-----------------------------------------------------------------------------------------------
+void SummaryLogWriter::write(const QByteArray &block)
+{
+    p_file->write(block);
+}
+
+//-----------------------------------------------------------------------------------------------
+// flushes the file (writer thread)
+//-----------------------------------------------------------------------------------------------
+void SummaryLogWriter::flush()
+{
+    p_file->flush();
+}
+
+
+
+SummaryLog::SummaryLog()
+    : p_file(0),
+      p_thread(0),
+      p_writer(0),
+      m_number_of_real(-1),
+      m_number_of_binary(-1),
+      m_number_of_integer(-1),
+      m_number_of_constraints(-1)
+{
+}
+
+SummaryLog::~SummaryLog()
+{
+    if(p_thread != 0)
+    {
+        flush();
+
+        p_thread->quit();
+        p_thread->wait();
+
+        delete p_writer;
+        delete p_thread;
+    }
+
+    if(p_file != 0)
+    {
+        p_file->close();
+        delete p_file;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// opens the log file, and starts the writer thread
+//-----------------------------------------------------------------------------------------------
+bool SummaryLog::open(const QString &f, bool append)
+{
+    p_file = new QFile(f);
+
+    if(!p_file->open(append ? QIODevice::ReadWrite : (QIODevice::WriteOnly | QIODevice::Truncate)))
+    {
+        qWarning("Could not connect to summary file: %s", p_file->fileName().toLatin1().constData());
+
+        delete p_file;
+        p_file = 0;
+
+        return false;
+    }
+
+    // checking that the existing file is a summary log before appending to it
+    bool keep = false;
+    if(append && p_file->size() > 0)
+    {
+        QDataStream in(p_file);
+        in.setVersion(SUMMARY_DATA_STREAM_VERSION);
+
+        quint32 magic;
+        qint32 version;
+        in >> magic >> version;
+
+        keep = (in.status() == QDataStream::Ok && magic == SUMMARY_MAGIC && version == SUMMARY_VERSION);
+
+        if(!keep) qWarning("The summary log is not in the right format, starting a new log: %s", p_file->fileName().toLatin1().constData());
+    }
+
+    if(keep) p_file->seek(p_file->size());
+    else
+    {
+        p_file->resize(0);
+        p_file->seek(0);
+
+        QDataStream out(p_file);
+        out.setVersion(SUMMARY_DATA_STREAM_VERSION);
+        out << SUMMARY_MAGIC << SUMMARY_VERSION;
+    }
+
+    p_file->flush();
+
+    // the file is only touched by the writer thread from now on
+    p_thread = new QThread();
+    p_writer = new SummaryLogWriter(p_file);
+
+    p_file->moveToThread(p_thread);
+    p_writer->moveToThread(p_thread);
+
+    p_thread->start();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// hands a block over to the writer thread
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::post(const QByteArray &block)
+{
+    QMetaObject::invokeMethod(p_writer, "write", Qt::QueuedConnection, Q_ARG(QByteArray, block));
+}
+
+//-----------------------------------------------------------------------------------------------
+// waits for the writer thread to write everything posted so far
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::flush()
+{
+    if(p_writer != 0) QMetaObject::invokeMethod(p_writer, "flush", Qt::BlockingQueuedConnection);
+}
+
+//-----------------------------------------------------------------------------------------------
+// appends a header record
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::writeHeader(Model *m)
+{
+    if(p_file == 0) return;
+
+    QVector<shared_ptr<RealVariable> > &real_vars = m->realVariables();
+    QVector<shared_ptr<BinaryVariable> > &binary_vars = m->binaryVariables();
+    QVector<shared_ptr<IntVariable> > &int_vars = m->integerVariables();
+    QVector<shared_ptr<Constraint> > &cons = m->constraints();
+
+    QStringList real_names, binary_names, int_names, con_names;
+    QVector<double> real_min, real_value, real_max;
+    QVector<double> binary_min, binary_value, binary_max;
+    QVector<qint32> int_min, int_value, int_max;
+    QVector<double> con_min, con_max;
+
+    for(int i = 0; i < real_vars.size(); ++i)
+    {
+        real_names.push_back(real_vars.at(i)->name());
+        real_min.push_back(real_vars.at(i)->min());
+        real_value.push_back(real_vars.at(i)->value());
+        real_max.push_back(real_vars.at(i)->max());
+    }
+
+    for(int i = 0; i < binary_vars.size(); ++i)
+    {
+        binary_names.push_back(binary_vars.at(i)->name());
+        binary_min.push_back(binary_vars.at(i)->min());
+        binary_value.push_back(binary_vars.at(i)->value());
+        binary_max.push_back(binary_vars.at(i)->max());
+    }
+
+    for(int i = 0; i < int_vars.size(); ++i)
+    {
+        int_names.push_back(int_vars.at(i)->name());
+        int_min.push_back(int_vars.at(i)->min());
+        int_value.push_back(int_vars.at(i)->value());
+        int_max.push_back(int_vars.at(i)->max());
+    }
+
+    for(int i = 0; i < cons.size(); ++i)
+    {
+        con_names.push_back(cons.at(i)->name());
+        con_min.push_back(cons.at(i)->min());
+        con_max.push_back(cons.at(i)->max());
+    }
+
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out.setVersion(SUMMARY_DATA_STREAM_VERSION);
+
+    out << quint8(HEADER);
+    out << qint32(m->numberOfWells()) << qint32(m->numberOfPipes()) << qint32(m->numberOfCapacities());
+    out << real_names << real_min << real_value << real_max;
+    out << binary_names << binary_min << binary_value << binary_max;
+    out << int_names << int_min << int_value << int_max;
+    out << con_names << con_min << con_max;
+
+    m_number_of_real = real_vars.size();
+    m_number_of_binary = binary_vars.size();
+    m_number_of_integer = int_vars.size();
+    m_number_of_constraints = cons.size();
+
+    post(block);
+}
+
+//-----------------------------------------------------------------------------------------------
+// encodes a fixed width case record
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::writeCase(QDataStream &out, RecordKind kind, int run, Case *c)
+{
+    // cases from component evaluations may have fewer constraints, the rest is padded
+    int n_cons = qMin(c->numberOfConstraints(), m_number_of_constraints);
+
+    out << quint8(kind) << qint32(run) << qint32(c->numberOfConstraints()) << c->objectiveValue();
+
+    for(int j = 0; j < m_number_of_real; ++j) out << (j < c->numberOfRealVariables() ? c->realVariableValue(j) : 0.0);
+    for(int j = 0; j < m_number_of_binary; ++j) out << (j < c->numberOfBinaryVariables() ? c->binaryVariableValue(j) : 0.0);
+    for(int j = 0; j < m_number_of_integer; ++j) out << qint32(j < c->numberOfIntegerVariables() ? c->integerVariableValue(j) : 0);
+
+    for(int j = 0; j < n_cons; ++j) out << c->constraintValue(j);
+    for(int j = n_cons; j < m_number_of_constraints; ++j) out << 0.0;
+}
+
+//-----------------------------------------------------------------------------------------------
+// appends the evaluated cases
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::writeCases(CaseQueue *cases, int first_run)
+{
+    if(p_file == 0 || m_number_of_constraints < 0) return;
+
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out.setVersion(SUMMARY_DATA_STREAM_VERSION);
+
+    for(int i = 0; i < cases->size(); ++i) writeCase(out, EVALUATION, first_run + i, cases->at(i));
+
+    post(block);
+}
+
+//-----------------------------------------------------------------------------------------------
+// appends the best case and the run statistics
+//-----------------------------------------------------------------------------------------------
+void SummaryLog::writeBestCase(Case *c, double execution_time, int evaluations, int res_sim_runs, int cache_hits)
+{
+    if(p_file == 0 || m_number_of_constraints < 0) return;
+
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out.setVersion(SUMMARY_DATA_STREAM_VERSION);
+
+    writeCase(out, BEST, 0, c);
+
+    out << quint8(STATISTICS) << execution_time << qint32(evaluations) << qint32(res_sim_runs) << qint32(cache_hits);
+
+    post(block);
+
+    // the run may be about to end, making sure the best case is on disk
+    flush();
+}
+
+//-----------------------------------------------------------------------------------------------
+// generates the text summary from a summary log
+//-----------------------------------------------------------------------------------------------
+bool SummaryLog::render(const QString &bin_file, const QString &txt_file)
+{
+    QFile bin(bin_file);
+    if(!bin.open(QIODevice::ReadOnly))
+    {
+        qWarning("Could not open summary log: %s", bin_file.toLatin1().constData());
+        return false;
+    }
+
+    QDataStream in(&bin);
+    in.setVersion(SUMMARY_DATA_STREAM_VERSION);
+
+    quint32 magic;
+    qint32 version;
+    in >> magic >> version;
+
+    if(in.status() != QDataStream::Ok || magic != SUMMARY_MAGIC || version != SUMMARY_VERSION)
+    {
+        qWarning("The summary log is not in the right format: %s", bin_file.toLatin1().constData());
+        return false;
+    }
+
+    QFile txt(txt_file);
+    if(!txt.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qWarning("Could not connect to summary file: %s", txt_file.toLatin1().constData());
+        return false;
+    }
+
+    QTextStream out(&txt);
+
+    // the problem from the last header
+    QStringList real_names, binary_names, int_names, con_names;
+    QVector<double> real_min, real_value, real_max;
+    QVector<double> binary_min, binary_value, binary_max;
+    QVector<qint32> int_min, int_value, int_max;
+    QVector<double> con_min, con_max;
+    bool has_header = false;
+
+    QVector<double> values;
+    QVector<qint32> int_values;
+
+    while(!in.atEnd())
+    {
+        quint8 kind;
+        in >> kind;
+
+        if(kind == HEADER)
+        {
+            qint32 n_wells, n_pipes, n_caps;
+
+            in >> n_wells >> n_pipes >> n_caps;
+            in >> real_names >> real_min >> real_value >> real_max;
+            in >> binary_names >> binary_min >> binary_value >> binary_max;
+            in >> int_names >> int_min >> int_value >> int_max;
+            in >> con_names >> con_min >> con_max;
+
+            if(in.status() != QDataStream::Ok) break;
+
+            has_header = true;
+
+            out.setRealNumberPrecision(6);
+
+            out << "----------------------------------------------------------------------\n";
+            out << "------------------------ ResOpt Summary File -------------------------\n";
+            out << "----------------------------------------------------------------------\n\n";
+
+            out << "MODEL DESCRIPTION:" << "\n";
+            out << "Number of wells      = " << n_wells << "\n";
+            out << "Number of pipes      = " << n_pipes << "\n";
+            out << "Number of separators = " << n_caps << "\n\n";
+
+            out << "OPTIMIZATION PROBLEM:" << "\n";
+            out << "Number of contineous variables  = " << real_names.size() << "\n";
+            out << "Number of binary variables      = " << binary_names.size() << "\n";
+            out << "Number of constraints           = " << con_names.size() << "\n\n";
+
+            out << "CONTINEOUS VARIABLES:" << "\n";
+            for(int i = 0; i < real_names.size(); ++i)
+            {
+                out << "VAR_C" << i +1 << ": " << real_names.at(i);
+                out << ", bounds: (" << real_min.at(i) << " < " << real_value.at(i) << " < " << real_max.at(i) << ")\n";
+            }
+            out << "\n";
+
+            out << "BINARY VARIABLES:" << "\n";
+            for(int i = 0; i < binary_names.size(); ++i)
+            {
+                out << "VAR_B" << i +1 << ": " << binary_names.at(i);
+                out << ", bounds: (" << binary_min.at(i) << " < " << binary_value.at(i) << " < " << binary_max.at(i) << ")\n";
+            }
+            out << "\n";
+
+            out << "INTEGER VARIABLES:" << "\n";
+            for(int i = 0; i < int_names.size(); ++i)
+            {
+                out << "VAR_I" << i +1 << ": " << int_names.at(i);
+                out << ", bounds: (" << int_min.at(i) << " < " << int_value.at(i) << " < " << int_max.at(i) << ")\n";
+            }
+            out << "\n";
+
+            out << "CONSTRAINTS:" << "\n";
+            for(int i = 0; i < con_names.size(); i++)
+            {
+                out << "CON" << i +1 << ": " << con_names.at(i);
+                out << ", bounds: (" << con_min.at(i) << " < c < " << con_max.at(i) << ")\n";
+            }
+
+            out << "\nMODEL EVALUATIONS:" << "\n";
+            out << "----------------------------------------------------------------------\n";
+
+            out << "#\t" << "FEAS\t" << "OBJ\t";
+            for(int i = 0; i < real_names.size(); ++i) out << "VAR_C" << i +1 << "\t";
+            for(int i = 0; i < binary_names.size(); ++i) out << "VAR_B" << i + 1 << "\t";
+            for(int i = 0; i < int_names.size(); ++i) out << "VAR_I" << i + 1 << "\t";
+            for(int i = 0; i < con_names.size(); ++i) out << "CON" << i +1 << "\t";
+            out << "\n";
+        }
+
+        else if((kind == EVALUATION || kind == BEST) && has_header)
+        {
+            qint32 run, n_cons;
+            double obj;
+
+            in >> run >> n_cons >> obj;
+
+            values.resize(real_names.size() + binary_names.size() + con_names.size());
+            int_values.resize(int_names.size());
+
+            double *v = values.data();
+            for(int j = 0; j < real_names.size() + binary_names.size(); ++j) in >> v[j];
+            for(int j = 0; j < int_values.size(); ++j) in >> int_values[j];
+            for(int j = 0; j < con_names.size(); ++j) in >> v[real_names.size() + binary_names.size() + j];
+
+            if(in.status() != QDataStream::Ok) break;
+
+            const double *con_values = v + real_names.size() + binary_names.size();
+            n_cons = qMin(n_cons, qint32(con_names.size()));
+
+            if(kind == EVALUATION)
+            {
+                // feasibility, same test as Runner::isFeasible()
+                bool feas = (n_cons == con_names.size());
+                for(int j = 0; feas && j < n_cons; ++j)
+                {
+                    if(con_values[j] > con_max.at(j) + Runner::FEASIBILITY_TOLERANCE || con_values[j] < con_min.at(j) - Runner::FEASIBILITY_TOLERANCE) feas = false;
+                }
+
+                out.setRealNumberPrecision(8);
+
+                out << run << "\t";
+
+                if(feas) out << "yes\t";
+                else out << "no\t";
+
+                out << obj << "\t";
+
+                for(int j = 0; j < real_names.size() + binary_names.size(); ++j) out << v[j] << "\t";
+                for(int j = 0; j < int_values.size(); ++j) out << int_values.at(j) << "\t";
+
+                for(int j = 0; j < n_cons; ++j)
+                {
+                    if(!feas && (con_values[j] > con_max.at(j) || con_values[j] < con_min.at(j))) out << con_values[j] << "*\t";
+                    else out << con_values[j] << "\t";
+                }
+
+                out << "\n";
+            }
+            else
+            {
+                out.setRealNumberPrecision(6);
+
+                out << "\nBEST CASE:\n";
+
+                out << "#\t\t" << "OBJ\t";
+                for(int i = 0; i < real_names.size(); ++i) out << "VAR_C" << i +1 << "\t";
+                for(int i = 0; i < binary_names.size(); ++i) out << "VAR_B" << i + 1 << "\t";
+                for(int i = 0; i < int_names.size(); ++i) out << "VAR_I" << i + 1 << "\t";
+                out << "\n";
+
+                out << "xx" << "\t\t" << obj << "\t";
+                for(int j = 0; j < real_names.size() + binary_names.size(); ++j) out << v[j] << "\t";
+                for(int j = 0; j < int_values.size(); ++j) out << int_values.at(j) << "\t";
+                for(int j = 0; j < n_cons; ++j) out << con_values[j] << "\t";
+
+                out << "\n\n";
+            }
+        }
+
+        else if(kind == STATISTICS)
+        {
+            double execution_time;
+            qint32 evaluations, res_sim_runs, cache_hits;
+
+            in >> execution_time >> evaluations >> res_sim_runs >> cache_hits;
+
+            if(in.status() != QDataStream::Ok) break;
+
+            out << "Total execution time: " << execution_time << " seconds\n";
+            out << "Total number of model evaluations: " << evaluations << "\n";
+            out << "Number of reservoir simulator launches: " << res_sim_runs << "\n";
+            out << "Number of evaluations found in cache: " << cache_hits << "\n";
+        }
+
+        else
+        {
+            qWarning("Unknown record in the summary log, stopping: %s", bin_file.toLatin1().constData());
+            break;
+        }
+    }
+
+    out.flush();
+
+    return true;
+}
+
+} // namespace ResOpt
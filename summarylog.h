@@ -0,0 +1,151 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef SUMMARYLOG_H
+#define SUMMARYLOG_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+
+class QFile;
+class QThread;
+class QDataStream;
+
+namespace ResOpt
+{
+
+class Model;
+class Case;
+class CaseQueue;
+
+
+/**
+ * @brief Writes the blocks of the summary file from a separate thread.
+ * @details Used by SummaryLog. The blocks are already encoded when they are passed to write().
+ *
+ */
+class SummaryLogWriter : public QObject
+{
+    Q_OBJECT
+private:
+    QFile *p_file;
+
+public:
+    SummaryLogWriter(QFile *f) : p_file(f) {}
+
+public slots:
+    void write(const QByteArray &block);
+    void flush();
+};
+
+
+/**
+ * @brief Binary log of all the model evaluations during a run.
+ * @details The file starts with a magic number and a version, and is followed by a sequence of records. Each record starts with its kind:
+ *
+ *          HEADER describes the model and the optimization problem (names, bounds and starting values of the variables and constraints).
+ *          EVALUATION and BEST are fixed width records with the run number, the objective, and the variable and constraint values of a case.
+ *          The width is given by the last HEADER. STATISTICS holds the run time and counters written after the best case.
+ *
+ *          The records are encoded by the calling thread, and written to the file from a background thread, so the Runner does not wait
+ *          for the disk, and no text is formatted during the run. The human readable summary is generated from the log afterwards with
+ *          render() (ResOpt -summary run_summary.bin), in the same format as the old run_summary.out.
+ *
+ */
+class SummaryLog
+{
+public:
+    enum RecordKind {HEADER = 1, EVALUATION = 2, BEST = 3, STATISTICS = 4};
+
+private:
+    QFile *p_file;
+    QThread *p_thread;
+    SummaryLogWriter *p_writer;
+
+    int m_number_of_real;
+    int m_number_of_binary;
+    int m_number_of_integer;
+    int m_number_of_constraints;
+
+    void post(const QByteArray &block);
+    void writeCase(QDataStream &out, RecordKind kind, int run, Case *c);
+
+public:
+    SummaryLog();
+    ~SummaryLog();
+
+    /**
+     * @brief Opens the log file, and starts the writer thread.
+     * @details The content from previous launches is deleted, unless append is set. Then the new records are added after the existing ones,
+     *          so the log of a resumed run keeps the history from before it was interrupted. A file that is not a summary log is started over.
+     *
+     * @param f
+     * @param append
+     * @return bool false if the file could not be opened
+     */
+    bool open(const QString &f, bool append = false);
+
+    /**
+     * @brief Appends a HEADER record describing the current state of the model.
+     *
+     * @param m
+     */
+    void writeHeader(Model *m);
+
+    /**
+     * @brief Appends one EVALUATION record for each of the cases. The first case gets run number first_run.
+     *
+     * @param cases
+     * @param first_run
+     */
+    void writeCases(CaseQueue *cases, int first_run);
+
+    /**
+     * @brief Appends the BEST record and the STATISTICS record, and waits for everything to be written to disk.
+     *
+     */
+    void writeBestCase(Case *c, double execution_time, int evaluations, int res_sim_runs, int cache_hits);
+
+    /**
+     * @brief Blocks until all the records posted so far have been written to the file.
+     *
+     */
+    void flush();
+
+
+    /**
+     * @brief Writes the text summary for the log in file bin_file to txt_file.
+     * @details Feasibility and broken constraints are marked from the bounds stored in the header, in the same way as Runner::isFeasible().
+     *
+     * @param bin_file
+     * @param txt_file
+     * @return bool false if the log could not be read or the text file could not be opened
+     */
+    static bool render(const QString &bin_file, const QString &txt_file);
+
+    bool isOpen() const {return p_file != 0;}
+};
+
+} // namespace ResOpt
+
+#endif // SUMMARYLOG_H
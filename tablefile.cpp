@@ -0,0 +1,369 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#include "tablefile.h"
+
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <string.h>
+#include <iostream>
+
+using std::tr1::weak_ptr;
+using std::cout;
+using std::endl;
+
+namespace ResOpt
+{
+
+// identifies the file type, version, and byte order of the compiled table files
+static const quint32 TABLE_FILE_MAGIC = 0x52534f54;
+static const quint32 TABLE_FILE_VERSION = 2;
+static const quint32 TABLE_FILE_BYTE_ORDER = 0x01020304;
+
+// size of the header: magic, version, byte order, number of tables, source size, and the source hash padded to 8 bytes
+static const int TABLE_FILE_HASH_SIZE = 20;
+static const qint64 TABLE_FILE_HEADER_SIZE = 4 * sizeof(quint32) + sizeof(quint64) + 24;
+
+// the largest count (of tables, axes, grids or values) that is accepted from a file, so that it fits in an int
+static const quint64 TABLE_FILE_MAX_COUNT = 0x7fffffff;
+
+// the table files that are in use, shared between all the Launchers
+static QHash<QString, weak_ptr<TableFile> > s_open_files;
+static QMutex s_open_files_mutex;
+
+static QMutex s_compile_mutex;
+
+
+//-----------------------------------------------------------------------------------------------
+// helpers for writing the file
+//-----------------------------------------------------------------------------------------------
+static void appendRaw(QByteArray &out, const void *data, int size)
+{
+    out.append(static_cast<const char*>(data), size);
+}
+
+static void pad(QByteArray &out)
+{
+    while(out.size() % 8 != 0) out.append('\0');
+}
+
+static qint64 alignedSize(qint64 size)
+{
+    return (size + 7) / 8 * 8;
+}
+
+//-----------------------------------------------------------------------------------------------
+// finds the size and hash of the source file, returns false if the file can not be read
+//-----------------------------------------------------------------------------------------------
+static bool sourceFingerprint(const QString &source, quint64 *size, QByteArray *hash)
+{
+    QFile file(source);
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    QByteArray contents = file.readAll();
+
+    *size = contents.size();
+    *hash = QCryptographicHash::hash(contents, QCryptographicHash::Sha1);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// builds the contents of a table file
+//-----------------------------------------------------------------------------------------------
+static QByteArray serialize(const QList<TableFile::TableData> &tables, quint64 source_size, const QByteArray &source_hash)
+{
+    QByteArray out;
+
+    quint32 header[4] = {TABLE_FILE_MAGIC, TABLE_FILE_VERSION, TABLE_FILE_BYTE_ORDER, static_cast<quint32>(tables.size())};
+    appendRaw(out, header, sizeof(header));
+
+    appendRaw(out, &source_size, sizeof(source_size));
+    out.append(source_hash.left(TABLE_FILE_HASH_SIZE));
+    while(out.size() < TABLE_FILE_HEADER_SIZE) out.append('\0');
+
+    // finding the size of the directory, the values start after it
+    qint64 offset = out.size();
+    for(int i = 0; i < tables.size(); ++i)
+    {
+        offset += 4 * sizeof(quint32);
+        offset += alignedSize(tables.at(i).name.toUtf8().size());
+        offset += alignedSize(tables.at(i).axes.size() * sizeof(quint32));
+        offset += sizeof(quint64);
+    }
+
+    // the directory
+    for(int i = 0; i < tables.size(); ++i)
+    {
+        const TableFile::TableData &t = tables.at(i);
+        QByteArray name = t.name.toUtf8();
+
+        quint32 entry[4] = {static_cast<quint32>(name.size()), static_cast<quint32>(t.axes.size()), static_cast<quint32>(t.grids.size()), 0};
+        appendRaw(out, entry, sizeof(entry));
+
+        out.append(name);
+        pad(out);
+
+        for(int a = 0; a < t.axes.size(); ++a)
+        {
+            quint32 size = t.axes.at(a).size();
+            appendRaw(out, &size, sizeof(size));
+        }
+        pad(out);
+
+        quint64 start = offset;
+        appendRaw(out, &start, sizeof(start));
+
+        for(int a = 0; a < t.axes.size(); ++a) offset += t.axes.at(a).size() * sizeof(double);
+        for(int g = 0; g < t.grids.size(); ++g) offset += t.grids.at(g).size() * sizeof(double);
+    }
+
+    // the values
+    for(int i = 0; i < tables.size(); ++i)
+    {
+        const TableFile::TableData &t = tables.at(i);
+
+        for(int a = 0; a < t.axes.size(); ++a) appendRaw(out, t.axes.at(a).constData(), t.axes.at(a).size() * sizeof(double));
+        for(int g = 0; g < t.grids.size(); ++g) appendRaw(out, t.grids.at(g).constData(), t.grids.at(g).size() * sizeof(double));
+    }
+
+    return out;
+}
+
+
+TableFile::TableFile()
+    : p_data(0),
+      m_size(0),
+      m_source_size(0)
+{
+}
+
+TableFile::~TableFile()
+{
+    if(p_data != 0 && isMapped()) m_file.unmap(const_cast<uchar*>(p_data));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// sets up the pointers to the tables, returns false if the file is corrupt
+//-----------------------------------------------------------------------------------------------
+bool TableFile::readDirectory()
+{
+    m_tables.clear();
+
+    if(p_data == 0 || m_size < TABLE_FILE_HEADER_SIZE) return false;
+
+    const quint32 *header = reinterpret_cast<const quint32*>(p_data);
+    if(header[0] != TABLE_FILE_MAGIC || header[1] != TABLE_FILE_VERSION || header[2] != TABLE_FILE_BYTE_ORDER) return false;
+
+    memcpy(&m_source_size, p_data + 4 * sizeof(quint32), sizeof(m_source_size));
+    m_source_hash = QByteArray(reinterpret_cast<const char*>(p_data + 4 * sizeof(quint32) + sizeof(quint64)), TABLE_FILE_HASH_SIZE);
+
+    // the counts in the file can not be larger than what fits in the file, checking this before any sizes are calculated from them
+    const quint64 max_values = qMin(quint64(m_size) / sizeof(double), TABLE_FILE_MAX_COUNT);
+    const quint64 max_entries = qMin(quint64(m_size) / (4 * sizeof(quint32)), TABLE_FILE_MAX_COUNT);
+
+    if(header[3] > max_entries) return false;
+
+    int n_tables = header[3];
+    qint64 pos = TABLE_FILE_HEADER_SIZE;
+
+    for(int i = 0; i < n_tables; ++i)
+    {
+        if(pos + qint64(4 * sizeof(quint32)) > m_size) return false;
+
+        const quint32 *entry = reinterpret_cast<const quint32*>(p_data + pos);
+        if(entry[0] > qMin(quint64(m_size), TABLE_FILE_MAX_COUNT) || entry[1] > max_values || entry[2] > max_values) return false;
+
+        int name_len = entry[0];
+        int n_axes = entry[1];
+        int n_grids = entry[2];
+        pos += 4 * sizeof(quint32);
+
+        if(pos + alignedSize(name_len) + alignedSize(qint64(n_axes) * sizeof(quint32)) + qint64(sizeof(quint64)) > m_size) return false;
+
+        Table t;
+        t.name = QString::fromUtf8(reinterpret_cast<const char*>(p_data + pos), name_len);
+        pos += alignedSize(name_len);
+
+        // the number of values is checked against the file size after each step, so that it can not overflow. The interpolation needs at
+        // least one value on each axis
+        const quint32 *sizes = reinterpret_cast<const quint32*>(p_data + pos);
+        quint64 grid_size = 1;
+        quint64 n_values = 0;
+        for(int a = 0; a < n_axes; ++a)
+        {
+            if(sizes[a] < 1 || sizes[a] > max_values - n_values) return false;
+            if(grid_size > max_values / sizes[a]) return false;
+
+            t.axis_sizes.push_back(sizes[a]);
+            grid_size *= sizes[a];
+            n_values += sizes[a];
+        }
+        if(quint64(n_grids) > (max_values - n_values) / grid_size) return false;
+
+        n_values += n_grids * grid_size;
+        pos += alignedSize(qint64(n_axes) * sizeof(quint32));
+
+        quint64 offset;
+        memcpy(&offset, p_data + pos, sizeof(offset));
+        pos += sizeof(quint64);
+
+        if(offset % 8 != 0 || offset > quint64(m_size) || n_values > (quint64(m_size) - offset) / sizeof(double)) return false;
+
+        // setting up the pointers to the values
+        const double *values = reinterpret_cast<const double*>(p_data + offset);
+        for(int a = 0; a < n_axes; ++a)
+        {
+            t.axes.push_back(values);
+            values += t.axis_sizes.at(a);
+        }
+        for(int g = 0; g < n_grids; ++g)
+        {
+            t.grids.push_back(values);
+            values += grid_size;
+        }
+
+        m_tables.push_back(t);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// opens a compiled table file
+//-----------------------------------------------------------------------------------------------
+shared_ptr<TableFile> TableFile::open(const QString &file, const QString &source)
+{
+    QFileInfo info(file);
+    if(!info.exists()) return shared_ptr<TableFile>();
+
+    // finding the size and contents of the source, the compiled file must have been made from the same source
+    quint64 source_size = 0;
+    QByteArray source_hash;
+    bool check_source = !source.isEmpty() && sourceFingerprint(source, &source_size, &source_hash);
+
+    QMutexLocker locker(&s_open_files_mutex);
+
+    // checking if the file is already in use
+    shared_ptr<TableFile> tf = s_open_files.value(info.absoluteFilePath()).lock();
+
+    if(tf == 0)
+    {
+        tf = shared_ptr<TableFile>(new TableFile());
+        tf->m_file.setFileName(info.absoluteFilePath());
+
+        if(!tf->m_file.open(QIODevice::ReadOnly)) return shared_ptr<TableFile>();
+
+        tf->m_size = tf->m_file.size();
+        tf->p_data = tf->m_file.map(0, tf->m_size);
+
+        // the file could not be mapped, reading it instead
+        if(tf->p_data == 0)
+        {
+            tf->m_buffer = tf->m_file.readAll();
+            tf->p_data = reinterpret_cast<const uchar*>(tf->m_buffer.constData());
+            tf->m_size = tf->m_buffer.size();
+        }
+
+        if(!tf->readDirectory())
+        {
+            cout << "### Warning ###" << endl
+                 << "The compiled table file is corrupt, and will be rebuilt..." << endl
+                 << "FILE: " << file.toLatin1().constData() << endl;
+
+            return shared_ptr<TableFile>();
+        }
+
+        s_open_files.insert(info.absoluteFilePath(), tf);
+    }
+
+    // checking that the file is up to date
+    if(check_source && (tf->m_source_size != source_size || tf->m_source_hash != source_hash)) return shared_ptr<TableFile>();
+
+    return tf;
+}
+
+//-----------------------------------------------------------------------------------------------
+// writes a compiled table file
+//-----------------------------------------------------------------------------------------------
+shared_ptr<TableFile> TableFile::create(const QString &file, const QString &source, const QList<TableData> &tables)
+{
+    quint64 source_size = 0;
+    QByteArray source_hash;
+    sourceFingerprint(source, &source_size, &source_hash);
+
+    QSaveFile out(file);
+
+    if(out.open(QIODevice::WriteOnly))
+    {
+        out.write(serialize(tables, source_size, source_hash));
+
+        if(out.commit())
+        {
+            // removing the old version from the registry, if any
+            {
+                QMutexLocker locker(&s_open_files_mutex);
+                s_open_files.remove(QFileInfo(file).absoluteFilePath());
+            }
+
+            shared_ptr<TableFile> tf = open(file, QString());
+            if(tf != 0) return tf;
+        }
+    }
+
+    cout << "### Warning ###" << endl
+         << "Could not write the compiled table file, keeping the tables in memory..." << endl
+         << "FILE: " << file.toLatin1().constData() << endl;
+
+    return fromMemory(tables);
+}
+
+//-----------------------------------------------------------------------------------------------
+// builds the tables in memory
+//-----------------------------------------------------------------------------------------------
+shared_ptr<TableFile> TableFile::fromMemory(const QList<TableData> &tables)
+{
+    shared_ptr<TableFile> tf(new TableFile());
+
+    tf->m_buffer = serialize(tables, 0, QByteArray());
+    tf->p_data = reinterpret_cast<const uchar*>(tf->m_buffer.constData());
+    tf->m_size = tf->m_buffer.size();
+
+    tf->readDirectory();
+
+    return tf;
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the mutex used while compiling table files
+//-----------------------------------------------------------------------------------------------
+QMutex* TableFile::compileMutex()
+{
+    return &s_compile_mutex;
+}
+
+} // namespace ResOpt
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QFile>
+#include <QByteArray>
+#include <tr1/memory>
+
+class QMutex;
+
+using std::tr1::shared_ptr;
+
+namespace ResOpt
+{
+
+/**
+ * @brief Compiled binary file of interpolation tables (VLP and DP tables).
+ * @details Each table consists of a number of axes (the sorted unique values for each input) and a number of dense grids of outputs,
+ *          stored as plain arrays of doubles. The file is memory-mapped read-only, and the tables are used directly from the mapping,
+ *          without any parsing. The binary file is written once from the text table, and used as long as the size and SHA-1 hash
+ *          of the text file match the ones stored in the header.
+ *
+ *          Files opened through open() are shared through a registry, so all the Launchers (and all the copies of the tables) use the same
+ *          mapping. If the binary file can not be written, the tables are kept in memory with the same layout.
+ *
+ *          Layout (native byte order): magic, version, byte order mark, number of tables, size of the source file, SHA-1 hash of
+ *          the source file (padded to 8 bytes). Then for each table: the length of the name,
+ *          number of axes, number of grids, the name (padded to 8 bytes), the size of each axis (padded to 8 bytes, at least one value per
+ *          axis), and the offset of the values. The values are the axes followed by the grids, with the first axis varying slowest in the grids.
+ *
+ */
+class TableFile
+{
+public:
+
+    /**
+     * @brief A table that should be written to a TableFile.
+     *
+     */
+    struct TableData
+    {
+        QString name;
+        QVector<QVector<double> > axes;
+        QVector<QVector<double> > grids;
+    };
+
+private:
+
+    /**
+     * @brief Pointers into the file for one table.
+     *
+     */
+    struct Table
+    {
+        QString name;
+        QVector<int> axis_sizes;
+        QVector<const double*> axes;
+        QVector<const double*> grids;
+    };
+
+    QFile m_file;
+    QByteArray m_buffer;        // the contents, when the tables are not mapped from a file
+    const uchar *p_data;
+    qint64 m_size;
+    quint64 m_source_size;      // size of the source (text) file the tables were compiled from
+    QByteArray m_source_hash;   // SHA-1 of the source file
+
+    QList<Table> m_tables;
+
+    TableFile();
+
+    bool readDirectory();
+
+public:
+    ~TableFile();
+
+
+    /**
+     * @brief Opens a compiled table file, if it was compiled from the current contents of the source (text) file.
+     * @details The file is shared with earlier calls for the same file, as long as one of them is still in use. If the source is empty, or
+     *          can not be read, the compiled file is used without checking it against the source.
+     *
+     * @param file
+     * @param source
+     * @return shared_ptr<TableFile> null if the file does not exist, is out of date, or is corrupt
+     */
+    static shared_ptr<TableFile> open(const QString &file, const QString &source);
+
+
+    /**
+     * @brief Writes a compiled table file, and opens it.
+     * @details If the file can not be written, the tables are kept in memory (see fromMemory()).
+     *
+     * @param file
+     * @param source the source (text) file the tables were read from, its size and hash are stored in the header
+     * @param tables
+     * @return shared_ptr<TableFile>
+     */
+    static shared_ptr<TableFile> create(const QString &file, const QString &source, const QList<TableData> &tables);
+
+
+    /**
+     * @brief Builds the tables in memory, with the same layout as the file.
+     *
+     * @param tables
+     * @return shared_ptr<TableFile>
+     */
+    static shared_ptr<TableFile> fromMemory(const QList<TableData> &tables);
+
+
+    /**
+     * @brief Mutex that should be held while a table file is compiled, so that Launchers starting up at the same time do not all compile it.
+     *
+     * @return QMutex
+     */
+    static QMutex* compileMutex();
+
+
+    // get functions
+    int numberOfTables() const {return m_tables.size();}
+    const QString& tableName(int table) const {return m_tables.at(table).name;}
+    int numberOfAxes(int table) const {return m_tables.at(table).axes.size();}
+    int numberOfGrids(int table) const {return m_tables.at(table).grids.size();}
+    int axisSize(int table, int axis) const {return m_tables.at(table).axis_sizes.at(axis);}
+    const double* axis(int table, int axis) const {return m_tables.at(table).axes.at(axis);}
+    const double* grid(int table, int grid) const {return m_tables.at(table).grids.at(grid);}
+    bool isMapped() const {return m_buffer.isEmpty();}
+
+};
+
+} // namespace ResOpt
+
+#endif // TABLEFILE_H
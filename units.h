@@ -0,0 +1,144 @@
+/*
+ * This file is part of the ResOpt project.
+ *
+ * Copyright (C) 2011-2014 Aleksander O. Juell <aleksander.juell@ntnu.no>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+
+#ifndef UNITS_H
+#define UNITS_H
+
+namespace ResOpt
+{
+
+/**
+ * @brief Compile time unit conversions for the quantities carried by a Stream.
+ * @details Each physical quantity is a tag type holding the factor from field to metric units. Conversion<Q, From, To> resolves the
+ *          factor at compile time, and Quantity<Q, U> is a value of quantity Q in unit system U. A Quantity converts implicitly to
+ *          the same quantity in the other unit system, but not to a different quantity, so adding a pressure to a rate, or passing
+ *          a gas rate where a liquid rate is expected, does not compile.
+ *
+ */
+namespace Units
+{
+
+enum system {METRIC, FIELD};
+
+
+// the quantities, with the factor from field to metric units
+
+struct LiquidRate   // bbl/d <-> m^3/d
+{
+    static double fieldToMetric() {return 0.158987295;}
+};
+
+struct GasRate      // mcf/d <-> m^3/d
+{
+    static double fieldToMetric() {return 28.3168466;}
+};
+
+struct Pressure     // psia <-> bara
+{
+    static double fieldToMetric() {return 1.0 / 14.5037738;}
+};
+
+
+// conversion from one unit system to another, no conversion if the systems are the same
+
+template<class Q, system From, system To>
+struct Conversion
+{
+    static double apply(double v) {return v;}
+    static double factor() {return 1.0;}
+};
+
+template<class Q>
+struct Conversion<Q, FIELD, METRIC>
+{
+    static double apply(double v) {return v * Q::fieldToMetric();}
+    static double factor() {return Q::fieldToMetric();}
+};
+
+template<class Q>
+struct Conversion<Q, METRIC, FIELD>
+{
+    static double apply(double v) {return v / Q::fieldToMetric();}
+    static double factor() {return 1.0 / Q::fieldToMetric();}
+};
+
+
+/**
+ * @brief Returns the factor from unit system from to unit system to, for when the systems are only known at runtime.
+ * @details Used at the input/output boundaries. Loops over values in a single unit system should get the factor once, outside the loop.
+ *
+ */
+template<class Q>
+inline double factor(system from, system to)
+{
+    if(from == to) return 1.0;
+    else if(from == FIELD) return Conversion<Q, FIELD, METRIC>::factor();
+    else return Conversion<Q, METRIC, FIELD>::factor();
+}
+
+
+/**
+ * @brief A value of quantity Q in unit system U.
+ *
+ */
+template<class Q, system U>
+class Quantity
+{
+private:
+    double m_value;
+
+public:
+    explicit Quantity(double v = 0.0) : m_value(v) {}
+
+    // converting from the other unit system
+    template<system V>
+    Quantity(const Quantity<Q, V> &q) : m_value(Conversion<Q, V, U>::apply(q.value())) {}
+
+    double value() const {return m_value;}
+
+    Quantity& operator+=(const Quantity &rhs) {m_value += rhs.m_value; return *this;}
+    Quantity& operator-=(const Quantity &rhs) {m_value -= rhs.m_value; return *this;}
+
+    const Quantity operator+(const Quantity &rhs) const {return Quantity(m_value + rhs.m_value);}
+    const Quantity operator-(const Quantity &rhs) const {return Quantity(m_value - rhs.m_value);}
+    const Quantity operator*(double rhs) const {return Quantity(m_value * rhs);}
+    const Quantity operator/(double rhs) const {return Quantity(m_value / rhs);}
+
+    bool operator<(const Quantity &rhs) const {return m_value < rhs.m_value;}
+    bool operator>(const Quantity &rhs) const {return m_value > rhs.m_value;}
+};
+
+
+// the quantities in the units they are usually given in
+
+typedef Quantity<LiquidRate, FIELD> BarrelsPerDay;
+typedef Quantity<LiquidRate, METRIC> CubicMetersPerDay;
+typedef Quantity<GasRate, FIELD> McfPerDay;
+typedef Quantity<GasRate, METRIC> GasCubicMetersPerDay;
+typedef Quantity<Pressure, FIELD> Psia;
+typedef Quantity<Pressure, METRIC> Bara;
+
+} // namespace Units
+
+} // namespace ResOpt
+
+#endif // UNITS_H
@@ -37,6 +37,14 @@ UserConstraint::UserConstraint(const UserConstraint &uc, Model *new_model)
     // setting the model
     p_model = new_model;
 
+    // copying the compiled expression, pointing it to the components of the new model
+    m_terms = uc.m_terms;
+    for(int i = 0; i < m_terms.size(); ++i)
+    {
+        if(m_terms.at(i).is_well) m_terms[i].p_component = p_model->well(m_terms.at(i).index);
+        else m_terms[i].p_component = p_model->pipe(m_terms.at(i).index);
+    }
+
     // copying the constraint
     p_constraint = shared_ptr<Constraint>(new Constraint(*uc.p_constraint));
 
@@ -54,6 +62,10 @@ void UserConstraint::initialize()
     p_constraint->setName("User defined constraint: " + m_expression);
 
     generateArguments();
+
+    // compiling the expression
+    m_terms.clear();
+    for(int i = 0; i < m_arguments.size(); ++i) m_terms.push_back(compileArgument(m_arguments.at(i), m_operators.at(i)));
 }
 
 
@@ -99,6 +111,9 @@ void UserConstraint::generateArguments()
     // parsing
     OPER current_operator = PLUSS;
 
+    m_arguments.clear();
+    m_operators.clear();
+
 
     for(int i = 0; i < arg_list.size(); i += 2)
     {
@@ -123,28 +138,82 @@ void UserConstraint::generateArguments()
 //-----------------------------------------------------------------------------------------------
 bool UserConstraint::update()
 {
-    bool ok = true;
-
     double value = 0;
 
-    // looping through the list of arguments, adding them together
-    for(int i = 0; i < m_arguments.size(); ++i)
+    // looping through the compiled arguments, adding them together
+    for(int i = 0; i < m_terms.size(); ++i)
     {
-        if(m_operators.at(i) == PLUSS) value += resolveArgumentValue(m_arguments.at(i), &ok);
-        else if(m_operators.at(i) == MINUS) value -= resolveArgumentValue(m_arguments.at(i), &ok);
+        value += m_terms.at(i).sign * termValue(m_terms.at(i));
     }
 
     // setting the value to the constraint
     p_constraint->setValue(value);
 
-    return ok;
+    return true;
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// returns the current value of a compiled argument
+//-----------------------------------------------------------------------------------------------
+double UserConstraint::termValue(const Term &t) const
+{
+    Stream *s = t.p_component->stream(t.time_step);
+
+    switch(t.quantity)
+    {
+    case GAS:
+        return s->gasRate(true);
+
+    case OIL:
+        return s->oilRate(true);
+
+    case WATER:
+        return s->waterRate(true);
+
+    case PRESSURE:
+        return s->pressure(true);
 
+    case GASLIFT:
+    {
+        // the gas lift rate times the sum of the routing variables
+        ProductionWell *prod_well = static_cast<ProductionWell*>(t.p_component);
+
+        double routing = 0;
+        for(int k = 0; k < prod_well->numberOfPipeConnections(); ++k)
+        {
+            routing += prod_well->pipeConnection(k)->variable()->value();
+        }
+
+        return prod_well->gasLiftControl(t.time_step)->controlVar()->value() * routing;
+    }
+
+    case REMOVED:
+    {
+        // the amount of water or gas removed from the separator
+        Separator *sep = static_cast<Separator*>(t.p_component);
+
+        double q_remove = 0;
+        if(t.time_step >= sep->installTime()->value())
+        {
+            // checking if this is a water or gas separator
+            if(sep->type() == Separator::WATER) q_remove = s->waterRate(true) * sep->removeFraction()->value();
+            else if(sep->type() == Separator::GAS) q_remove = s->gasRate(true) * sep->removeFraction()->value();
+
+            if(q_remove > sep->removeCapacity()->value()) q_remove = sep->removeCapacity()->value();
+        }
+
+        return q_remove;
+    }
+    }
+
+    return 0;
 }
 
 //-----------------------------------------------------------------------------------------------
-// tries to find out what the argument represents in the model, and returns the value
+// tries to find out what the argument represents in the model
 //-----------------------------------------------------------------------------------------------
-double UserConstraint::resolveArgumentValue(QString arg, bool *ok)
+UserConstraint::Term UserConstraint::compileArgument(const QString &arg, OPER op)
 {
     // syntax:
     // type_id_comp_ts
@@ -152,164 +221,99 @@ double UserConstraint::resolveArgumentValue(QString arg, bool *ok)
     // PIPE_1_GAS_2
     // SEP_3_REMOVED_3
 
-    double value = 0;
+    Term t;
+    t.sign = (op == MINUS) ? -1.0 : 1.0;
+    t.is_well = false;
+    t.index = -1;
+    t.p_component = 0;
 
     bool ok_l = true;
 
     QStringList list = arg.split("_");
+    if(list.size() < 4) error("The argument does not have the format type_id_component_timestep: " + arg);
 
     QString type = list.at(0);          // well, pipe, separator
     QString id = list.at(1);            // well name or pipe number
     QString component = list.at(2);     // W, G, O, P, or REMOVED (separator only)
-    int time_step = list.at(3).toInt(&ok_l);     // time step number according to master schedule
+    t.time_step = list.at(3).toInt(&ok_l);     // time step number according to master schedule
     if(!ok_l) error("The time step could not be converted to an integer: " + list.at(3));
-    if(time_step >= p_model->numberOfMasterScheduleTimes() || time_step < 0) error("The entered time step is not valid: " + list.at(3));
+    if(t.time_step >= p_model->numberOfMasterScheduleTimes() || t.time_step < 0) error("The entered time step is not valid: " + list.at(3));
 
     if(type.startsWith("WELL"))     // the argument is for a well
     {
-        Well *w = 0;
+        t.is_well = true;
 
         // looping through the wells, finding the correct one
         for(int i = 0; i < p_model->numberOfWells(); ++i)
         {
             if(p_model->well(i)->name().compare(id) == 0)   // this is the correct well
             {
-                w = p_model->well(i);
+                t.index = i;
                 break;
             }
         }
 
-        if(w == 0) error("Could not find a well named " + id);
+        if(t.index < 0) error("Could not find a well named " + id);
+
+        Well *w = p_model->well(t.index);
+        t.p_component = w;
 
         // now checking what type of rate to extract
-        if(component.startsWith("G")) value = w->stream(time_step)->gasRate(true);
-        else if(component.startsWith("O")) value = w->stream(time_step)->oilRate(true);
-        else if(component.startsWith("W")) value = w->stream(time_step)->waterRate(true);
-        else if(component.startsWith("P")) value = w->stream(time_step)->pressure(true);
+        if(component.startsWith("G")) t.quantity = GAS;
+        else if(component.startsWith("O")) t.quantity = OIL;
+        else if(component.startsWith("W")) t.quantity = WATER;
+        else if(component.startsWith("P")) t.quantity = PRESSURE;
         else if(component.startsWith("L")) // gas lift
         {
-            // checking if this is a production well
+            // checking if this is a production well with gas lift
             ProductionWell *prod_well = dynamic_cast<ProductionWell*>(w);
 
-            if(prod_well != 0)
-            {
-                // checking if the well has gas lift
-                if(prod_well->hasGasLift())
-                {
-                    // summing together the routing variables
-                    double routing = 0;
-                    for(int k = 0; k < prod_well->numberOfPipeConnections(); ++k)
-                    {
-                        routing += prod_well->pipeConnection(k)->variable()->value();
-                    }
-
-                    value = prod_well->gasLiftControl(time_step)->controlVar()->value() * routing;
-                }
-                else error("The well did not have gas lift when L was specified");
-            }
-            else error("L can only be specified for production wells");
+            if(prod_well == 0) error("L can only be specified for production wells");
+            if(!prod_well->hasGasLift()) error("The well did not have gas lift when L was specified");
 
+            t.quantity = GASLIFT;
         }
         else error("Type of component not recognized: " + component);
 
     } // well
-    else if(type.startsWith("PIPE"))
+    else if(type.startsWith("PIPE") || type.startsWith("SEP"))
     {
-        Pipe *p = 0;
+        bool separator = type.startsWith("SEP");
 
         int pipe_id = id.toInt(&ok_l);
-        if(!ok_l) error("The pipe id could not be converted to an integer: " + id);
+        if(!ok_l) error(QString(separator ? "The separator" : "The pipe") + " id could not be converted to an integer: " + id);
 
         // looping through the pipes, finding the correct one
         for(int i = 0; i < p_model->numberOfPipes(); ++i)
         {
-            if(p_model->pipe(i)->number() == pipe_id)   // this is the correct well
+            if(p_model->pipe(i)->number() == pipe_id)   // this is the correct pipe
             {
-                p = p_model->pipe(i);
+                t.index = i;
                 break;
             }
         }
 
-        if(p == 0) error("Could not find a pipe with id = " + id);
+        if(t.index < 0) error(QString(separator ? "Could not find a separator" : "Could not find a pipe") + " with id = " + id);
 
-        // now checking what type of rate to extract
-        if(component.startsWith("GAS")) value = p->stream(time_step)->gasRate(true);
-        else if(component.startsWith("OIL")) value = p->stream(time_step)->oilRate(true);
-        else if(component.startsWith("WAT")) value = p->stream(time_step)->waterRate(true);
-        else if(component.startsWith("P")) value = p->stream(time_step)->pressure(true);
-        else error("Type of component not recognized: " + component);
+        t.p_component = p_model->pipe(t.index);
 
-
-    } // pipe
-    else if(type.startsWith("SEP"))
-    {
-        // first finding the pipe with the correct id, will later try to cast it to separator
-
-        Pipe *p = 0;
-
-        int pipe_id = id.toInt(&ok_l);
-        if(!ok_l) error("The separator id could not be converted to an integer: " + id);
-
-        // looping through the pipes, finding the correct one
-        for(int i = 0; i < p_model->numberOfPipes(); ++i)
-        {
-            if(p_model->pipe(i)->number() == pipe_id)   // this is the correct well
-            {
-                p = p_model->pipe(i);
-                break;
-            }
-        }
-
-        if(p == 0) error("Could not find a separator with id = " + id);
-
-        // now checking if it actually is a separator
-        Separator *s = dynamic_cast<Separator*>(p);
-
-        if(s == 0) error("Component #" + id + " is not a separator");
+        // checking if it actually is a separator
+        if(separator && dynamic_cast<Separator*>(p_model->pipe(t.index)) == 0) error("Component #" + id + " is not a separator");
 
         // now checking what type of rate to extract
-        if(component.startsWith("GAS")) value = s->stream(time_step)->gasRate(true);
-        else if(component.startsWith("OIL")) value = s->stream(time_step)->oilRate(true);
-        else if(component.startsWith("WAT")) value = s->stream(time_step)->waterRate(true);
-        else if(component.startsWith("P")) value = s->stream(time_step)->pressure(true);
-        else if(component.startsWith("REM")) // the amount of water or gas removed from the separator
-        {
-            double q_remove = 0;
-            if(time_step >= s->installTime()->value())
-            {
-                // checking if this is a water or gas separator
-                if(s->type() == Separator::WATER)
-                {
-                    // how much water should be removed
-                    q_remove = s->stream(time_step)->waterRate(true) * s->removeFraction()->value();
-                    if(q_remove > s->removeCapacity()->value()) q_remove = s->removeCapacity()->value();
-                }
-                else if(s->type() == Separator::GAS)
-                {
-                    // how much gas should be removed
-                    q_remove = s->stream(time_step)->gasRate(true) * s->removeFraction()->value();
-                    if(q_remove > s->removeCapacity()->value()) q_remove = s->removeCapacity()->value();
-                }
-
-            }
-
-            value = q_remove;
-
-        }
+        if(component.startsWith("GAS")) t.quantity = GAS;
+        else if(component.startsWith("OIL")) t.quantity = OIL;
+        else if(component.startsWith("WAT")) t.quantity = WATER;
+        else if(component.startsWith("P")) t.quantity = PRESSURE;
+        else if(separator && component.startsWith("REM")) t.quantity = REMOVED;
         else error("Type of component not recognized: " + component);
 
-
-    } // separator
+    } // pipe or separator
 
     else error("The type of model component was not recognized: " + type);
 
 
-
-    cout << "Value for argument " << arg.toLatin1().constData() << " = " << value << endl;
-
-    return value;
-
-
+    return t;
 }
 
 //-----------------------------------------------------------------------------------------------
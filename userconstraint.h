@@ -4,6 +4,7 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QVector>
 #include <tr1/memory>
 
 using std::tr1::shared_ptr;
@@ -13,6 +14,7 @@ namespace ResOpt
 
 class Model;
 class Constraint;
+class Component;
 
 /**
  * @brief Class for user defined constraints
@@ -26,10 +28,33 @@ public:
 
 
 private:
+
+    /**
+     * @brief What an argument of the expression reads from the model component.
+     *
+     */
+    enum QUANTITY {GAS, OIL, WATER, PRESSURE, GASLIFT, REMOVED};
+
+    /**
+     * @brief An argument of the expression, resolved to a model component by initialize().
+     *
+     */
+    struct Term
+    {
+        double sign;                // +1 or -1
+        QUANTITY quantity;
+        int time_step;
+        bool is_well;               // the component is a well, otherwise a pipe or separator
+        int index;                  // index of the well or pipe in the model, used to rebind the term to a copied model
+        Component *p_component;
+    };
+
     QString m_expression;                       // the expression for the constraint
     QStringList m_arguments;
     QList<UserConstraint::OPER> m_operators;
 
+    QVector<Term> m_terms;                      // the compiled expression
+
 
     Model *p_model;
 
@@ -41,7 +66,17 @@ private:
 
     void generateArguments();
 
-    double resolveArgumentValue(QString arg, bool *ok);
+    /**
+     * @brief Finds the model component, time step, and quantity that an argument refers to.
+     * @details The string parsing and component lookup is only done here, update() only reads the values through the resolved terms.
+     *
+     * @param arg
+     * @param op
+     * @return Term
+     */
+    Term compileArgument(const QString &arg, OPER op);
+
+    double termValue(const Term &t) const;
 
     void error(QString msg);
 
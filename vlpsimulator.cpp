@@ -3,8 +3,10 @@
 #include <QFile>
 #include <iostream>
 #include <QDir>
+#include <QMutexLocker>
 
 #include "vlptable.h"
+#include "tablefile.h"
 #include "model.h"
 #include "reservoir.h"
 #include "productionwell.h"
@@ -186,6 +188,51 @@ bool VlpSimulator::readInput(const QString &file)
 
 }
 
+//-----------------------------------------------------------------------------------------------
+// Sets up the vlp tables from the compiled table file
+//-----------------------------------------------------------------------------------------------
+bool VlpSimulator::readCompiledInput(const QString &file)
+{
+    shared_ptr<TableFile> table_file = TableFile::open(file + ".bin", file);
+
+    if(table_file == 0) return false;
+
+    for(int i = 0; i < table_file->numberOfTables(); ++i)
+    {
+        // checking that the table has the right format
+        if(table_file->numberOfAxes(i) != 2 || table_file->numberOfGrids(i) != 3)
+        {
+            for(int j = 0; j < m_vlp_tables.size(); ++j) delete m_vlp_tables.at(j);
+            m_vlp_tables.clear();
+
+            return false;
+        }
+
+        VlpTable *table = new VlpTable();
+        table->setWellName(table_file->tableName(i));
+        table->setTableFile(table_file, i);
+
+        m_vlp_tables.push_back(table);
+    }
+
+    cout << "Using compiled vlp tables: " << QString(file + ".bin").toLatin1().constData() << endl;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Writes the vlp tables to the compiled table file
+//-----------------------------------------------------------------------------------------------
+void VlpSimulator::compileInput(const QString &file)
+{
+    QList<TableFile::TableData> tables;
+    for(int i = 0; i < m_vlp_tables.size(); ++i) tables.push_back(m_vlp_tables.at(i)->compile());
+
+    shared_ptr<TableFile> table_file = TableFile::create(file + ".bin", file, tables);
+
+    for(int i = 0; i < m_vlp_tables.size(); ++i) m_vlp_tables.at(i)->setTableFile(table_file, i);
+}
+
 //-----------------------------------------------------------------------------------------------
 // Reads the vlp tables if they have not been read yet
 //-----------------------------------------------------------------------------------------------
@@ -196,10 +243,17 @@ bool VlpSimulator::generateInputFiles(Model *m)
     if(numberOfVlpTables() == 0)
     {
 
-        // reservoir input file name:
-        QString file_name = folder() + "/" + m->reservoir()->file();
+        // reservoir input file name, the original in the driver file folder is used, so that all the launchers share the same compiled tables
+        QString file_name = m->driverPath() + "/" + m->reservoir()->file();
 
-        if(!readInput(file_name)) ok = false;
+        // only one launcher compiles the tables, the others use the compiled file when it is done
+        QMutexLocker locker(TableFile::compileMutex());
+
+        if(!readCompiledInput(file_name))
+        {
+            if(!readInput(file_name)) ok = false;
+            else compileInput(file_name);
+        }
     }
 
     return ok;
@@ -262,35 +316,49 @@ bool VlpSimulator::readOutput(Model *m)
 
                 bool has_gas_lift = prod_well->hasGasLift();
 
-                double pbh = 0;
-                double glift = 0;
-
+                m_pbh.resize(0);
+                m_glift.resize(0);
 
-                // looping through the time steps
+                // collecting the pbh and glift for the time steps where the well is installed
                 for(int j = 0; j < prod_well->numberOfControls(); ++j)
                 {
-
-                    // checking if the well is installed
                     if(prod_well->isInstalled(j))
                     {
+                        m_pbh.push_back(prod_well->control(j)->controlVar()->value());
+                        m_glift.push_back(has_gas_lift ? prod_well->gasLiftControl(j)->controlVar()->value() : 0);
+                    }
+                }
 
-                        // updating for this time step
-                        pbh = prod_well->control(j)->controlVar()->value();
-                        if(has_gas_lift) glift = prod_well->gasLiftControl(j)->controlVar()->value();
+                // interpolating the vlp table for all the time steps in one go
+                table->interpolate(m_pbh, m_glift, m_oil, m_gas, m_wat);
 
-                        // interpolating the vlp table
-                        Stream *s = table->interpolate(pbh, glift);
 
-                        s->setTime(prod_well->control(j)->endTime());
+                // looping through the time steps, updating the streams of the well
+                int k = 0;
+                for(int j = 0; j < prod_well->numberOfControls() && j < prod_well->numberOfStreams(); ++j)
+                {
+                    Stream *s = prod_well->stream(j);
 
+                    s->setTime(prod_well->control(j)->endTime());
+                    s->setInputUnits(Stream::FIELD);
+
+                    // checking if the well is installed
+                    if(prod_well->isInstalled(j))
+                    {
                         // setting the calculated rates to the well
-                        prod_well->setStream(j, s);
+                        s->setOilRate(m_oil.at(k));
+                        s->setGasRate(m_gas.at(k));
+                        s->setWaterRate(m_wat.at(k));
+                        s->setPressure(m_pbh.at(k));
 
+                        ++k;
                     }
-                    else // the well is not installed, generating an empty stream
+                    else // the well is not installed, empty stream
                     {
-                        Stream *s = new Stream(prod_well->control(j)->endTime(), 0, 0, 0, 0);
-                        prod_well->setStream(j, s);
+                        s->setOilRate(0);
+                        s->setGasRate(0);
+                        s->setWaterRate(0);
+                        s->setPressure(0);
                     }
                 }
             } // table ok
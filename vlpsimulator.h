@@ -5,6 +5,7 @@
 
 #include <QList>
 #include <QStringList>
+#include <QVector>
 class QFile;
 
 namespace ResOpt
@@ -19,9 +20,31 @@ private:
 
     QList<VlpTable*> m_vlp_tables;
 
+    // work vectors for the table interpolation in readOutput(), kept between calls to avoid reallocation
+    QVector<double> m_pbh;
+    QVector<double> m_glift;
+    QVector<double> m_oil;
+    QVector<double> m_gas;
+    QVector<double> m_wat;
+
     bool readInput(const QString &file);
     VlpTable* readVlpTable(const QString &well_name, QFile &input);
 
+    /**
+     * @brief Sets up the vlp tables from the compiled table file (file.bin), if it is up to date with the text file.
+     *
+     * @param file the reservoir definition file
+     * @return bool false if there is no up to date compiled file
+     */
+    bool readCompiledInput(const QString &file);
+
+    /**
+     * @brief Writes the vlp tables read from the text file to the compiled table file (file.bin), and makes the tables use it.
+     *
+     * @param file the reservoir definition file
+     */
+    void compileInput(const QString &file);
+
     VlpTable* findVlpTable(const QString &well_name);
 
     QStringList processLine(const QString &line);
@@ -37,7 +60,7 @@ public:
 
     virtual ReservoirSimulator* clone() const {return new VlpSimulator(*this);}
 
-    virtual QString description() const {return QString("SIMULATOR VLP\n\n");}
+    virtual QString description() const {return QString("SIMULATOR VLP") + (timeout() > 0 ? " " + QString::number(timeout()) : QString()) + "\n\n";}
 
     virtual bool generateInputFiles(Model *m);
     virtual bool launchSimulator();
@@ -14,6 +14,13 @@ namespace ResOpt
 
 
 VlpTable::VlpTable()
+    : p_pbh_entries(0),
+      p_glift_entries(0),
+      m_n_pbh(0),
+      m_n_glift(0),
+      p_grid_oil(0),
+      p_grid_gas(0),
+      p_grid_wat(0)
 {
 }
 
@@ -27,6 +34,10 @@ void VlpTable::addRow(double glift, double pbh, double gas, double oil, double w
     m_oil.push_back(oil);
     m_gas.push_back(gas);
     m_wat.push_back(wat);
+
+    // the table must be compiled again
+    p_table_file.reset();
+    m_n_glift = 0;
 }
 
 
@@ -36,35 +47,73 @@ void VlpTable::addRow(double glift, double pbh, double gas, double oil, double w
 //-----------------------------------------------------------------------------------------------
 Stream* VlpTable::interpolate(double pbh, double glift)
 {
-    // check if the table has been processed
-    if(m_glift_entries.size() == 0) process();
+    double qo = 0;
+    double qg = 0;
+    double qw = 0;
+
+    interpolatePoint(pbh, glift, &qo, &qg, &qw);
+
+    return new Stream(0, qo, qg, qw, pbh);
+}
+
+//-----------------------------------------------------------------------------------------------
+// interpolates the table for a list of points
+//-----------------------------------------------------------------------------------------------
+void VlpTable::interpolate(const QVector<double> &pbh, const QVector<double> &glift, QVector<double> &oil, QVector<double> &gas, QVector<double> &wat)
+{
+    // making sure the output has the right size, this does not reallocate if the size is already right
+    oil.resize(pbh.size());
+    gas.resize(pbh.size());
+    wat.resize(pbh.size());
+
+    double *qo = oil.data();
+    double *qg = gas.data();
+    double *qw = wat.data();
+
+    for(int i = 0; i < pbh.size(); ++i)
+    {
+        interpolatePoint(pbh.at(i), glift.at(i), &qo[i], &qg[i], &qw[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------
+// interpolates the table for a single point
+//-----------------------------------------------------------------------------------------------
+bool VlpTable::interpolatePoint(double pbh, double glift, double *qo, double *qg, double *qw)
+{
+    *qo = 0;
+    *qg = 0;
+    *qw = 0;
+
+    // check if the table has been compiled
+    if(p_table_file == 0) setTableFile(TableFile::fromMemory(QList<TableFile::TableData>() << compile()), 0);
 
     // check that the point lies within the table
-    if(pbh < m_pbh_entries.at(0) || pbh > m_pbh_entries.at(m_pbh_entries.size() - 1))
+    if(pbh < p_pbh_entries[0] || pbh > p_pbh_entries[m_n_pbh - 1])
     {
         cout << endl << "### Runtime Error ###" << endl
              << "The specified pressure falls outside the range of the VLP table..." << endl
              << "WELL : " << m_well_name.toLatin1().constData() <<  endl
              << "P    : " << pbh << endl
-             << "P_MAX: " << m_pbh_entries.at(m_pbh_entries.size() - 1) << endl
-             << "P_MIN: " << m_pbh_entries.at(0) << endl;
+             << "P_MAX: " << p_pbh_entries[m_n_pbh - 1] << endl
+             << "P_MIN: " << p_pbh_entries[0] << endl;
 
-        return new Stream(0, 0, 0, 0, pbh);
+        return false;
 
 
 
     }
 
-    if(glift < m_glift_entries.at(0) || glift > m_glift_entries.at(m_glift_entries.size() - 1))
+    if(glift < p_glift_entries[0] || glift > p_glift_entries[m_n_glift - 1])
     {
         cout << endl << "### Runtime Error ###" << endl
              << "The specified gas lift rate falls outside the range of the VLP table..." << endl
              << "WELL : " << m_well_name.toLatin1().constData() <<  endl
              << "Q    : " << glift << endl
-             << "Q_MAX: " << m_glift_entries.at(m_glift_entries.size() - 1) << endl
-             << "Q_MIN: " << m_glift_entries.at(0) << endl;
+             << "Q_MAX: " << p_glift_entries[m_n_glift - 1] << endl
+             << "Q_MIN: " << p_glift_entries[0] << endl;
 
-        return new Stream(0, 0, 0, 0, pbh);
+        return false;
 
 
     }
@@ -72,44 +121,41 @@ Stream* VlpTable::interpolate(double pbh, double glift)
 
 
     // finding the upper point (Q22)
-    QPair<int,int> upper_point = findUpperEntries(pbh, glift);
+    int i_pbh = findUpperEntry(p_pbh_entries, m_n_pbh, pbh);
+    int i_gl = findUpperEntry(p_glift_entries, m_n_glift, glift);
 
-    // finding the index in the table for the four bounding points
-    int i_Q22 = findTableIndex(upper_point.first, upper_point.second);
-    int i_Q21 = findTableIndex(upper_point.first, upper_point.second - 1);
-    int i_Q12 = findTableIndex(upper_point.first - 1, upper_point.second);
-    int i_Q11 = findTableIndex(upper_point.first - 1, upper_point.second - 1);
+    // the lower point (Q11), the same as the upper if there is only one entry
+    int l_pbh = (i_pbh > 0) ? i_pbh - 1 : 0;
+    int l_gl = (i_gl > 0) ? i_gl - 1 : 0;
+
+    // finding the index in the grids for the four bounding points
+    int i_Q22 = gridIndex(i_pbh, i_gl);
+    int i_Q21 = gridIndex(i_pbh, l_gl);
+    int i_Q12 = gridIndex(l_pbh, i_gl);
+    int i_Q11 = gridIndex(l_pbh, l_gl);
 
     // finding the weights
-    double t = (pbh - m_pbh.at(i_Q11)) / (m_pbh.at(i_Q22) - m_pbh.at(i_Q11));
-    double u = (glift - m_glift.at(i_Q11)) / (m_glift.at(i_Q22) - m_glift.at(i_Q11));
+    double t = (i_pbh == l_pbh) ? 0 : (pbh - p_pbh_entries[l_pbh]) / (p_pbh_entries[i_pbh] - p_pbh_entries[l_pbh]);
+    double u = (i_gl == l_gl) ? 0 : (glift - p_glift_entries[l_gl]) / (p_glift_entries[i_gl] - p_glift_entries[l_gl]);
+
+    double w_11 = (1 - t) * (1 - u);
+    double w_21 = t * (1 - u);
+    double w_22 = t * u;
+    double w_12 = (1 - t) * u;
 
 
     // finding the gas rate
-    double qg = (1 - t) * (1 - u) * m_gas.at(i_Q11)
-            + t * (1 - u) * m_gas.at(i_Q21)
-            + t * u * m_gas.at(i_Q22)
-            + (1 - t) * u * m_gas.at(i_Q12);
+    *qg = w_11 * p_grid_gas[i_Q11] + w_21 * p_grid_gas[i_Q21] + w_22 * p_grid_gas[i_Q22] + w_12 * p_grid_gas[i_Q12];
 
     // finding the oil rate
-    double qo = (1 - t) * (1 - u) * m_oil.at(i_Q11)
-            + t * (1 - u) * m_oil.at(i_Q21)
-            + t * u * m_oil.at(i_Q22)
-            + (1 - t) * u * m_oil.at(i_Q12);
+    *qo = w_11 * p_grid_oil[i_Q11] + w_21 * p_grid_oil[i_Q21] + w_22 * p_grid_oil[i_Q22] + w_12 * p_grid_oil[i_Q12];
 
     // finding the water rate
-    double qw = (1 - t) * (1 - u) * m_wat.at(i_Q11)
-            + t * (1 - u) * m_wat.at(i_Q21)
-            + t * u * m_wat.at(i_Q22)
-            + (1 - t) * u * m_wat.at(i_Q12);
+    *qw = w_11 * p_grid_wat[i_Q11] + w_21 * p_grid_wat[i_Q21] + w_22 * p_grid_wat[i_Q22] + w_12 * p_grid_wat[i_Q12];
 
 
-    Stream *s = new Stream(0, qo, qg, qw, pbh);
 
-
-
-
-    if(isnan(qo))
+    if(isnan(*qo))
     {
         cout << "interpolated qo is nan" << endl;
 
@@ -119,16 +165,13 @@ Stream* VlpTable::interpolate(double pbh, double glift)
         cout << "pbh = " << pbh << endl;
 
         cout << "t = " << t << endl;
-        cout << "u = " << t << endl;
-
-        cout << "pbh_11 = " << m_pbh.at(i_Q11) << endl;
-        cout << "pbh_21 = " << m_pbh.at(i_Q21) << endl;
+        cout << "u = " << u << endl;
 
         cout << "pbh entries:" << endl;
-        for(int i = 0; i < m_pbh_entries.size(); ++i) cout << i << ": " << m_pbh_entries.at(i) << endl;
+        for(int i = 0; i < m_n_pbh; ++i) cout << i << ": " << p_pbh_entries[i] << endl;
 
         cout << "glift entries:" << endl;
-        for(int i = 0; i < m_glift_entries.size(); ++i) cout << i << ": " << m_glift_entries.at(i) << endl;
+        for(int i = 0; i < m_n_glift; ++i) cout << i << ": " << p_glift_entries[i] << endl;
 
 
 
@@ -136,94 +179,97 @@ Stream* VlpTable::interpolate(double pbh, double glift)
     }
 
 
-
-
-    return s;
+    return true;
 }
 
 //-----------------------------------------------------------------------------------------------
-// finds the index for the upper glift and lower pbh point
+// finds the unique glift and pbh entries, and builds the grids
 //-----------------------------------------------------------------------------------------------
-void VlpTable::process()
+TableFile::TableData VlpTable::compile() const
 {
+    QList<double> glift_entries;
+    QList<double> pbh_entries;
+
     for(int i = 0; i < numberOfRows(); ++i)
     {
         // the glift
-        if(!m_glift_entries.contains(m_glift.at(i))) m_glift_entries.push_back(m_glift.at(i));
+        if(!glift_entries.contains(m_glift.at(i))) glift_entries.push_back(m_glift.at(i));
 
         // the pbh
-        if(!m_pbh_entries.contains(m_pbh.at(i))) m_pbh_entries.push_back(m_pbh.at(i));
+        if(!pbh_entries.contains(m_pbh.at(i))) pbh_entries.push_back(m_pbh.at(i));
 
     }
 
     // sorting the entries
-    qSort(m_glift_entries.begin(), m_glift_entries.end());
-    qSort(m_pbh_entries.begin(), m_pbh_entries.end());
-}
+    qSort(glift_entries.begin(), glift_entries.end());
+    qSort(pbh_entries.begin(), pbh_entries.end());
 
-//-----------------------------------------------------------------------------------------------
-// finds the index for the upper glift and upper pbh point in the entries lists
-//-----------------------------------------------------------------------------------------------
-QPair<int,int> VlpTable::findUpperEntries(double pbh, double glift)
-{
 
-    int i_gl = 0;
-    int i_pbh = 0;
+    // building the grids, points that are missing from the table get the rates of the first row
+    int grid_size = pbh_entries.size() * glift_entries.size();
 
+    QVector<double> grid_oil(grid_size, m_oil.at(0));
+    QVector<double> grid_gas(grid_size, m_gas.at(0));
+    QVector<double> grid_wat(grid_size, m_wat.at(0));
 
-    // finding the entry index for pbh
-    for(int i = 0; i < m_pbh_entries.size(); ++i)
+    // going backwards, so that the first row wins if a point is listed more than once
+    for(int i = numberOfRows() - 1; i >= 0; --i)
     {
-        if(m_pbh_entries.at(i) > pbh)
-        {
-            i_pbh = i;
-            break;
-        }
-    }
+        int i_pbh = qLowerBound(pbh_entries.begin(), pbh_entries.end(), m_pbh.at(i)) - pbh_entries.begin();
+        int i_gl = qLowerBound(glift_entries.begin(), glift_entries.end(), m_glift.at(i)) - glift_entries.begin();
 
-    for(int i = 0; i < m_glift_entries.size(); ++i)
-    {
-        if(m_glift_entries.at(i) > glift)
-        {
-            i_gl = i;
-            break;
-        }
+        int k = i_pbh * glift_entries.size() + i_gl;
 
+        grid_oil[k] = m_oil.at(i);
+        grid_gas[k] = m_gas.at(i);
+        grid_wat[k] = m_wat.at(i);
     }
 
-    if(glift == m_glift_entries.at(m_glift_entries.size() -1)) i_gl = m_glift_entries.size() -1;
-    if(pbh == m_pbh_entries.at(m_pbh_entries.size() -1)) i_pbh = m_pbh_entries.size() -1;
+    TableFile::TableData data;
+    data.name = m_well_name;
+    data.axes << pbh_entries.toVector() << glift_entries.toVector();
+    data.grids << grid_oil << grid_gas << grid_wat;
 
+    return data;
+}
 
-    return qMakePair(i_pbh, i_gl);
-
+//-----------------------------------------------------------------------------------------------
+// sets the compiled table to use for the interpolation
+//-----------------------------------------------------------------------------------------------
+void VlpTable::setTableFile(shared_ptr<TableFile> table_file, int table)
+{
+    p_table_file = table_file;
+
+    m_n_pbh = p_table_file->axisSize(table, 0);
+    m_n_glift = p_table_file->axisSize(table, 1);
+    p_pbh_entries = p_table_file->axis(table, 0);
+    p_glift_entries = p_table_file->axis(table, 1);
+
+    p_grid_oil = p_table_file->grid(table, 0);
+    p_grid_gas = p_table_file->grid(table, 1);
+    p_grid_wat = p_table_file->grid(table, 2);
+
+    // the rows are not needed anymore
+    m_pbh.clear();
+    m_glift.clear();
+    m_oil.clear();
+    m_gas.clear();
+    m_wat.clear();
 }
 
 //-----------------------------------------------------------------------------------------------
-// finds the index in the main table that corresponds to the entries in the entries table
+// finds the index for the upper point in the entries list
 //-----------------------------------------------------------------------------------------------
-int VlpTable::findTableIndex(int pbh_entry, int glift_entry)
+int VlpTable::findUpperEntry(const double *entries, int n, double value) const
 {
-    int index = 0;
+    if(n < 2) return 0;
 
-    double glift = m_glift_entries.at(glift_entry);
-    double pbh = m_pbh_entries.at(pbh_entry);
+    int i = qUpperBound(entries, entries + n, value) - entries;
 
-    for(int i = 0; i < m_glift.size(); ++i)
-    {
-        // first checknig the gas lift rate
-        if(m_glift.at(i) == glift)
-        {
-            // then checking the bottomhole pressure
-            if(m_pbh.at(i) == pbh)
-            {
-                index = i;
-                break;
-            }
-        }
-    }
+    // the value is at the upper end of the table
+    if(i == n) i = n - 1;
 
-    return index;
+    return i;
 }
 
 } // namespace ResOpt
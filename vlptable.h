@@ -4,6 +4,12 @@
 #include <QList>
 #include <QString>
 #include <QPair>
+#include <QVector>
+#include <tr1/memory>
+
+#include "tablefile.h"
+
+using std::tr1::shared_ptr;
 
 namespace ResOpt
 {
@@ -19,22 +25,36 @@ private:
     QList<double> m_gas;
     QList<double> m_wat;
 
-    QList<double> m_pbh_entries;        // list of the unique values for the pbh
-    QList<double> m_glift_entries;      // list of the uniquie values for the glift
+    shared_ptr<TableFile> p_table_file; // the compiled table, shared between all copies of the table
+
+    const double *p_pbh_entries;        // the unique values for the pbh, sorted
+    const double *p_glift_entries;      // the unique values for the glift, sorted
+    int m_n_pbh;
+    int m_n_glift;
+
+    const double *p_grid_oil;           // dense (pbh, glift) grids of the rates
+    const double *p_grid_gas;
+    const double *p_grid_wat;
 
     QString m_well_name;
 
 
     /**
-     * @brief returns the index for the upper glift and upper pbh point
+     * @brief returns the index for the upper point in a list of sorted entries
      *
-     * @param pbh
-     * @param qlift
+     * @param entries
+     * @param value
      * @return int
      */
-    QPair<int,int> findUpperEntries(double pbh, double glift);
+    int findUpperEntry(const double *entries, int n, double value) const;
 
-    int findTableIndex(int pbh_entry, int glift_entry);
+    int gridIndex(int pbh_entry, int glift_entry) const {return pbh_entry * m_n_glift + glift_entry;}
+
+    /**
+     * @brief Interpolates the rates for a single point. Returns false if the point lies outside the table, the rates are then set to zero.
+     *
+     */
+    bool interpolatePoint(double pbh, double glift, double *qo, double *qg, double *qw);
 
 public:
     VlpTable();
@@ -51,12 +71,38 @@ public:
      */
     Stream* interpolate(double pbh, double glift);
 
+    /**
+     * @brief Interpolates the table for a list of points in one go.
+     * @details The rates for point i, given by pbh[i] and glift[i], are written to oil[i], gas[i] and wat[i]. The output vectors are resized
+     *          to the number of points if needed, so vectors that are reused between calls are not reallocated. Points outside the table
+     *          get zero rates, the same as for interpolate().
+     *
+     * @param pbh
+     * @param glift
+     * @param oil
+     * @param gas
+     * @param wat
+     */
+    void interpolate(const QVector<double> &pbh, const QVector<double> &glift, QVector<double> &oil, QVector<double> &gas, QVector<double> &wat);
+
+
+    /**
+     * @brief Generates the unique entries for pbh and glift, and the grids of rates used by the interpolation algorithm, from the rows
+     * @details The table has two axes (pbh, glift) and three grids (oil, gas, water). Points that are missing from the table get the rates of the first row.
+     *
+     * @return TableFile::TableData
+     */
+    TableFile::TableData compile() const;
 
     /**
-     * @brief Generates lists of the unique entries for glift and pbh, to be used by the interpolation algorithm
+     * @brief Makes the table use a compiled table from a TableFile.
+     * @details The rows are not needed after this, and are cleared. If the table is interpolated without a table file, the rows are compiled
+     *          to an in-memory table the first time.
      *
+     * @param table_file
+     * @param table index of the table in the file
      */
-    void process();
+    void setTableFile(shared_ptr<TableFile> table_file, int table);
 
     // set functions
     void setWellName(const QString &n) {m_well_name = n;}
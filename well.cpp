@@ -126,10 +126,10 @@ Well::~Well()
 //-----------------------------------------------------------------------------------------------
 void Well::initialize()
 {
-    clearStreams();
+    QVector<double> times;
+    for(int i = 0; i < m_schedule.size(); ++i) times.push_back(m_schedule.at(i)->endTime());
 
-    //for(int i = 0; i < m_schedule.size(); ++i) addStream(new Stream());
-    for(int i = 0; i < m_schedule.size(); ++i) addStream(new Stream(m_schedule.at(i)->endTime(), 0, 0, 0, 0));
+    setupStreams(times);
 }
 
 